@@ -0,0 +1,108 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "runtime/SSLRuntime.h"
+
+// Compares the two ways a batch of dynamic arrays gets its memory: one
+// malloc/realloc/free per array, as ssl.array.grow and ssl.array.free do
+// outside arena blocks, against one ssl_arena_enter/ssl_arena_exit per batch
+// with ssl_arena_resize for every growth, as inside an `arena { }` block.
+//   SSLangArenaBenchmark [batches] [arrays per batch] [elements per array]
+
+namespace {
+
+    constexpr std::int64_t inlineCapacity = 8; // Same as LLVMCodeGen::arrayInlineCapacity
+
+    // The { data, length, capacity, inline buffer } layout LLVMCodeGen gives an int array
+    struct Array {
+        std::int32_t* data;
+        std::int64_t length;
+        std::int64_t capacity;
+        std::int32_t inlineBuffer[inlineCapacity];
+
+        void reset() {
+            data = inlineBuffer;
+            length = 0;
+            capacity = inlineCapacity;
+        }
+    };
+
+    volatile std::int64_t sink = 0;
+
+    void growOnHeap(Array& array) {
+        std::size_t bytes = static_cast<std::size_t>(array.capacity) * 2 * sizeof(std::int32_t);
+        if (array.data == array.inlineBuffer) {
+            auto* data = static_cast<std::int32_t*>(std::malloc(bytes));
+            std::memcpy(data, array.data, static_cast<std::size_t>(array.length) * sizeof(std::int32_t));
+            array.data = data;
+        }
+        else {
+            array.data = static_cast<std::int32_t*>(std::realloc(array.data, bytes));
+        }
+        array.capacity *= 2;
+    }
+
+    void growInArena(Array& array, ssl_arena* arena) {
+        std::int64_t used = array.length * static_cast<std::int64_t>(sizeof(std::int32_t));
+        std::int64_t bytes = array.capacity * 2 * static_cast<std::int64_t>(sizeof(std::int32_t));
+        array.data = static_cast<std::int32_t*>(ssl_arena_resize(arena, array.data, used, bytes));
+        array.capacity *= 2;
+    }
+
+    double runBenchmark(const std::string& name, long long batches, int arrays, int elements, bool arena) {
+        Array* batch = new Array[arrays];
+        auto start = std::chrono::steady_clock::now();
+        std::int64_t sum = 0;
+        for (long long b = 0; b < batches; ++b) {
+            ssl_arena* region = arena ? ssl_arena_enter() : nullptr;
+            // Fill the arrays round robin, so their growth interleaves like values built side by side
+            for (int a = 0; a < arrays; ++a) {
+                batch[a].reset();
+            }
+            for (int i = 0; i < elements; ++i) {
+                for (int a = 0; a < arrays; ++a) {
+                    Array& array = batch[a];
+                    if (array.length == array.capacity) {
+                        arena ? growInArena(array, region) : growOnHeap(array);
+                    }
+                    array.data[array.length++] = i + a;
+                }
+            }
+            for (int a = 0; a < arrays; ++a) {
+                sum += batch[a].data[batch[a].length - 1];
+                if (!arena && batch[a].data != batch[a].inlineBuffer) {
+                    std::free(batch[a].data);
+                }
+            }
+            if (arena) {
+                ssl_arena_exit(region);
+            }
+        }
+        sink = sum;
+        auto end = std::chrono::steady_clock::now();
+        delete[] batch;
+
+        double seconds = std::chrono::duration<double>(end - start).count();
+        std::cerr << name << ": " << seconds << " s" << std::endl;
+        return seconds;
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    long long batches = argc > 1 ? std::atoll(argv[1]) : 200000;
+    int arrays = argc > 2 ? std::atoi(argv[2]) : 16;
+    int elements = argc > 3 ? std::atoi(argv[3]) : 200;
+
+    std::cerr << batches << " batches of " << arrays << " arrays with " << elements << " elements each" << std::endl;
+
+    double heap = runBenchmark("malloc/free per array", batches, arrays, elements, false);
+    double arena = runBenchmark("arena per batch      ", batches, arrays, elements, true);
+    std::cerr << "Speedup: " << heap / arena << "x" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,108 @@
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// Writes init_heavy.ssl, the --adaptive-opt workload: two hot loop kernels and
+// many large loop-free initialization functions that run once. The constants
+// come from a fixed-seed generator, so every build writes the same program.
+//   SSLangInitHeavyGenerator <output.ssl> [functions] [steps per function]
+
+namespace {
+
+    // A linear congruential generator; std::uniform_int_distribution differs between standard libraries
+    struct Constants {
+        std::uint64_t state = 46;
+
+        int next(int low, int high) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            return low + static_cast<int>((state >> 33) % static_cast<std::uint64_t>(high - low + 1));
+        }
+    };
+
+    void writeKernels(std::ostream& out) {
+        out << "function sumDigits(int: n) -> int {\n"
+            "\tloop range(0, n) as i {\n"
+            "\t\tdigit = i % 7;\n"
+            "\t\ttotal = total + digit;\n"
+            "\t}\n"
+            "\tret(total);\n"
+            "}\n\n"
+            "function mixBits(int: n) -> int {\n"
+            "\tscratch = 1;\n"
+            "\tloop range(0, n) as i {\n"
+            "\t\tscratch = scratch * 33;\n"
+            "\t\tscratch = scratch + i;\n"
+            "\t\tscratch = scratch % 1000003;\n"
+            "\t}\n"
+            "\tret(scratch);\n"
+            "}\n\n";
+    }
+
+    // One step scales scratch, keeps it in range and folds it into config
+    void writeInitFunction(std::ostream& out, int index, int steps, Constants& constants) {
+        out << "function init" << index << "(int: x) -> int {\n";
+        out << "\tscratch = x + " << index << ";\n";
+        for (int step = 0; step < steps; ++step) {
+            int factor = constants.next(2, 97);
+            int limit = constants.next(100, 999);
+            out << "\tscratch = scratch * " << factor << ";\n";
+            out << "\tscratch = scratch % " << 1000 + limit << ";\n";
+            out << "\tif (scratch > " << limit << ") {\n";
+            out << "\t\tscratch = scratch - " << factor << ";\n";
+            out << "\t}\n";
+            out << "\tconfig = config + scratch;\n";
+        }
+        out << "\tret(scratch);\n";
+        out << "}\n\n";
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: SSLangInitHeavyGenerator <output.ssl> [functions] [steps per function]" << std::endl;
+        return 1;
+    }
+    int functions = argc > 2 ? std::stoi(argv[2]) : 60;
+    int steps = argc > 3 ? std::stoi(argv[3]) : 30;
+
+    std::ostringstream out;
+    out << "//two hot kernels and " << functions << " large initialization functions that run once; a module for --adaptive-opt\n"
+        "//generated by SSLangInitHeavyGenerator, do not edit\n\n"
+        "int total = 0;\n"
+        "int digit = 0;\n"
+        "int scratch = 0;\n"
+        "int config = 0;\n\n";
+    writeKernels(out);
+    Constants constants;
+    for (int i = 0; i < functions; ++i) {
+        writeInitFunction(out, i, steps, constants);
+    }
+
+    out << "function setup() -> int {\n";
+    for (int i = 0; i < functions; ++i) {
+        out << "\tscratch = call init" << i << "(config);\n";
+    }
+    out << "\tret(config);\n"
+        "}\n\n"
+        "function run() -> int {\n"
+        "\tconfig = call setup();\n"
+        "\ttotal = call sumDigits(300000000);\n"
+        "\tscratch = call mixBits(100000000);\n"
+        "\tlog(config);\n"
+        "\tlog(total);\n"
+        "\tlog(scratch);\n"
+        "\tret(0);\n"
+        "}\n\n"
+        "call run();\n";
+
+    std::ofstream file(argv[1]);
+    if (!file) {
+        std::cerr << "Could not open " << argv[1] << " for writing" << std::endl;
+        return 1;
+    }
+    file << out.str();
+    return 0;
+}
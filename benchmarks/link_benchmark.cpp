@@ -0,0 +1,77 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+// Measures what --link saves end to end: compiling and linking a program with
+// `SSLang --link` against compiling it with SSLang and linking the object file
+// with a clang++ subprocess. Every build runs in a fresh directory; the times
+// are the best of several runs.
+//   SSLangLinkBenchmark <program.ssl> [runs] [linker]
+
+namespace fs = std::filesystem;
+
+namespace {
+
+    // Seconds command took in directory, or a negative number if it failed
+    double timeCommand(const std::string& command, const fs::path& directory) {
+        std::string inDirectory = "cd \"" + directory.string() + "\" && " + command + " > command.log 2>&1";
+        auto start = std::chrono::steady_clock::now();
+        int status = std::system(inDirectory.c_str());
+        auto end = std::chrono::steady_clock::now();
+        return status == 0 ? std::chrono::duration<double>(end - start).count() : -1;
+    }
+
+    fs::path scratchDirectory() {
+        fs::path directory = fs::temp_directory_path() / "sslang_link_benchmark";
+        fs::remove_all(directory);
+        fs::create_directories(directory / "llvmGenerated");
+        fs::create_directories(directory / "genObjectFile");
+        return directory;
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: SSLangLinkBenchmark <program.ssl> [runs] [linker]" << std::endl;
+        return 1;
+    }
+    std::string source = fs::absolute(argv[1]).string();
+    int runs = argc > 2 ? std::atoi(argv[2]) : 5;
+    std::string linker = argc > 3 ? argv[3] : SSL_LINKER;
+    std::string name = fs::path(source).stem().string();
+
+    std::string compile = std::string("\"") + SSL_COMPILER + "\" \"" + source + "\"";
+    std::string inProcess = std::string("\"") + SSL_COMPILER + "\" --link --runtime=\"" + SSL_RUNTIME_LIBRARY + "\" \"" + source + "\"";
+    std::string subprocess = "\"" + linker + "\" genObjectFile/optimized_" + name + ".o \"" + SSL_RUNTIME_LIBRARY + "\" -pthread -o " + name;
+
+    double compileOnly = 1e9;
+    double withLink = 1e9;
+    double withSubprocess = 1e9;
+    double subprocessLink = 1e9;
+    for (int run = 0; run < runs; ++run) {
+        double compileSeconds = timeCommand(compile, scratchDirectory());
+        double linkSeconds = timeCommand(inProcess, scratchDirectory());
+        fs::path directory = scratchDirectory();
+        double firstSeconds = timeCommand(compile, directory);
+        double secondSeconds = firstSeconds < 0 ? -1 : timeCommand(subprocess, directory);
+        if (compileSeconds < 0 || linkSeconds < 0 || secondSeconds < 0) {
+            std::cerr << "A build of " << source << " failed; see command.log in " << directory.string() << std::endl;
+            return 1;
+        }
+        compileOnly = std::min(compileOnly, compileSeconds);
+        withLink = std::min(withLink, linkSeconds);
+        withSubprocess = std::min(withSubprocess, firstSeconds + secondSeconds);
+        subprocessLink = std::min(subprocessLink, secondSeconds);
+    }
+
+    std::cerr << name << ", best of " << runs << ":" << std::endl;
+    std::cerr << "  SSLang without linking: " << compileOnly << " s" << std::endl;
+    std::cerr << "  SSLang --link: " << withLink << " s (link " << withLink - compileOnly << " s)" << std::endl;
+    std::cerr << "  SSLang, then " << linker << ": " << withSubprocess << " s (link " << subprocessLink << " s)" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,40 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "runtime/SSLRuntime.h"
+
+// Compares the old log() lowering (one printf call per log) against the
+// buffered SSL runtime. Results go to stderr, so run it with stdout redirected:
+//   SSLangLogBenchmark 10000000 > /dev/null
+
+template <typename Body>
+static void runBenchmark(const std::string& name, long long iterations, Body body) {
+    auto start = std::chrono::steady_clock::now();
+    for (long long i = 0; i < iterations; ++i) {
+        body(i);
+    }
+    std::fflush(stdout);
+    ssl_flush();
+    auto end = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::cerr << name << ": " << seconds << " s, " << static_cast<long long>(iterations / seconds) << " logs/s" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    long long iterations = argc > 1 ? std::atoll(argv[1]) : 10000000;
+
+    std::cerr << "Logging " << iterations << " values per benchmark" << std::endl;
+
+    runBenchmark("printf int   ", iterations, [](long long i) { std::printf("%d\n", static_cast<int>(i)); });
+    runBenchmark("ssl_log_i32  ", iterations, [](long long i) { ssl_log_i32(static_cast<int>(i)); });
+    runBenchmark("printf float ", iterations, [](long long i) { std::printf("%f\n", static_cast<double>(i * 0.25f)); });
+    runBenchmark("ssl_log_f32  ", iterations, [](long long i) { ssl_log_f32(i * 0.25f); });
+    runBenchmark("printf bool  ", iterations, [](long long i) { std::printf("%s\n", (i & 1) ? "true" : "false"); });
+    runBenchmark("ssl_log_bool ", iterations, [](long long i) { ssl_log_bool(i & 1); });
+
+    return 0;
+}
@@ -0,0 +1,69 @@
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// Writes many_functions.ssl, the --jobs workload: many small loop kernels and a
+// driver that calls each of them, so the module splits into balanced partitions.
+// The kernel constants are derived from the kernel's index, so every build writes
+// the same program.
+//   SSLangManyFunctionsGenerator <output.ssl> [kernels] [driver rounds]
+
+namespace {
+
+    void writeKernel(std::ostream& out, int index) {
+        int subtract = 3 + 13 * index % 31;
+        out << "function kernel" << index << "(int: x) -> int {\n";
+        out << "\tscratch = x % " << 11 + 5 * index % 17 << ";\n";
+        out << "\tloop range(0, " << 64 + 16 * (index % 5) << ") as i {\n";
+        out << "\t\tscratch = scratch * " << 2 + 7 * index % 23 << ";\n";
+        out << "\t\tscratch = scratch + i;\n";
+        out << "\t\tscratch = scratch % " << 1000 + subtract << ";\n";
+        out << "\t\tif (scratch > " << 500 + index << ") {\n";
+        out << "\t\t\tscratch = scratch - " << subtract << ";\n";
+        out << "\t\t}\n";
+        out << "\t}\n";
+        out << "\tret(scratch);\n";
+        out << "}\n\n";
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: SSLangManyFunctionsGenerator <output.ssl> [kernels] [driver rounds]" << std::endl;
+        return 1;
+    }
+    int kernels = argc > 2 ? std::stoi(argv[2]) : 192;
+    int rounds = argc > 3 ? std::stoi(argv[3]) : 20000;
+
+    std::ostringstream out;
+    out << "//" << kernels << " small kernels and a driver that calls each of them; a module with many functions for --jobs to split\n"
+        "//generated by SSLangManyFunctionsGenerator, do not edit\n\n"
+        "int total = 0;\n"
+        "int value = 0;\n"
+        "int scratch = 0;\n\n";
+    for (int i = 0; i < kernels; ++i) {
+        writeKernel(out, i);
+    }
+
+    out << "function driver() -> int {\n"
+        "\tloop range(0, " << rounds << ") as round {\n";
+    for (int i = 0; i < kernels; ++i) {
+        out << "\t\tvalue = call kernel" << i << "(round);\n";
+        out << "\t\ttotal = total + value;\n";
+    }
+    out << "\t}\n"
+        "\tlog(total);\n"
+        "\tret(total);\n"
+        "}\n\n"
+        "call driver();\n";
+
+    std::ofstream file(argv[1]);
+    if (!file) {
+        std::cerr << "Could not open " << argv[1] << " for writing" << std::endl;
+        return 1;
+    }
+    file << out.str();
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "runtime/SSLRuntime.h"
+
+// Measures how ssl_parallel_for scales with the number of workers on a
+// CPU-bound loop body, the same way a `loop parallel range` with a
+// reduce(+: x) clause is lowered: each worker sums into its own slot and the
+// slots are combined afterwards.
+//   SSLangParallelBenchmark [iterations] [max workers]
+
+namespace {
+
+    struct Context {
+        std::uint64_t partials[sslParallelMaxWorkers];
+    };
+
+    // A few rounds of integer hashing per iteration, so the loop is compute bound
+    void hashRange(std::int32_t begin, std::int32_t end, void* context, std::int32_t worker) {
+        std::uint64_t sum = 0;
+        for (std::int32_t i = begin; i < end; ++i) {
+            std::uint64_t x = static_cast<std::uint64_t>(i);
+            for (int round = 0; round < 16; ++round) {
+                x ^= x >> 33;
+                x *= 0xff51afd7ed558ccdULL;
+            }
+            sum += x;
+        }
+        static_cast<Context*>(context)->partials[worker] += sum;
+    }
+
+    double runBenchmark(std::int32_t workers, std::int32_t iterations, std::uint64_t& result) {
+        ssl_parallel_set_worker_count(workers);
+        Context context{};
+
+        auto start = std::chrono::steady_clock::now();
+        ssl_parallel_for(0, iterations, hashRange, &context);
+        auto end = std::chrono::steady_clock::now();
+
+        result = 0;
+        for (std::int32_t worker = 0; worker < ssl_parallel_worker_count(); ++worker) {
+            result += context.partials[worker];
+        }
+        return std::chrono::duration<double>(end - start).count();
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::int32_t iterations = argc > 1 ? std::atoi(argv[1]) : 200000000;
+    std::int32_t maxWorkers = argc > 2 ? std::atoi(argv[2]) : static_cast<std::int32_t>(std::thread::hardware_concurrency());
+
+    std::vector<std::int32_t> workerCounts;
+    for (std::int32_t workers = 1; workers < maxWorkers; workers *= 2) {
+        workerCounts.push_back(workers);
+    }
+    workerCounts.push_back(maxWorkers);
+
+    std::cerr << "Hashing " << iterations << " values per run" << std::endl;
+
+    std::uint64_t serialResult = 0;
+    double serialSeconds = 0;
+    for (std::int32_t workers : workerCounts) {
+        std::uint64_t result = 0;
+        double seconds = runBenchmark(workers, iterations, result);
+        if (workers == 1) {
+            serialSeconds = seconds;
+            serialResult = result;
+        }
+        std::cerr << workers << " workers: " << seconds << " s, speedup " << serialSeconds / seconds
+            << (result == serialResult ? "" : " (RESULT MISMATCH)") << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,63 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "runtime/SSLRuntime.h"
+
+// Measures what --instrument-functions adds to every call: the same small
+// function is called with and without the ssl_profile_enter/ssl_profile_exit
+// pair LLVMCodeGen wraps around an instrumented body. The profile report
+// printed at exit is part of the output.
+//   SSLangProfileBenchmark [calls]
+
+namespace {
+
+    ssl_profile_site leafSite{ "leaf", { -1 } };
+
+    volatile std::int64_t sink = 0;
+
+#if defined(_MSC_VER)
+    __declspec(noinline)
+#else
+    __attribute__((noinline))
+#endif
+    std::int64_t leaf(std::int64_t x, bool instrumented) {
+        if (instrumented) {
+            ssl_profile_enter(&leafSite);
+        }
+        std::int64_t result = x * 3 + (x >> 2);
+        if (instrumented) {
+            ssl_profile_exit();
+        }
+        return result;
+    }
+
+    double runBenchmark(const std::string& name, long long calls, bool instrumented) {
+        auto start = std::chrono::steady_clock::now();
+        std::int64_t sum = 0;
+        for (long long i = 0; i < calls; ++i) {
+            sum += leaf(i, instrumented);
+        }
+        sink = sum;
+        auto end = std::chrono::steady_clock::now();
+
+        double seconds = std::chrono::duration<double>(end - start).count();
+        std::cerr << name << ": " << seconds << " s, " << seconds * 1e9 / static_cast<double>(calls) << " ns/call" << std::endl;
+        return seconds;
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    long long calls = argc > 1 ? std::atoll(argv[1]) : 100000000;
+
+    std::cerr << "Calling a small function " << calls << " times per benchmark" << std::endl;
+
+    double plain = runBenchmark("plain        ", calls, false);
+    double instrumented = runBenchmark("instrumented ", calls, true);
+    std::cerr << "Overhead: " << (instrumented - plain) * 1e9 / static_cast<double>(calls) << " ns/call" << std::endl;
+
+    return 0;
+}
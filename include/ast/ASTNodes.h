@@ -7,14 +7,111 @@
 #include <regex>
 #include <sstream>
 #include <set>
+#include <optional>
+#include <cstdint>
+#include <charconv>
+#include <cctype>
 
 #include "../symbolTable/SymbolTable.h"
 #include "../visitor/Visitor.h"
 
 class IVisitor;
 
+// Types are spelled flt/str/dbl in source and float/string/double everywhere else
+inline std::string normalizeType(const std::string& type) {
+    if (type == "flt") {
+        return "float";
+    }
+    if (type == "str") {
+        return "string";
+    }
+    if (type == "dbl") {
+        return "double";
+    }
+    return type;
+}
+
+// The source spelling of a normalized type, for error messages
+inline std::string sourceTypeName(const std::string& type) {
+    if (type == "float") {
+        return "flt";
+    }
+    if (type == "string") {
+        return "str";
+    }
+    if (type == "double") {
+        return "dbl";
+    }
+    return type;
+}
+
+// Width in bits of an integer type, 0 for anything else
+inline unsigned integerTypeBits(const std::string& type) {
+    if (type == "i8") return 8;
+    if (type == "i16") return 16;
+    if (type == "int") return 32;
+    if (type == "i64") return 64;
+    return 0;
+}
+
+inline bool isIntegerType(const std::string& type) {
+    return integerTypeBits(type) != 0;
+}
+
+inline bool isFloatingType(const std::string& type) {
+    return type == "float" || type == "double";
+}
+
+inline bool isNumericType(const std::string& type) {
+    return isIntegerType(type) || isFloatingType(type);
+}
+
+// Lanes of a SIMD vector type (vec4f, vec8i, ...) or of the mask its comparisons produce (mask4, mask8), 0 otherwise
+inline unsigned vectorLanes(const std::string& type) {
+    if (type == "vec4f" || type == "vec4i" || type == "mask4") return 4;
+    if (type == "vec8f" || type == "vec8i" || type == "mask8") return 8;
+    return 0;
+}
+
+inline bool isVectorType(const std::string& type) {
+    return vectorLanes(type) != 0 && type.rfind("vec", 0) == 0;
+}
+
+inline bool isMaskType(const std::string& type) {
+    return vectorLanes(type) != 0 && type.rfind("mask", 0) == 0;
+}
+
+// float for vecNf, int for vecNi
+inline std::string vectorElementType(const std::string& type) {
+    return type.back() == 'f' ? "float" : "int";
+}
+
+// vecNf or vecNi for float or int lanes, empty for element types without a vector type
+inline std::string vectorTypeFor(const std::string& elementType, unsigned lanes) {
+    if (elementType != "float" && elementType != "int") {
+        return "";
+    }
+    return "vec" + std::to_string(lanes) + (elementType == "float" ? "f" : "i");
+}
+
+inline bool integerFitsType(std::int64_t value, const std::string& type) {
+    unsigned bits = integerTypeBits(type);
+    if (bits == 0 || bits == 64) {
+        return bits == 64;
+    }
+    std::int64_t limit = std::int64_t(1) << (bits - 1);
+    return value >= -limit && value < limit;
+}
+
+// Where a node starts in the source file, 1-based; line 0 means unknown
+struct SourceLocation {
+    unsigned line = 0;
+    unsigned column = 0;
+};
+
 class ASTNode {
     public:
+        SourceLocation location; // Set by the parser, used for debug info
         virtual ~ASTNode() = default;
         virtual std::string toString() const = 0;
         virtual void accept(IVisitor* visitor) const = 0;
@@ -26,12 +123,58 @@ class Expression : public ASTNode {
     public:
         virtual std::string getType(SymbolTable& symbolTable) const = 0;
         virtual std::string getName() const { return ""; }
+        virtual std::optional<std::int64_t> getIntegerConstant() const { return std::nullopt; } // Value of an integer literal, if this is one
+        virtual bool isUpdateOf(const std::string& name, const std::string& op) const { return false; } // Whether this is `name op other` or `other op name`
+        virtual int countReads(const std::string& name) const { return 0; } // How many times the variable name is read in this expression
+        virtual bool isNumericLiteral() const { return false; } // Untyped literal such as 1, -2 or 0.5, which takes the type its context expects
 };
+
+// Reads of name across the arguments of a call
+inline int countArgumentReads(const std::vector<std::unique_ptr<Expression>>& arguments, const std::string& name) {
+    int reads = 0;
+    for (const auto& argument : arguments) {
+        reads += argument->countReads(name);
+    }
+    return reads;
+}
+
+// Whether a value of type `type` may be stored in a `target`. Only untyped literals
+// convert implicitly, and only when they fit: i64 x = 1 is fine, x = someInt needs i64(someInt).
+inline bool isAssignableTo(const Expression& value, const std::string& type, const std::string& target) {
+    if (type == target) {
+        return true;
+    }
+    if (!value.isNumericLiteral()) {
+        return false;
+    }
+    if (isVectorType(target)) {
+        return isAssignableTo(value, type, vectorElementType(target)); // the literal is splatted across the lanes
+    }
+    if (isIntegerType(type) && isIntegerType(target)) {
+        auto constant = value.getIntegerConstant();
+        return constant.has_value() && integerFitsType(*constant, target);
+    }
+    return isFloatingType(type) && isFloatingType(target);
+}
+
+// Type both operands of a binary expression are computed in: count + 1 is an i64 when
+// count is. Empty when the operands differ and neither is a literal that converts.
+inline std::string commonOperandType(const Expression& left, const std::string& leftType, const Expression& right, const std::string& rightType) {
+    if (isAssignableTo(right, rightType, leftType)) {
+        return leftType;
+    }
+    if (isAssignableTo(left, leftType, rightType)) {
+        return rightType;
+    }
+    return "";
+}
+
 class Statement : public ASTNode {
     public:
 };
 class Function : public ASTNode {
     public:
+        virtual const FunctionDefinition* getDefinition() const { return nullptr; } // The definition itself for FunctionDefinition, nullptr for calls
 };
 class Program : public ASTNode {
     public:
@@ -67,17 +210,59 @@ class Program : public ASTNode {
         }
 };
 
+// Compiler hint written before a construct, e.g. @unroll(8) or @vectorize(width=8)
+struct Annotation {
+    std::string name;
+    std::vector<std::pair<std::string, std::string>> arguments; // key is empty for positional arguments
+
+    std::optional<std::string> argument(const std::string& key) const {
+        for (const auto& [argKey, argValue] : arguments) {
+            if (argKey == key) {
+                return argValue;
+            }
+        }
+        return std::nullopt;
+    }
+
+    std::string toString() const {
+        std::string result = "@" + name;
+        if (!arguments.empty()) {
+            result += "(";
+            for (std::size_t i = 0; i < arguments.size(); ++i) {
+                result += (i > 0 ? ", " : "") + (arguments[i].first.empty() ? "" : arguments[i].first + "=") + arguments[i].second;
+            }
+            result += ")";
+        }
+        return result;
+    }
+};
+
+// reduce(+: total) clause of a parallel loop
+struct Reduction {
+    std::string op;
+    std::string variable;
+};
+
+inline std::string annotationsToString(const std::vector<Annotation>& annotations) {
+    std::string result;
+    for (const auto& annotation : annotations) {
+        result += annotation.toString() + " ";
+    }
+    return result;
+}
+
 //Declarations
 class IntDeclaration : public Declaration {
     public:
         std::string name;
         std::string number;
+        std::string type; // int, i8, i16 or i64
 
-        IntDeclaration(std::string name, std::string number)
-            : name(std::move(name)), number(std::move(number)) {}
+        IntDeclaration(std::string name, std::string number, std::string type = "int")
+            : name(std::move(name)), number(std::move(number)), type(std::move(type)) {}
 
         std::string toString() const override {
-            return "IntDeclaration(" + name + " = " + number + ")";
+            return "IntDeclaration(" + (type == "int" ? "" : type + " ") + name + " = " + number + ")";
         }
 
         void accept(IVisitor* visitor) const override {
@@ -89,12 +274,13 @@ class FloatDeclaration : public Declaration {
     public:
         std::string name;
         std::string number;
+        std::string type; // float or double
 
-        FloatDeclaration(std::string name, std::string number)
-            : name(std::move(name)), number(std::move(number)) {}
+        FloatDeclaration(std::string name, std::string number, std::string type = "float")
+            : name(std::move(name)), number(std::move(number)), type(std::move(type)) {}
         
         std::string toString() const override {
-            return "FloatDeclaration(" + name + " = " + number + ")";
+            return "FloatDeclaration(" + (type == "float" ? "" : type + " ") + name + " = " + number + ")";
         }
 
         void accept(IVisitor* visitor) const override {
@@ -141,12 +327,13 @@ public:
     std::string name;
 	std::vector<std::unique_ptr<Expression>> elements;
     std::size_t size;
+    std::string elementType; // int, i8, i16 or i64
 
-    ArrayDeclaration(std::string name, std::vector<std::unique_ptr<Expression>> elements)
-        : name(std::move(name)), elements(std::move(elements)), size(this->elements.size()) {}
+    ArrayDeclaration(std::string name, std::vector<std::unique_ptr<Expression>> elements, std::string elementType = "int")
+        : name(std::move(name)), elements(std::move(elements)), size(this->elements.size()), elementType(std::move(elementType)) {}
 
     std::string toString() const override {
-		std::string result = "ArrayDeclaration(" + name + " = [";
+		std::string result = "ArrayDeclaration(" + (elementType == "int" ? "" : elementType + " ") + name + " = [";
         for (const auto& elem : elements) {
 			result += elem->toString() + ", ";
 		}
@@ -159,6 +346,28 @@ public:
 	}
 };
 
+class VectorDeclaration : public Declaration {
+    public:
+        std::string name;
+        std::string type; // vec4f, vec8f, vec4i or vec8i
+        std::vector<std::unique_ptr<Expression>> elements; // one value for every lane, or a single value splatted across them
+
+        VectorDeclaration(std::string name, std::string type, std::vector<std::unique_ptr<Expression>> elements)
+            : name(std::move(name)), type(std::move(type)), elements(std::move(elements)) {}
+
+        std::string toString() const override {
+            std::string result = "VectorDeclaration(" + type + " " + name + " = {";
+            for (const auto& elem : elements) {
+                if (&elem != &elements.front()) result += ", ";
+                result += elem->toString();
+            }
+            return result + "})";
+        }
+
+        void accept(IVisitor* visitor) const override {
+            visitor->visit(this);
+        }
+};
 
 //Expressions
 class AssignmentExpression : public Expression {
@@ -186,6 +395,10 @@ class AssignmentExpression : public Expression {
 			return name;
 		}
 
+        int countReads(const std::string& variable) const override {
+            return expression->countReads(variable);
+        }
+
         void accept(IVisitor* visitor) const override {
             visitor->visit(this);
         }
@@ -210,7 +423,11 @@ class PrimaryExpression : public Expression {
 
             if (std::regex_match(name, intRegex)) {
                 std::cout << "Primary expression is an int for : " << name << std::endl;
-                return "int";
+                auto value = getIntegerConstant();
+                if (!value.has_value()) {
+                    throw std::runtime_error("Integer literal " + name + " does not fit in 64 bits.");
+                }
+                return integerFitsType(*value, "int") ? "int" : "i64";
             }
             // Check if the primary expression is a float
             else if (std::regex_match(name, floatRegex)) {
@@ -241,6 +458,28 @@ class PrimaryExpression : public Expression {
             return name;
         }
 
+        std::optional<std::int64_t> getIntegerConstant() const override {
+            std::int64_t value = 0;
+            const char* first = name.data();
+            const char* last = name.data() + name.size();
+            if (first != last && *first == '+') {
+                ++first;
+            }
+            auto [ptr, ec] = std::from_chars(first, last, value);
+            if (ec != std::errc() || ptr != last) {
+                return std::nullopt;
+            }
+            return value;
+        }
+
+        bool isNumericLiteral() const override {
+            return !name.empty() && std::isdigit(static_cast<unsigned char>(name.front())); // identifiers never start with a digit
+        }
+
+        int countReads(const std::string& variable) const override {
+            return name == variable ? 1 : 0;
+        }
+
         void accept(IVisitor* visitor) const override {
             visitor->visit(this);
         }
@@ -264,6 +503,23 @@ class BinaryExpression : public Expression {
 
             std::cout << "Binary Expression: Left type: " << leftType << " Right type: " << rightType << "\n"; // Print the types of the left and right operands
 
+            // Nothing is promoted implicitly; only an untyped literal adopts the other operand's type
+            auto operandType = commonOperandType(*left, leftType, *right, rightType);
+            if (operandType.empty()) {
+                throw std::runtime_error("Binary expressions only support operands of the same type, got " + leftType + " " + op + " " + rightType + ". Convert one operand explicitly, e.g. " + sourceTypeName(leftType) + "(...).");
+            }
+
+            // Strings concatenate with '+' and compare for equality; there is no ordering on them
+            if (operandType == "string") {
+                if (op == "+") {
+                    return "string";
+                }
+                if (op == "equals" || op == "notEquals") {
+                    return "bool";
+                }
+                throw std::runtime_error("Strings support '+', 'equals' and 'notEquals' only, got '" + op + "'.");
+            }
+
             // List of operations that should return a boolean type
             std::set<std::string> comparisonOps = { "<", ">", "<=", ">=", "equals", "notEquals" };
             std::set<std::string> logicalOps = { "and", "or" };
@@ -272,15 +528,16 @@ class BinaryExpression : public Expression {
             if (comparisonOps.find(op) != comparisonOps.end() || logicalOps.find(op) != logicalOps.end()) {
                 // For simplicity, assuming left and right operands are of compatible types for these operations
                 std::cout << "We are in the comparison or logical operation\n";
+                // Vectors compare lane by lane into a mask, and masks combine lane by lane
+                if (isVectorType(operandType) || isMaskType(operandType)) {
+                    return "mask" + std::to_string(vectorLanes(operandType));
+                }
                 return "bool";
             }
             else if (op == "+" || op == "-" || op == "*" || op == "/" || op == "%") {
                 // Arithmetic operations: return the type based on the operands
-                if (leftType == "int" && rightType == "int") {
-                    return "int";
-                }
-                else if (leftType == "float" && rightType == "float") {
-                    return "float";
+                if (isNumericType(operandType) || isVectorType(operandType)) {
+                    return operandType;
                 }
                 else {
                     throw std::runtime_error("Type mismatch in arithmetic binary expression. Unsupported operand types.");
@@ -291,6 +548,14 @@ class BinaryExpression : public Expression {
             }
         }
 
+        bool isUpdateOf(const std::string& name, const std::string& updateOp) const override {
+            return op == updateOp && ((left->getName() == name) != (right->getName() == name));
+        }
+
+        int countReads(const std::string& variable) const override {
+            return left->countReads(variable) + right->countReads(variable);
+        }
+
         std::string getName() const override {
             return "binary";
         }
@@ -321,6 +586,22 @@ class UnaryExpression : public Expression {
             return "unary";
         }
 
+        std::optional<std::int64_t> getIntegerConstant() const override {
+            auto value = expr->getIntegerConstant();
+            if (value && op == "-") {
+                return -*value;
+            }
+            return std::nullopt;
+        }
+
+        bool isNumericLiteral() const override {
+            return op == "-" && expr->isNumericLiteral();
+        }
+
+        int countReads(const std::string& variable) const override {
+            return expr->countReads(variable);
+        }
+
         void accept(IVisitor* visitor) const override {
             visitor->visit(this);
         }
@@ -350,20 +631,240 @@ public:
 	}
 
     std::string getType(SymbolTable& symbolTable) const override {
-		// Check if the method is declared
-		auto symbolInfo = symbolTable.getSymbolInfo(name);
+		// add and remove both return the element they added or removed
+		auto symbolInfo = symbolTable.getSymbolInfo(object->getName());
         if (!symbolInfo.has_value()) {
-			throw std::runtime_error("Method " + name + " not declared.");
+			throw std::runtime_error("Object " + object->getName() + " not declared.");
 		}
-		return symbolInfo->type;
+		return symbolInfo->elementType.empty() ? symbolInfo->type : symbolInfo->elementType;
 	}
 
+    int countReads(const std::string& variable) const override {
+        return object->countReads(variable) + countArgumentReads(arguments, variable);
+    }
+
     void accept(IVisitor* visitor) const override {
 		visitor->visit(this);
 	}
         
 };
 
+class CallExpression : public Expression {
+    public:
+        std::string name;
+        std::vector<std::unique_ptr<Expression>> arguments;
+        mutable bool tailCall = false; // Set by the semantic analyzer when the call is the whole operand of a ret()
+
+        CallExpression(std::string name, std::vector<std::unique_ptr<Expression>> arguments)
+            : name(std::move(name)), arguments(std::move(arguments)) {}
+
+        std::string toString() const override {
+            std::string args;
+            for (const auto& arg : arguments) {
+                if (!args.empty()) args += ", ";
+                args += arg->toString();
+            }
+            return "cE(" + std::string(tailCall ? "tail " : "") + name + "(" + args + "))";
+        }
+
+        std::string getType(SymbolTable& symbolTable) const override {
+            auto functionInfo = symbolTable.getFunctionInfo(name);
+            if (!functionInfo.has_value()) {
+                throw std::runtime_error("Function " + name + " not declared.");
+            }
+            return functionInfo->returnType;
+        }
+
+        std::string getName() const override {
+            return "call";
+        }
+
+        int countReads(const std::string& variable) const override {
+            return countArgumentReads(arguments, variable);
+        }
+
+        void accept(IVisitor* visitor) const override {
+            visitor->visit(this);
+        }
+};
+
+// Explicit numeric conversion, written as a call to the target type: i64(count), dbl(ratio), int(x)
+class ConversionExpression : public Expression {
+    public:
+        std::string targetType;
+        std::unique_ptr<Expression> expr;
+
+        ConversionExpression(std::string targetType, std::unique_ptr<Expression> expr)
+            : targetType(std::move(targetType)), expr(std::move(expr)) {}
+
+        std::string toString() const override {
+            return "convE(" + targetType + "(" + expr->toString() + "))";
+        }
+
+        std::string getType(SymbolTable& symbolTable) const override {
+            return normalizeType(targetType);
+        }
+
+        std::string getName() const override {
+            return "conversion";
+        }
+
+        int countReads(const std::string& variable) const override {
+            return expr->countReads(variable);
+        }
+
+        void accept(IVisitor* visitor) const override {
+            visitor->visit(this);
+        }
+};
+
+// Builds a SIMD vector: vec4f(x) splats x (or converts a vec4i lane by lane), vec4f(a, b, c, d) sets each lane
+class VectorExpression : public Expression {
+    public:
+        std::string type;
+        std::vector<std::unique_ptr<Expression>> arguments;
+
+        VectorExpression(std::string type, std::vector<std::unique_ptr<Expression>> arguments)
+            : type(std::move(type)), arguments(std::move(arguments)) {}
+
+        std::string toString() const override {
+            std::string args;
+            for (const auto& arg : arguments) {
+                if (!args.empty()) args += ", ";
+                args += arg->toString();
+            }
+            return "vecE(" + type + "(" + args + "))";
+        }
+
+        std::string getType(SymbolTable& symbolTable) const override {
+            return type;
+        }
+
+        std::string getName() const override {
+            return "vector";
+        }
+
+        int countReads(const std::string& variable) const override {
+            return countArgumentReads(arguments, variable);
+        }
+
+        void accept(IVisitor* visitor) const override {
+            visitor->visit(this);
+        }
+};
+
+// Built-in vector operations, called without 'call': select(mask, a, b), hsum(v), hmin(v), hmax(v),
+// any(mask), all(mask), lane(v, i), load4(array, i), load8(array, i) and store(array, i, v),
+// plus len(s), the length of a string in bytes
+class BuiltinCall : public Expression {
+    public:
+        std::string name;
+        std::vector<std::unique_ptr<Expression>> arguments;
+
+        BuiltinCall(std::string name, std::vector<std::unique_ptr<Expression>> arguments)
+            : name(std::move(name)), arguments(std::move(arguments)) {}
+
+        std::string toString() const override {
+            std::string args;
+            for (const auto& arg : arguments) {
+                if (!args.empty()) args += ", ";
+                args += arg->toString();
+            }
+            return "bI(" + name + "(" + args + "))";
+        }
+
+        // Whether the first argument names an array rather than being a value
+        bool takesArray() const {
+            return name == "load4" || name == "load8" || name == "store";
+        }
+
+        std::string getType(SymbolTable& symbolTable) const override {
+            auto expectArguments = [&](std::size_t count) {
+                if (arguments.size() != count) {
+                    throw std::runtime_error("Built-in '" + name + "' expects " + std::to_string(count) + " argument(s), got " + std::to_string(arguments.size()) + ".");
+                }
+            };
+            auto argumentType = [&](std::size_t index) {
+                return arguments[index]->getType(symbolTable);
+            };
+
+            if (name == "hsum" || name == "hmin" || name == "hmax") {
+                expectArguments(1);
+                auto vectorType = argumentType(0);
+                if (!isVectorType(vectorType)) {
+                    throw std::runtime_error("'" + name + "' reduces a vector, found " + vectorType + ".");
+                }
+                return vectorElementType(vectorType);
+            }
+            if (name == "any" || name == "all") {
+                expectArguments(1);
+                if (!isMaskType(argumentType(0))) {
+                    throw std::runtime_error("'" + name + "' expects a mask from a vector comparison, found " + argumentType(0) + ".");
+                }
+                return "bool";
+            }
+            if (name == "select") {
+                expectArguments(3);
+                auto condition = argumentType(0);
+                auto valueType = commonOperandType(*arguments[1], argumentType(1), *arguments[2], argumentType(2));
+                bool lanewise = isMaskType(condition) && isVectorType(valueType) && vectorLanes(condition) == vectorLanes(valueType);
+                if (valueType.empty() || !(lanewise || (condition == "bool" && !isMaskType(valueType)))) {
+                    throw std::runtime_error("'select' expects a mask and two vectors of its width, or a bool and two values of the same type.");
+                }
+                return valueType;
+            }
+            if (name == "lane") {
+                expectArguments(2);
+                if (!isVectorType(argumentType(0)) || !isIntegerType(argumentType(1))) {
+                    throw std::runtime_error("'lane' expects a vector and an integer lane index.");
+                }
+                return vectorElementType(argumentType(0));
+            }
+            if (name == "len") {
+                expectArguments(1);
+                if (argumentType(0) != "string") {
+                    throw std::runtime_error("'len' expects a string, found " + argumentType(0) + ".");
+                }
+                return "int";
+            }
+            if (takesArray()) {
+                expectArguments(name == "store" ? 3 : 2);
+                auto array = symbolTable.getSymbolInfo(arguments[0]->getName());
+                if (!array.has_value() || array->type != "array") {
+                    throw std::runtime_error("'" + name + "' expects an array as its first argument.");
+                }
+                if (!isIntegerType(argumentType(1))) {
+                    throw std::runtime_error("'" + name + "' expects an integer index, found " + argumentType(1) + ".");
+                }
+                if (name == "store") {
+                    auto vectorType = argumentType(2);
+                    if (!isVectorType(vectorType) || vectorElementType(vectorType) != array->elementType) {
+                        throw std::runtime_error("'store' into a " + sourceTypeName(array->elementType) + " array expects a vector of " + sourceTypeName(array->elementType) + ", found " + vectorType + ".");
+                    }
+                    return vectorType;
+                }
+                auto vectorType = vectorTypeFor(array->elementType, name == "load4" ? 4 : 8);
+                if (vectorType.empty()) {
+                    throw std::runtime_error("There is no vector type for " + array->elementType + " elements; load from an int or flt array.");
+                }
+                return vectorType;
+            }
+            throw std::runtime_error("Unknown built-in '" + name + "'. Functions are called with 'call " + name + "(...)'.");
+        }
+
+        std::string getName() const override {
+            return "builtin";
+        }
+
+        int countReads(const std::string& variable) const override {
+            return countArgumentReads(arguments, variable);
+        }
+
+        void accept(IVisitor* visitor) const override {
+            visitor->visit(this);
+        }
+};
+
 //Statements
 
 class PrintStatement : public Statement {
@@ -385,11 +886,12 @@ class WhileLoopStatement : public Statement {
     public:
         std::unique_ptr<Expression> condition;
         std::unique_ptr<Statement> body;
-        WhileLoopStatement(std::unique_ptr<Expression> condition, std::unique_ptr<Statement> body)
-            : condition(std::move(condition)), body(std::move(body)) {}
+        std::vector<Annotation> annotations; // loop pragmas, e.g. @unroll(4)
+        WhileLoopStatement(std::unique_ptr<Expression> condition, std::unique_ptr<Statement> body, std::vector<Annotation> annotations = {})
+            : condition(std::move(condition)), body(std::move(body)), annotations(std::move(annotations)) {}
         
         std::string toString() const override {
-            return "WhileLoopStatement(" + condition->toString() + " " + body->toString() + ")";
+            return "WhileLoopStatement(" + annotationsToString(annotations) + condition->toString() + " " + body->toString() + ")";
         }
 
         void accept(IVisitor* visitor) const override {
@@ -402,11 +904,24 @@ class ForLoopStatement : public Statement {
         std::unique_ptr<Expression> start;
         std::unique_ptr<Expression> end;
         std::unique_ptr<Statement> body;
-        ForLoopStatement(std::unique_ptr<Expression> start, std::unique_ptr<Expression> end, std::unique_ptr<Statement> body)
-            : start(std::move(start)), end(std::move(end)), body(std::move(body)) {}
+        std::unique_ptr<Expression> step; // optional, defaults to 1
+        std::string iteratorName; // optional name the body uses to read the induction variable
+        std::vector<Annotation> annotations; // loop pragmas, e.g. @unroll(4)
+        bool parallel; // loop parallel range(...), iterations run on the runtime thread pool
+        std::vector<Reduction> reductions; // shared variables a parallel loop may update, combined per worker
+        ForLoopStatement(std::unique_ptr<Expression> start, std::unique_ptr<Expression> end, std::unique_ptr<Statement> body,
+            std::unique_ptr<Expression> step = nullptr, std::string iteratorName = "", std::vector<Annotation> annotations = {},
+            bool parallel = false, std::vector<Reduction> reductions = {})
+            : start(std::move(start)), end(std::move(end)), body(std::move(body)), step(std::move(step)), iteratorName(std::move(iteratorName)),
+              annotations(std::move(annotations)), parallel(parallel), reductions(std::move(reductions)) {}
         
         std::string toString() const override {
-            return "ForLoopStatement(" + start->toString() + " " + end->toString() + " " + body->toString() + ")";
+            std::string result = "ForLoopStatement(" + annotationsToString(annotations) + (parallel ? "parallel " : "") + start->toString() + " " + end->toString() +
+                (step ? " step " + step->toString() : "") + (iteratorName.empty() ? "" : " as " + iteratorName);
+            for (const auto& reduction : reductions) {
+                result += " reduce(" + reduction.op + ": " + reduction.variable + ")";
+            }
+            return result + " " + body->toString() + ")";
         }
 
         void accept(IVisitor* visitor) const override {
@@ -471,12 +986,16 @@ class ReturnStatement : public Statement {
 class BlockStatement : public Statement {
     public:
         std::vector<std::unique_ptr<Statement>> statements;
+        std::vector<std::unique_ptr<Declaration>> declarations; // Local to the block, written before its statements
 
-        BlockStatement(std::vector<std::unique_ptr<Statement>> statements)
-            : statements(std::move(statements)) {}
+        BlockStatement(std::vector<std::unique_ptr<Statement>> statements, std::vector<std::unique_ptr<Declaration>> declarations = {})
+            : statements(std::move(statements)), declarations(std::move(declarations)) {}
         
         std::string toString() const override {
             std::string result = "BlockStatement: ";
+            for (const auto& decl : declarations) {
+                result += decl->toString() + " ";
+            }
             for (const auto& stmt : statements) {
                 result += stmt->toString() + " ";
             }
@@ -503,6 +1022,29 @@ class ExpressionStatement : public Statement {
         }
 };
 
+// arena { declarations statements }: the strings and arrays built inside the block are allocated
+// from one region, which is released as a whole when the block ends
+class ArenaStatement : public Statement {
+    public:
+        std::vector<std::unique_ptr<Declaration>> declarations; // Local to the block, written before its statements
+        std::unique_ptr<Statement> body; // BlockStatement with the statements
+
+        ArenaStatement(std::vector<std::unique_ptr<Declaration>> declarations, std::unique_ptr<Statement> body)
+            : declarations(std::move(declarations)), body(std::move(body)) {}
+
+        std::string toString() const override {
+            std::string result = "ArenaStatement: ";
+            for (const auto& decl : declarations) {
+                result += decl->toString() + " ";
+            }
+            return result + body->toString();
+        }
+
+        void accept(IVisitor* visitor) const override {
+            visitor->visit(this);
+        }
+};
+
 
 class FunctionDefinition : public Function {
     public:
@@ -510,13 +1052,28 @@ class FunctionDefinition : public Function {
         std::vector<ParamInfo> parameters;
         std::string returnType;
         std::vector<std::unique_ptr<Statement>> body;
+        std::vector<Annotation> annotations; // e.g. @tailrec
         
-        FunctionDefinition(std::string name, std::vector<ParamInfo> parameters, std::string returnType, std::vector<std::unique_ptr<Statement>> body)
-            : name(std::move(name)), parameters(std::move(parameters)), returnType(std::move(returnType)), body(std::move(body)) {}
+        FunctionDefinition(std::string name, std::vector<ParamInfo> parameters, std::string returnType, std::vector<std::unique_ptr<Statement>> body,
+            std::vector<Annotation> annotations = {})
+            : name(std::move(name)), parameters(std::move(parameters)), returnType(std::move(returnType)), body(std::move(body)), annotations(std::move(annotations)) {}
+
+        const FunctionDefinition* getDefinition() const override {
+            return this;
+        }
+
+        bool hasAnnotation(const std::string& annotationName) const {
+            for (const auto& annotation : annotations) {
+                if (annotation.name == annotationName) {
+                    return true;
+                }
+            }
+            return false;
+        }
         
         std::string toString() const override {
             std::stringstream ss;
-            ss << "FunctionDefinition " << name << "(";
+            ss << annotationsToString(annotations) << "FunctionDefinition " << name << "(";
             for (size_t i = 0; i < parameters.size(); ++i) {
                 ss << parameters[i].name << ": " << parameters[i].type;
                 if (i < parameters.size() - 1) ss << ", ";
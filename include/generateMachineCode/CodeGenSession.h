@@ -0,0 +1,46 @@
+#ifndef CODE_GEN_SESSION_H
+#define CODE_GEN_SESSION_H
+
+#include "llvm/IR/Module.h"
+#include "llvm/Support/CodeGen.h"
+#include "llvm/Target/TargetMachine.h"
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include "generateMachineCode/genObjFile.h"
+#include "llvmOptimize/LLVMOptimizer.h"
+
+// What compiling a module needs that does not depend on the module: the native
+// target, a target machine for each code generator level (all for the same
+// CodeGenTarget, which the optimizer plans for too) and the optimizer's
+// pass builder and analysis managers. main keeps one session for the whole run,
+// so a batch of files sets them up once instead of for every module (twice per
+// file for the target machine). Not thread safe: the threads of ParallelCodeGen
+// and ThinLTO set up their own.
+class CodeGenSession {
+public:
+    explicit CodeGenSession(const CodeGenTarget& target = {});
+
+    // ParallelCodeGen and ThinLTO build their own target machines for it
+    const CodeGenTarget& getTarget() const { return target; }
+
+    // For target, created the first time optLevel is asked for; nullptr if the target or CPU is not available
+    llvm::TargetMachine* targetMachine(llvm::CodeGenOptLevel optLevel);
+
+    // LLVMOptimizer::optimize with the session's passes, rebuilt only when the settings they depend on change.
+    // The module is set up for the target machine of optLevel first, so pass the level its object is built with
+    void optimize(llvm::Module* module, const OptimizationOptions& options, llvm::CodeGenOptLevel optLevel = llvm::CodeGenOptLevel::Default);
+
+    // GenerateOBJ::generateObjectFile and generateBitcodeFile with the session's target machines
+    void generateObjectFile(llvm::Module* module, const std::string& outputFilename, llvm::CodeGenOptLevel optLevel = llvm::CodeGenOptLevel::Default);
+    void generateBitcodeFile(llvm::Module* module, const std::string& outputFilename, bool withSummary = false);
+
+private:
+    CodeGenTarget target;
+    std::map<llvm::CodeGenOptLevel, std::unique_ptr<llvm::TargetMachine>> targetMachines;
+    std::unique_ptr<OptimizationPasses> passes;
+};
+
+#endif // CODE_GEN_SESSION_H
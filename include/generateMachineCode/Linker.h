@@ -0,0 +1,35 @@
+#ifndef LINKER_H
+#define LINKER_H
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// What Linker::link builds; main fills it in from --link, --shared and --runtime
+struct LinkOptions {
+    bool shared = false; // --shared: a shared library instead of an executable
+    bool pie = true; // A position independent executable; objects built with --reloc=static can only be linked without
+    std::string runtimeLibrary = "libSSLRuntime.a"; // --runtime=<file>: the SSLRuntime archive CMake builds
+};
+
+// --link: links the object files of a program and the SSL runtime into an
+// executable or shared library with the lld ELF driver, inside the compiler
+// instead of a clang and ld process per program. The C runtime start files
+// and libraries clang would add are looked up in the host's glibc and GCC
+// directories. Unused sections are dropped (--gc-sections) and identical
+// functions folded (--icf=all). lld is not thread safe: link one program at
+// a time.
+class Linker {
+public:
+    // Links objectFiles into outputFilename; throws if a file is missing or lld fails
+    static void link(const std::vector<std::string>& objectFiles, const std::string& outputFilename, const LinkOptions& options);
+
+    // The program of "tests/x.ssl" is "genExecutable/x", or "genExecutable/libx.so" when shared. Defined here so
+    // the codegen tests can check it in builds without lld
+    static std::string outputFilename(const std::string& sourceFile, bool shared) {
+        std::string name = std::filesystem::path(sourceFile).stem().string();
+        return "genExecutable/" + (shared ? "lib" + name + ".so" : name);
+    }
+};
+
+#endif // LINKER_H
\ No newline at end of file
@@ -0,0 +1,32 @@
+#ifndef PARALLEL_CODE_GEN_H
+#define PARALLEL_CODE_GEN_H
+
+#include "llvm/IR/Module.h"
+#include "llvm/Support/CodeGen.h"
+
+#include <string>
+#include <vector>
+
+#include "generateMachineCode/genObjFile.h"
+#include "llvmOptimize/LLVMOptimizer.h"
+
+// Optimizes a module and emits its machine code on several threads, for --jobs.
+// The module simplification pipeline (inlining, interprocedural passes) runs
+// on the whole module first; the module is then split into one partition per
+// job (at most one per function), each partition is written to bitcode and
+// read back into an LLVMContext of its own, and up to one thread per core
+// runs the optimization pipeline and the code generator on one partition
+// after another, with a target machine per partition. Each partition becomes
+// an object file; link them all.
+class ParallelCodeGen {
+public:
+    // Writes the optimized IR of partition i to <irFilename stem>.<i>.ll and its machine code to
+    // <objFilename stem>.<i>.o, and returns the object file names
+    static std::vector<std::string> generateObjectFiles(llvm::Module* module, const OptimizationOptions& options, unsigned jobs,
+        const std::string& irFilename, const std::string& objFilename, llvm::CodeGenOptLevel optLevel, const CodeGenTarget& target = {});
+
+    // partition 2 of "genObjectFile/optimized_x.o" is "genObjectFile/optimized_x.2.o"
+    static std::string partitionFilename(const std::string& filename, unsigned partition);
+};
+
+#endif // PARALLEL_CODE_GEN_H
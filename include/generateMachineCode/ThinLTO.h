@@ -0,0 +1,27 @@
+#ifndef THIN_LTO_H
+#define THIN_LTO_H
+
+#include "llvm/Passes/OptimizationLevel.h"
+#include "llvm/Support/CodeGen.h"
+
+#include <string>
+#include <vector>
+
+#include "generateMachineCode/genObjFile.h"
+
+// The link step of --thin-lto. The inputs are the bitcode files (with module
+// summaries) of every file of one program. The thin link reads only their
+// summaries to decide which functions each module imports from the others;
+// then a backend per module imports them, finishes the optimization pipeline
+// and emits machine code, all modules in parallel. A backend whose module,
+// imports and exports have not changed since the last run is taken from
+// cacheDir instead of being run again.
+class ThinLTO {
+public:
+    // Writes the machine code of bitcodeFiles[i] to objectFiles[i] for target; an empty cacheDir disables the cache.
+    // shared keeps every symbol that isn't hidden exported, for a --shared library, instead of only main
+    static void link(const std::vector<std::string>& bitcodeFiles, const std::vector<std::string>& objectFiles,
+        const llvm::OptimizationLevel& level, llvm::CodeGenOptLevel optLevel, const CodeGenTarget& target, unsigned jobs, const std::string& cacheDir, bool shared);
+};
+
+#endif // THIN_LTO_H
@@ -2,11 +2,47 @@
 #define GEN_OBJ_FILE_H
 
 #include "llvm/IR/Module.h"
+#include "llvm/Support/CodeGen.h"
+#include "llvm/Target/TargetMachine.h"
+#include <memory>
+#include <optional>
 #include <string>
 
+// The machine object files are built for; main fills it in from --march, --mattr, --reloc and --code-model.
+// The defaults run on any CPU of the host's architecture and link into any executable or shared library
+struct CodeGenTarget {
+	std::string cpu = "generic"; // --march=<cpu>, as llc -mcpu; "native" is the CPU this compiler runs on, with all of its features
+	std::string features; // --mattr=<+feature,-feature,...>, as llc -mattr: turned on or off on top of the CPU's
+	llvm::Reloc::Model relocationModel = llvm::Reloc::PIC_; // --reloc=static objects only link into executables built with -no-pie
+	std::optional<llvm::CodeModel::Model> codeModel; // --code-model=small|medium|large|kernel, the target's default without it
+
+	// cpu with native replaced by the host's CPU name
+	std::string cpuName() const;
+	// The feature string of the target machine: the host's features for native, then features, which win
+	std::string featureString() const;
+};
+
 class GenerateOBJ {
 public:
-	static void generateObjectFile(llvm::Module* module, const std::string& outputFilename);
+	static void initializeTargets(); // Once per process; generateObjectFile calls it
+	// For the host, with the settings every object file is built with; nullptr if the target or CPU is not available
+	static std::unique_ptr<llvm::TargetMachine> createTargetMachine(llvm::CodeGenOptLevel optLevel, const CodeGenTarget& target = {});
+	// Sets the module's triple and data layout to the target machine's, and its CPU and features on every function
+	// defined in it, so the optimizer's cost model (vector width, unrolling) and later links agree with the code generator
+	static void setTarget(llvm::Module* module, const llvm::TargetMachine& targetMachine);
+	// optLevel is the code generator's own level: instruction selection, scheduling and register allocation effort
+	static void generateObjectFile(llvm::Module* module, const std::string& outputFilename, llvm::CodeGenOptLevel optLevel = llvm::CodeGenOptLevel::Default, const CodeGenTarget& target = {});
+	// The same with a target machine that is kept for more modules; CodeGenSession passes its own
+	static void emitObjectFile(llvm::Module* module, const std::string& outputFilename, llvm::TargetMachine& targetMachine);
+	// For modules optimized with an LTO pre-link pipeline, which the linker finishes; ThinLTO needs the
+	// module summary (what each function calls and references) and the module hash its cache is keyed on
+	static void generateBitcodeFile(llvm::Module* module, const std::string& outputFilename, bool withSummary = false, const CodeGenTarget& target = {});
+	static void writeBitcodeFile(llvm::Module* module, const std::string& outputFilename, const llvm::TargetMachine& targetMachine, bool withSummary = false);
+
+	// The model for --reloc=static or --reloc=pic, nullopt for anything else
+	static std::optional<llvm::Reloc::Model> parseRelocationModel(const std::string& name);
+	// The model for --code-model=small, medium, large or kernel, nullopt for anything else
+	static std::optional<llvm::CodeModel::Model> parseCodeModel(const std::string& name);
 };
 
 #endif // GEN_OBJ_FILE_H
\ No newline at end of file
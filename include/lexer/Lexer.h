@@ -15,7 +15,8 @@ public:
         Return, Loop, Int, Float, String, Bool, Arrow, StringLiteral,
         FloatLiteral, Log, Not, Equals, NotEquals, Or, And, Uninitialized,
         For, While, Print, Call, True, False, LessThanEqual, GreaterThanEqual,
-        Array, ArrayAdd, ArrayRemove
+        Array, ArrayAdd, ArrayRemove, As, At, Parallel, Reduce, I8, I16, I64,
+        Double, Vec4f, Vec8f, Vec4i, Vec8i, Arena
     };
 
     Token() noexcept : m_kind{Kind::End}, m_lexeme{""} {} //default constructor
@@ -37,9 +38,15 @@ public:
     std::string_view lexeme() const noexcept;
     void lexeme(std::string_view lexeme) noexcept;
 
+    unsigned line() const noexcept; // 1-based, 0 if the token was not produced by a Lexer
+    unsigned column() const noexcept;
+    void location(unsigned line, unsigned column) noexcept;
+
 private:
     Kind m_kind{};
     std::string_view m_lexeme{};
+    unsigned m_line = 0;
+    unsigned m_column = 0;
 
     bool is_one_of() const noexcept {
         return false;
@@ -48,10 +55,11 @@ private:
 
 class Lexer {
 public:
-    Lexer(const char* beg) noexcept : m_beg{beg}, m_original_beg{beg} {}
-    Token next() noexcept;
+    Lexer(const char* beg) noexcept : m_beg{beg}, m_original_beg{beg}, m_line_scan{beg}, m_line_begin{beg} {}
+    Token next() noexcept; // Next token, stamped with its line and column
 
 private:
+    Token scan() noexcept;
     Token identifier() noexcept;
     Token number() noexcept;
     Token slash_or_comment() noexcept;
@@ -63,6 +71,11 @@ private:
 
     const char* m_beg = nullptr;
     const char* m_original_beg = nullptr; // Added this line
+
+    // Tokens come out in source order, so lines are counted incrementally up to each new token
+    const char* m_line_scan = nullptr;
+    const char* m_line_begin = nullptr;
+    unsigned m_line = 1;
 };
 
 bool is_space(char c) noexcept;
@@ -2,6 +2,7 @@
 #define LLVM_CODE_GEN_H
 
 #include "ast/ASTNodes.h"
+#include "semanticAnalyzer/EscapeAnalysis.h"
 #include "visitor/Visitor.h"
 
 #include "llvm/IR/LLVMContext.h"
@@ -9,6 +10,10 @@
 #include "llvm/IR/Module.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/Verifier.h"
+#include "llvm/IR/DIBuilder.h"
+
+#include <functional>
+#include <unordered_set>
 
 class LLVMCodeGen : public IVisitor {
 public:  
@@ -16,7 +21,13 @@ public:
     ~LLVMCodeGen();
 
     llvm::Module* getModule() const;
-    llvm::Value* evaluateExpression(Expression* expr);
+    void enableDebugInfo(const std::string& sourcePath); // -g: emit DWARF for sourcePath; call before visiting the program
+    void enableFunctionInstrumentation(); // --instrument-functions: time every SSL function with the ssl_profile_* runtime hooks
+    // --thin-lto: a function another file of the program defines; call before visiting the program
+    void declareExternalFunction(const FunctionDefinition* funcDef);
+    void setLibraryModule(); // --thin-lto: the program's main is in another file's module, this one only has functions
+    const EscapeAnalysis& getEscapeAnalysis() const; // Which values visiting the program kept in stack frames, for --escape-report
+    llvm::Value* evaluateExpression(Expression* expr, llvm::Type* literalType = nullptr); // literalType: the type an untyped literal in expr should take
     void tryLoadAndDebug(llvm::Value* ptr, const PrimaryExpression* expr);
     void ensureMainFunctionExist();
 
@@ -27,6 +38,7 @@ public:
     void visit(const StringDeclaration* decl) override;
     void visit(const BoolDeclaration* decl) override;
     void visit(const ArrayDeclaration* decl) override;
+    void visit(const VectorDeclaration* decl) override;
     void visit(const ReturnStatement* stmt) override;
     void visit(const ForLoopStatement* stmt) override;
     void visit(const WhileLoopStatement* stmt) override;
@@ -35,11 +47,16 @@ public:
     void visit(const PrintStatement* stmt) override;
     void visit(const BlockStatement* stmt) override;
     void visit(const ExpressionStatement* stmt) override;
+    void visit(const ArenaStatement* stmt) override;
     void visit(const BinaryExpression* expr) override;
     void visit(const UnaryExpression* expr) override;
     void visit(const PrimaryExpression* expr) override;
     void visit(const AssignmentExpression* expr) override;
     void visit(const MethodCall* expr) override;
+    void visit(const CallExpression* expr) override;
+    void visit(const ConversionExpression* expr) override;
+    void visit(const VectorExpression* expr) override;
+    void visit(const BuiltinCall* expr) override;
     void visit(const FunctionDefinition* expr) override;
     void visit(const FunctionCall* call) override;
 
@@ -51,6 +68,7 @@ private:
 
     llvm::Function* currentFunction = nullptr;
     llvm::Value* lastValue = nullptr;
+    llvm::Type* literalType = nullptr; // Type expected of the expression being evaluated, used for untyped literals
 
     std::unordered_map<std::string, llvm::Value*> currentLocals; // Current function's local variables
     std::unordered_map<std::string, llvm::GlobalVariable*> globals; // Global variables
@@ -58,11 +76,87 @@ private:
 
     std::vector<std::string> functionCalls;
 
+    // SSL functions use tailcc: musttail calls between them are guaranteed even when the prototypes differ
+    static constexpr llvm::CallingConv::ID sslCallingConv = llvm::CallingConv::Tail;
+
     llvm::Function* mallocFunction; // External declaration for malloc
     llvm::Function* reallocFunction; // External declaration for realloc
     llvm::Function* freeFunction;   // External declaration for free
+
+    // Dynamic arrays are { data, length, capacity, [N x elem] inline buffer }
+    static constexpr std::uint64_t arrayInlineCapacity = 8;
+    llvm::StructType* arrayHeaderType = nullptr;
+    std::vector<llvm::Value*> functionArrays; // Arrays declared in the current function, freed when they go out of scope
+    std::vector<llvm::Value*> globalArrays; // Global arrays, freed when main returns
+
+    // Handles of the arena blocks open in the current function, innermost last. Arrays declared in
+    // an arena block grow inside it and are released with it instead of one by one.
+    std::vector<llvm::Value*> arenas;
+    std::unordered_map<llvm::Value*, llvm::Value*> arenaArrays; // Array alloca -> its arena
+
+    // Strings are { data, length } values; short ones are stored inline (see ssl_string in SSLRuntime.h)
+    llvm::StructType* stringType = nullptr;
+
+    // Run over the whole program before any code is emitted. Arrays it bounds get an inline buffer for
+    // every element they can hold; strs that never leave their function are concatenated into a stack buffer.
+    EscapeAnalysis escapeAnalysis;
+    std::unordered_set<llvm::Value*> boundedArrays; // Array allocas of the current function that never outgrow their inline buffer
+    std::unordered_map<const EscapeAnalysis::Allocation*, llvm::AllocaInst*> stringBuffers; // Stack buffer of each str of the current function
+    // Arena of the current function for the strs that never leave it but may outgrow their stack buffer;
+    // entered where the function starts and released at every return, null when it has no such str
+    llvm::Value* localStringArena = nullptr;
     
     void initializeExternalFunctions();
+    llvm::Value* lookupVariable(const std::string& name); // Local first, then global storage for a variable
+    llvm::Type* getVariableType(llvm::Value* storage); // Type stored in a variable's alloca or global, nullptr if unknown
+    llvm::Type* getLLVMType(const std::string& type); // int, i8, i16, i64, flt, dbl, bool, str, void, a vector type or a mask
+    void unifyLiteralOperands(Expression* leftExpr, llvm::Value*& left, Expression* rightExpr, llvm::Value*& right);
+    void emitFloatingBinary(const std::string& op, llvm::Value* left, llvm::Value* right);
+    llvm::Function* declareFunction(const FunctionDefinition* funcDef); // Creates the prototype on first use, with the attributes from its annotations
+    void emitCountedLoop(llvm::Value* startVal, llvm::Value* endVal, llvm::ConstantInt* stepVal, const std::string& iteratorName, const Statement* body,
+        const std::vector<Annotation>& annotations);
+    llvm::MDNode* buildLoopMetadata(const std::vector<Annotation>& annotations); // llvm.loop node for loop pragmas, nullptr if there are none
+    void emitParallelLoop(const ForLoopStatement* stmt, llvm::Value* startVal, llvm::Value* endVal); // Outlines the body and runs it on the runtime thread pool
+    void emitWorkerLoop(llvm::Value* workerCount, const std::function<void(llvm::Value*)>& emitBody);
+    llvm::Constant* getReductionIdentity(const std::string& op, llvm::Type* type);
+    llvm::Value* emitReductionOp(const std::string& op, llvm::Value* lhs, llvm::Value* rhs);
+
+    // Debug info, only created with -g. Lexical blocks are kept innermost last; each belongs to one function.
+    std::unique_ptr<llvm::DIBuilder> debugBuilder;
+    llvm::DICompileUnit* debugUnit = nullptr;
+    llvm::DIFile* debugFile = nullptr;
+    std::vector<llvm::DILexicalBlock*> debugBlocks;
+    llvm::DISubprogram* createDebugFunction(llvm::Function* function, const std::string& name, SourceLocation location);
+    llvm::DIScope* getDebugScope(llvm::Function* function); // Innermost open block of function, or its subprogram
+    void emitDebugLocation(const ASTNode* node); // Attributes the instructions that follow to node's line and column
+    void declareDebugVariable(llvm::AllocaInst* storage, const std::string& name, unsigned argNo); // argNo is 1-based for parameters, 0 for locals
+    void declareDebugGlobal(llvm::GlobalVariable* global, const std::string& name, SourceLocation location);
+    llvm::DIType* getDebugType(llvm::Type* type); // nullptr for types the debugger is not told about
+
+    bool instrumentFunctions = false;
+    bool libraryModule = false;
+    void emitProfileEnter(const std::string& functionName);
+    void emitProfileExit(); // Before every ret of an instrumented function, and before a musttail call
+
+    llvm::StructType* getArrayType(llvm::Value* arrayPtr);
+    llvm::StructType* getArrayHeaderType();
+    llvm::StructType* getStringType();
+    llvm::Constant* getStringConstant(const std::string& text);
+    llvm::Value* emitStringArgument(llvm::Value* string); // Spills a string value so it can be passed to the runtime by pointer
+    llvm::Value* emitStringLength(llvm::Value* string);
+    llvm::Value* emitStringBinary(const std::string& op, llvm::Value* left, llvm::Value* right, llvm::AllocaInst* stackBuffer = nullptr); // stackBuffer: where + may put its result
+    void createStringBuffer(const ASTNode* declaration, const std::string& name); // Entry-block buffer for a str escape analysis kept on the stack
+    llvm::Function* getArrayGrowFunction();
+    llvm::Function* getArrayFreeFunction();
+    llvm::Value* emitArrayAdd(llvm::Value* arrayPtr, llvm::StructType* arrayType, llvm::Value* element);
+    llvm::Value* emitArrayRemove(llvm::Value* arrayPtr, llvm::StructType* arrayType);
+    llvm::Value* emitVectorSlot(llvm::Value* arrayPtr, llvm::StructType* arrayType, llvm::Value* index, unsigned lanes); // Address of lanes elements from index, trapping past the length
+    void emitArrayCleanup(const std::vector<llvm::Value*>& arrays, std::size_t firstIndex);
+    void emitArenaRelease(std::size_t firstIndex); // Exits the open arenas from the innermost down to firstIndex
+    void enterLocalStringArena(const std::string& functionName);
+    void emitLocalStringArenaRelease();
+
+    llvm::FunctionCallee getRuntimeFunction(const std::string& name, llvm::Type* returnType, llvm::ArrayRef<llvm::Type*> paramTypes); // Declares an SSL runtime entry point on first use
 
 };  
 #endif // LLVM_CODE_GEN_H
\ No newline at end of file
@@ -0,0 +1,39 @@
+#ifndef ADAPTIVE_OPTIMIZATION_H
+#define ADAPTIVE_OPTIMIZATION_H
+
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/PassInstrumentation.h"
+#include "llvm/Passes/PassBuilder.h"
+
+// --adaptive-opt: how much of the pipeline each function gets, so the compile
+// time goes to the code that runs often. The tier is kept in the function's
+// "ssl-opt-tier" attribute, so it survives --jobs splitting and bitcode, and a
+// function is classified only once.
+class AdaptiveOptimization {
+public:
+    enum class Tier {
+        Full,    // Every pass of the level: @hot and profile-hot functions, functions with loops and small functions
+        Reduced, // optsize and only the cheap cleanups (SROA, EarlyCSE, SimplifyCFG, DCE): huge functions without loops
+        Minimal  // optnone, so neither the pipeline nor the code generator optimizes it: @cold and profile-cold functions
+    };
+
+    // Unoptimized instructions above which a function without loops is only cleaned up
+    static constexpr unsigned hugeFunctionInstructions = 400;
+
+    static Tier classify(const llvm::Function& function);
+    static Tier tierOf(const llvm::Function& function);
+    static void apply(llvm::Function& function, Tier tier);
+
+    // Classifies the functions of module that have no tier yet; call before the pipeline runs
+    static void classifyModule(llvm::Module& module);
+
+    // Skips the expensive passes on Reduced functions and every optional pass on optnone ones
+    static void registerCallbacks(llvm::PassInstrumentationCallbacks& callbacks);
+
+    // With --profile-use: once the profile is in the IR, hot functions get the full optimization
+    // pipeline and functions that are cold in the whole call graph become Minimal
+    static void registerProfilePolicy(llvm::PassBuilder& builder);
+};
+
+#endif // ADAPTIVE_OPTIMIZATION_H
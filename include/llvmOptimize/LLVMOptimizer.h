@@ -1,11 +1,84 @@
 #ifndef LLVM_OPTIMIZER_H
 #define LLVM_OPTIMIZER_H
 
+#include "llvm/Analysis/CGSCCPassManager.h"
+#include "llvm/Analysis/LoopAnalysisManager.h"
 #include "llvm/IR/Module.h"
+#include "llvm/IR/PassInstrumentation.h"
+#include "llvm/IR/PassManager.h"
+#include "llvm/Passes/OptimizationLevel.h"
+#include "llvm/Passes/PassBuilder.h"
+
+#include <memory>
+#include <optional>
+#include <string>
+
+class OptimizationRemarks;
+class OptimizationReport;
+
+// What LLVMOptimizer::optimize runs on a module; main fills it in from the command line
+struct OptimizationOptions {
+    // The default pipeline of a level is the module simplification pipeline (inlining and the interprocedural
+    // passes, which need the whole module) followed by the optimization pipeline (vectorization, unrolling and
+    // other function passes); ParallelCodeGen runs the second half on each partition of a split module
+    enum class PipelinePart { Whole, Simplification, Optimization };
+
+    llvm::OptimizationLevel level = llvm::OptimizationLevel::O3; // -O0, -O1, -O2, -O3, -Os or -Oz
+    std::string passes; // --passes=<pipeline>: this pipeline in opt's textual syntax replaces the one for level
+    bool ltoPreLink = false; // --lto-prelink: the pre-link half of full LTO; the module is meant to be written as bitcode
+    bool thinLTOPreLink = false; // --thin-lto: the pre-link half of ThinLTO, for bitcode with a module summary
+    std::string profileGenerateDir; // instruments the module so the program writes .profraw files there
+    std::string profileUseFile; // optimizes with a profile (.profdata, or .profraw files and directories that are merged first)
+    bool adaptive = false; // --adaptive-opt: the full pipeline only for hot, looping or small functions (see AdaptiveOptimization)
+    PipelinePart part = PipelinePart::Whole; // Ignored with passes, ltoPreLink, thinLTOPreLink or at O0
+    OptimizationReport* report = nullptr; // --opt-report=<file.json>: records every pass run, shared by all files of a batch
+    OptimizationRemarks* remarks = nullptr; // --remarks=<file.yaml> and --explain-opt: collects what the vectorizers, inliner, LICM and GVN did and missed
+    // The machine the module is compiled for (see GenerateOBJ::setTarget): its costs and vector width drive the vectorizers
+    // and unrolling. Without one the pipeline plans for a target with no vector registers
+    llvm::TargetMachine* targetMachine = nullptr;
+};
+
+// The pass builder, its instrumentation and the four analysis managers LLVMOptimizer::optimize runs a
+// pipeline with. They only depend on the profile, report, adaptive and target settings, so CodeGenSession builds
+// them once and reuses them for every module with those settings; a raw profile is merged only then too.
+// The analysis results are cleared after each module. Not thread safe: each thread needs its own.
+class OptimizationPasses {
+public:
+    explicit OptimizationPasses(const OptimizationOptions& options);
+    OptimizationPasses(const OptimizationPasses&) = delete; // The pass builder points at PIC
+    OptimizationPasses& operator=(const OptimizationPasses&) = delete;
+
+    // Whether options would build the same passes
+    bool builtFor(const OptimizationOptions& options) const;
+
+private:
+    friend class LLVMOptimizer;
+    void clear();
+
+    std::string profileGenerateDir;
+    std::string profileUseFile;
+    OptimizationReport* report;
+    bool adaptive;
+    llvm::TargetMachine* targetMachine;
+
+    llvm::PassInstrumentationCallbacks PIC;
+    std::unique_ptr<llvm::PassBuilder> PB;
+    llvm::LoopAnalysisManager LAM;
+    llvm::FunctionAnalysisManager FAM;
+    llvm::CGSCCAnalysisManager CGAM;
+    llvm::ModuleAnalysisManager MAM;
+};
 
 class LLVMOptimizer {
 public:
-    static void optimize(llvm::Module* module);
+    // Builds the passes for this module alone unless it gets ones built for the same settings
+    static void optimize(llvm::Module* module, const OptimizationOptions& options = {}, OptimizationPasses* passes = nullptr);
+
+    // The level for -O0, -O1, -O2, -O3, -Os or -Oz, nullopt for any other argument
+    static std::optional<llvm::OptimizationLevel> parseLevel(const std::string& flag);
+
+    // Merges a .profraw file, or every .profraw file in a directory, into genObjectFile/<file or directory name>.profdata and returns its path
+    static std::string mergeProfiles(const std::string& rawProfiles);
 };
 
-#endif // LLVM_OPTIMIZER_H
\ No newline at end of file
+#endif // LLVM_OPTIMIZER_H
@@ -0,0 +1,21 @@
+#ifndef LOG_COALESCING_H
+#define LOG_COALESCING_H
+
+#include "llvm/IR/Function.h"
+#include "llvm/IR/PassManager.h"
+
+// Merges each run of log() calls in a basic block whose output is known at
+// compile time (str literals and values that folded to constants) into one
+// ssl_log_str call of a constant str holding all of their lines, formatted
+// here the way the runtime would. Values only known at run time keep their
+// own ssl_log_* call: the runtime already buffers every log(), and passing
+// them to one formatting call costs more than the calls it saves. A run ends
+// at anything that could print. LLVMOptimizer runs it last, once the values
+// being logged are as simplified as they get; --passes knows it as
+// ssl-log-coalesce.
+class LogCoalescingPass : public llvm::PassInfoMixin<LogCoalescingPass> {
+public:
+    llvm::PreservedAnalyses run(llvm::Function& function, llvm::FunctionAnalysisManager& FAM);
+};
+
+#endif // LOG_COALESCING_H
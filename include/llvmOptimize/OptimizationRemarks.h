@@ -0,0 +1,46 @@
+#ifndef OPTIMIZATION_REMARKS_H
+#define OPTIMIZATION_REMARKS_H
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/IR/DiagnosticInfo.h"
+#include "llvm/IR/LLVMContext.h"
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Collects the optimization remarks of the vectorizers, the inliner, LICM and
+// GVN while modules are optimized, for --remarks=<file.yaml> and
+// --explain-opt: what each pass did (passed), what it could not do (missed)
+// and why (analysis), at the SSL function and line it is about. Lines need
+// debug info, so main turns on -g when remarks are asked for. One collection
+// is shared by all files of a batch and by the threads of --jobs.
+class OptimizationRemarks {
+public:
+    struct Remark {
+        std::string kind; // "Passed", "Missed" or "Analysis", as in LLVM's remark YAML
+        std::string pass;
+        std::string name;
+        std::string function;
+        std::string file; // Empty when the remark has no source location
+        unsigned line = 0;
+        unsigned column = 0;
+        std::string message;
+    };
+
+    static bool isCollected(llvm::StringRef pass);
+
+    // Sends the remarks of every module in context here; call before optimizing
+    void attach(llvm::LLVMContext& context);
+    void add(const llvm::DiagnosticInfoOptimizationBase& remark);
+
+    // In LLVM's YAML remark format, readable by opt-viewer and llvm-remarkutil; false if it could not be written
+    bool writeYAML(const std::string& path) const;
+    std::string explain() const; // For --explain-opt: the remarks by file and line, each one once
+
+private:
+    mutable std::mutex lock;
+    std::vector<Remark> remarks;
+};
+
+#endif // OPTIMIZATION_REMARKS_H
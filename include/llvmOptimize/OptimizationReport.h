@@ -0,0 +1,79 @@
+#ifndef OPTIMIZATION_REPORT_H
+#define OPTIMIZATION_REPORT_H
+
+#include "llvm/ADT/Any.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/PassInstrumentation.h"
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Collects what each pass of the optimization pipeline costs and does, for
+// --opt-report=<file.json>: wall time per pass and per function, instruction
+// and basic block counts of the IR a pass ran on before and after it, and
+// which passes never changed anything. One report is shared by every file of a
+// batch, so the numbers add up across files, and by the threads of --jobs.
+class OptimizationReport {
+public:
+    struct PassStats {
+        std::uint64_t runs = 0;
+        std::uint64_t changedRuns = 0; // Runs that did not preserve all analyses
+        double milliseconds = 0;
+        std::uint64_t instructionsBefore = 0; // Summed over the runs whose IR was still there afterwards
+        std::uint64_t instructionsAfter = 0;
+        std::uint64_t blocksBefore = 0;
+        std::uint64_t blocksAfter = 0;
+    };
+
+    struct FunctionStats {
+        std::uint64_t passRuns = 0;
+        double milliseconds = 0;
+    };
+
+    // The following passes optimize file's module; called before the pipeline is built
+    void beginFile(const std::string& file);
+    void registerCallbacks(llvm::PassInstrumentationCallbacks& callbacks);
+
+    // Writes the report as JSON; returns false if the file could not be written
+    bool write(const std::string& path) const;
+
+private:
+    struct Size {
+        std::uint64_t instructions = 0;
+        std::uint64_t blocks = 0;
+    };
+
+    // A pass that has started and not finished yet; passes nest (a function pass manager runs inside a module pass)
+    struct RunningPass {
+        std::chrono::steady_clock::time_point start;
+        const llvm::Module* module = nullptr; // The IR that is measured again afterwards: the module, or
+        std::vector<const llvm::Function*> measuredFunctions; // the functions of a function, loop or SCC pass
+        bool scc = false; // Its functions may be gone when an SCC pass invalidates the SCC
+        std::string unit; // Function the pass ran on, "(module)" or the functions of a call graph SCC
+        Size before;
+        bool measured = false; // before is known; false for pass managers and adaptors
+    };
+
+    std::vector<std::string> files;
+    std::string currentFile;
+    std::mutex lock; // Partitions of a split module are optimized on several threads
+    std::map<std::thread::id, std::vector<RunningPass>> running;
+    std::map<std::string, PassStats> passes;
+    std::map<std::pair<std::string, std::string>, FunctionStats> functions; // (file, unit) ->
+
+    void beforePass(llvm::StringRef pass, const llvm::Any& ir);
+    void afterPass(llvm::StringRef pass, const llvm::Any* ir, bool changed);
+
+    static bool isContainer(llvm::StringRef pass); // Pass managers, adaptors and wrappers whose time is that of the passes they run
+    static Size measure(const llvm::Module& module);
+    static Size measure(const llvm::Function& function);
+};
+
+#endif // OPTIMIZATION_REPORT_H
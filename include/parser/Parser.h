@@ -26,14 +26,27 @@ public:
     void advance();
     void consume(Token::Kind kind, const std::string& errorMessage);
     const Token& peekToken() const;
+    static bool isNumericTypeKeyword(const Token& token); // int, i8, i16, i64, flt or dbl
+    static bool isVectorTypeKeyword(const Token& token); // vec4f, vec8f, vec4i or vec8i
+    SourceLocation currentLocation() const; // Line and column of currentToken
+
+    // Records where a node started, unless a nested parse already did
+    template <typename Node>
+    static std::unique_ptr<Node> located(std::unique_ptr<Node> node, SourceLocation start) {
+        if (node && node->location.line == 0) {
+            node->location = start;
+        }
+        return node;
+    }
 
     //Declaration parsing
     std::unique_ptr<Declaration> parseDeclaration(); 
-    std::unique_ptr<Declaration> parseIntDeclaration(); //int x = 5;
-    std::unique_ptr<Declaration> parseFloatDeclaration(); //flt x = 5.0;
+    std::unique_ptr<Declaration> parseIntDeclaration(); //int x = 5; i8, i16 and i64 as well
+    std::unique_ptr<Declaration> parseFloatDeclaration(); //flt x = 5.0; dbl x = 5.0;
     std::unique_ptr<Declaration> parseStringDeclaration(); //str x = "hello";
     std::unique_ptr<Declaration> parseBoolDeclaration(); //bool x = true;
     std::unique_ptr<Declaration> parseArrayDeclaration(); //int[] x = {1,2,3};
+    std::unique_ptr<Declaration> parseVectorDeclaration(); //vec4f v = {1.0, 2.0, 3.0, 4.0}; vec8i zero = 0;
 
     // Expression parsing
     std::unique_ptr<Expression> parseExpression(); 
@@ -42,23 +55,32 @@ public:
     std::unique_ptr<Expression> parseUnary(); //-x, not x;
     std::unique_ptr<Expression> parsePrimary(); //x;
     std::unique_ptr<Expression> parseMethodCall(std::unique_ptr<Expression> object); //add(2,3);
+    std::unique_ptr<Expression> parseConversion(); //i64(x), dbl(ratio)
+    std::unique_ptr<Expression> parseVectorExpression(); //vec4f(x), vec4i(1, 2, 3, 4)
+    std::unique_ptr<Expression> parseBuiltinCall(); //hsum(v), select(mask, a, b), load8(values, i)
+    std::unique_ptr<Expression> parseCallExpression(); //call add(2,3) inside a function body, e.g. ret(call add(2,3));
 
     //Statement parsing
     std::unique_ptr<Statement> parseStatement();
     std::unique_ptr<Statement> parsePrintStatement(); //log(2+3);
-    std::unique_ptr<Statement> parseLoopStatement(); //loop range(2,3) or loop(x<2) {} support for loops with range and while condition
-    std::unique_ptr<Statement> parseWhileLoop(); //while (x < 5) {}
-    std::unique_ptr<Statement> parseForLoop(); //for (int i = 0; i < 5; i++) {}
+    std::unique_ptr<Statement> parseLoopStatement(std::vector<Annotation> annotations = {}); //loop range(2,3) or loop(x<2) {} support for loops with range and while condition
+    std::unique_ptr<Statement> parseWhileLoop(std::vector<Annotation> annotations = {}); //while (x < 5) {}
+    std::unique_ptr<Statement> parseForLoop(std::vector<Annotation> annotations = {}, bool parallel = false); //for (int i = 0; i < 5; i++) {}
     std::unique_ptr<Statement> parseIfStatement(); //if (x > 5) {}
     std::unique_ptr<Statement> parseReturnStatement(); //ret 2+3;
+    std::unique_ptr<Statement> parseArenaBlock(); //arena { str line = ""; line = line + "x"; }
+
+    //Annotation parsing
+    std::vector<Annotation> parseAnnotations(); //@unroll(8) @vectorize(width=8)
 
     //Function parsing
     std::unique_ptr<Function> parseFunction(); //function add(a: int, b: int) -> int {}
-    std::unique_ptr<Function> parseFunctionDefinition(); //function add(a: int, b: int) -> int {}
+    std::unique_ptr<Function> parseFunctionDefinition(std::vector<Annotation> annotations = {}); //function add(a: int, b: int) -> int {}
     std::unique_ptr<Function> parseFunctionCall(); //add(2,3); (this is for statements)
 
     //Block parsing
     std::unique_ptr<Statement> parseBlock(); //{int x = 5;}
+    std::vector<std::unique_ptr<Declaration>> parseLocalDeclarations(); // The declarations a block starts with
 
     //Program parsing
     std::unique_ptr<Program> parseProgram();
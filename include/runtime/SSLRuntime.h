@@ -0,0 +1,106 @@
+#ifndef SSL_RUNTIME_H
+#define SSL_RUNTIME_H
+
+#include <atomic>
+#include <cstdint>
+
+// Entry points linked into every compiled SSL program. LLVMCodeGen lowers
+// log() to the type-specialized ssl_log_* functions below; output is
+// formatted into a per-thread buffer and written out in large chunks.
+extern "C" {
+
+void ssl_log_i32(std::int32_t value);
+void ssl_log_i64(std::int64_t value);
+void ssl_log_f32(float value);
+void ssl_log_f64(double value);
+void ssl_log_bool(bool value);
+
+// An SSL str: 16 bytes passed by value between SSL functions. Up to
+// sslStringInlineCapacity bytes are kept in the value itself, with the length
+// and a set high bit in the top byte of `length`, so short strings never touch
+// memory. Longer ones point into a string arena. The top byte has to be the
+// last of the 16, which only holds on little-endian targets.
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#error "The inline ssl_string encoding needs a little-endian target"
+#endif
+struct ssl_string {
+    const char* data;
+    std::int64_t length;
+};
+
+// Strings are passed by pointer so the C and LLVM views of the struct cannot disagree on any ABI.
+void ssl_log_str(const ssl_string* value);
+bool ssl_str_equals(const ssl_string* left, const ssl_string* right);
+
+// Writes left + right to result. The bytes go to the calling thread's arena;
+// when left is the newest string there, right is appended in place, so
+// building a string piece by piece costs time proportional to its length.
+void ssl_str_concat(const ssl_string* left, const ssl_string* right, ssl_string* result);
+
+// Memory of an `arena { }` block. LLVMCodeGen calls ssl_arena_enter where the
+// block starts and ssl_arena_exit where it ends or returns; the strings and
+// array buffers allocated in between are released together, and the memory
+// is recycled for the next arena on the same thread. Arenas nest and belong
+// to the thread that entered them.
+struct ssl_arena;
+ssl_arena* ssl_arena_enter();
+void ssl_arena_exit(ssl_arena* arena);
+
+// Resizes an allocation of oldSize bytes, in place when nothing was allocated
+// after it. data may also point outside the arena (e.g. an array's inline
+// buffer), in which case its bytes are copied into the arena.
+void* ssl_arena_resize(ssl_arena* arena, void* data, std::int64_t oldSize, std::int64_t newSize);
+
+// ssl_str_concat, allocating the result in arena instead.
+void ssl_str_concat_in(ssl_arena* arena, const ssl_string* left, const ssl_string* right, ssl_string* result);
+
+// ssl_str_concat for a str escape analysis proved never leaves its function:
+// the bytes go to buffer, capacity bytes in the caller's stack frame that may
+// already hold left or right. A result that does not fit goes to arena: the
+// innermost arena block, or one LLVMCodeGen enters for the whole function and
+// releases when it returns. When arena is null (in a parallel loop body) it
+// goes to the thread's string arena.
+void ssl_str_concat_local(char* buffer, std::int64_t capacity, ssl_arena* arena, const ssl_string* left, const ssl_string* right, ssl_string* result);
+
+// Writes out everything buffered by the calling thread.
+void ssl_flush();
+
+// Body of a `loop parallel range`, outlined by LLVMCodeGen. It runs the
+// iterations [begin, end) and accumulates its reductions into the slots of
+// `worker`, which is unique among the threads running concurrently.
+typedef void (*ssl_parallel_body)(std::int32_t begin, std::int32_t end, void* context, std::int32_t worker);
+
+// Runs body over [begin, end) on the work-stealing thread pool and returns
+// once every iteration has finished. The calling thread takes part as worker 0.
+void ssl_parallel_for(std::int32_t begin, std::int32_t end, ssl_parallel_body body, void* context);
+
+// Number of workers ssl_parallel_for uses, including the calling thread.
+// Defaults to the hardware concurrency, or SSL_NUM_THREADS when it is set.
+std::int32_t ssl_parallel_worker_count();
+
+// Resizes the pool; must not be called while a parallel loop is running.
+void ssl_parallel_set_worker_count(std::int32_t count);
+
+// One per SSL function compiled with --instrument-functions. LLVMCodeGen
+// emits it as a constant name and an id of -1, which the first call replaces.
+struct ssl_profile_site {
+    const char* name;
+    std::atomic<std::int32_t> id;
+};
+
+// Called on entry to and on every exit from an instrumented function (a
+// tail call exits before it jumps). Calls and inclusive/exclusive cycles
+// are counted per thread; a report sorted by exclusive cycles is written to
+// stderr at exit, and as JSON to SSL_PROFILE_JSON (default ssl_profile.json).
+void ssl_profile_enter(ssl_profile_site* site);
+void ssl_profile_exit();
+
+}
+
+constexpr std::int64_t sslStringInlineCapacity = 15;
+
+// Upper bound on ssl_parallel_worker_count(); codegen sizes the per-worker
+// reduction slots with it.
+constexpr std::int32_t sslParallelMaxWorkers = 256;
+
+#endif // SSL_RUNTIME_H
@@ -0,0 +1,114 @@
+#ifndef ESCAPE_ANALYSIS_H
+#define ESCAPE_ANALYSIS_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../visitor/Visitor.h"
+
+class ASTNode;
+
+// Finds the local arrays and str values of each function (arena block
+// declarations and str parameters) that never leave it: they are not
+// returned, passed to a function, copied into another variable or captured
+// by a parallel loop. LLVMCodeGen keeps those in the function's stack frame:
+// an array whose adds are bounded gets an inline buffer big enough for all of
+// them, and a str gets a buffer its concatenations are written to instead of
+// a string arena. Runs on a program the SemanticAnalyzer has accepted.
+class EscapeAnalysis : public IVisitor {
+public:
+    static constexpr std::uint64_t maxStackBytes = 4096; // Largest buffer one value may take in a stack frame
+    static constexpr std::uint64_t unboundedStringBytes = 256; // Buffer of a str whose length is not known; longer results fall back to an arena
+
+    struct Allocation {
+        std::string function;
+        std::string name;
+        std::string kind; // "array" or "str"
+        unsigned line = 0; // Of the declaration, or of the function for a parameter
+        const ASTNode* declaration = nullptr; // ArrayDeclaration or StringDeclaration, the FunctionDefinition for a parameter
+        bool onStack = false;
+        std::optional<std::uint64_t> bound; // Most elements (array) or bytes (str) the value can hold, if known
+        std::uint64_t stackBytes = 0; // Size of the stack buffer when onStack
+        std::string reason; // Why the value stays where it is when !onStack
+    };
+
+    void visit(const IntDeclaration* decl) override;
+    void visit(const FloatDeclaration* decl) override;
+    void visit(const StringDeclaration* decl) override;
+    void visit(const BoolDeclaration* decl) override;
+    void visit(const ArrayDeclaration* decl) override;
+    void visit(const VectorDeclaration* decl) override;
+
+    void visit(const AssignmentExpression* expr) override;
+    void visit(const PrimaryExpression* expr) override;
+    void visit(const BinaryExpression* expr) override;
+    void visit(const UnaryExpression* expr) override;
+    void visit(const MethodCall* expr) override;
+    void visit(const CallExpression* expr) override;
+    void visit(const ConversionExpression* expr) override;
+    void visit(const VectorExpression* expr) override;
+    void visit(const BuiltinCall* expr) override;
+
+    void visit(const PrintStatement* stmt) override;
+    void visit(const WhileLoopStatement* stmt) override;
+    void visit(const ForLoopStatement* stmt) override;
+    void visit(const AssignmentStatement* stmt) override;
+    void visit(const IfStatement* stmt) override;
+    void visit(const ReturnStatement* stmt) override;
+    void visit(const BlockStatement* stmt) override;
+    void visit(const ExpressionStatement* stmt) override;
+    void visit(const ArenaStatement* stmt) override;
+
+    void visit(const FunctionDefinition* funcDef) override;
+    void visit(const FunctionCall* call) override;
+    void visit(const Program* program) override;
+
+    // The result for the array or str `name` declared by declaration, nullptr if it was not analyzed
+    const Allocation* find(const ASTNode* declaration, const std::string& name) const;
+    // The stack-allocated str a concatenation is assigned to, nullptr if its result goes elsewhere
+    const Allocation* concatTarget(const BinaryExpression* concat) const;
+    const std::vector<Allocation>& getAllocations() const;
+    std::string report() const; // One line per analyzed value, for --escape-report
+
+private:
+    struct Candidate {
+        Allocation allocation;
+        std::size_t loopDepth = 0; // Loops around the declaration; only the ones inside it repeat its growth
+        std::uint64_t elementBytes = 1;
+        bool written = false; // A concatenation writes to it (str) or an add grows it (array)
+        std::uint64_t size = 0; // Elements or bytes so far, counting every add or append as if it ran
+        bool bounded = true;
+        std::string unboundedReason;
+        bool escapes = false;
+        std::string escapeReason;
+    };
+
+    std::vector<Allocation> allocations;
+    std::unordered_map<const BinaryExpression*, std::size_t> concatTargets; // -> index in allocations
+
+    // State of the function being analyzed
+    std::string functionName;
+    std::vector<Candidate> candidates;
+    std::vector<std::pair<const BinaryExpression*, std::size_t>> functionConcats; // Concatenation -> candidate it writes to
+    std::vector<std::unordered_map<std::string, int>> scopes; // Name -> candidate index, -1 for other locals that shadow one
+    std::vector<std::optional<std::uint64_t>> loopTrips; // Trip counts of the enclosing loops, nullopt when not constant
+    std::size_t parallelScope = 0; // Scopes from this index on belong to the enclosing parallel loop body; 0 outside one
+    int pendingConcat = -1; // Candidate the BinaryExpression about to be visited is assigned to
+    bool readOnly = false; // The expression being visited is only read, e.g. an operand of + or equals
+    std::string useReason; // How an expression in the current position would let a value escape
+
+    void addCandidate(const ASTNode* declaration, const std::string& name, const std::string& kind, std::uint64_t size, unsigned line);
+    void declareLocal(const std::string& name); // A local that is not a candidate but hides one with the same name
+    int lookup(const std::string& name, bool* captured = nullptr) const;
+    void grow(std::size_t index, std::optional<std::uint64_t> amount, const std::string& why); // amount per execution of the current statement
+    void markEscape(std::size_t index, const std::string& why);
+    void visitRead(const Expression* expr); // Visits an operand whose value is only read
+    void visitValue(const Expression* expr, const std::string& why); // Visits a value that is kept beyond the expression
+    void visitAssignment(const std::string& name, const Expression* value);
+    void finishFunction();
+};
+
+#endif // ESCAPE_ANALYSIS_H
@@ -1,9 +1,13 @@
 #ifndef SEMANTIC_ANALYZER_H
 #define SEMANTIC_ANALYZER_H
 
+#include <string>
+#include <vector>
+
 #include "../symbolTable/SymbolTable.h"
 #include "../visitor/Visitor.h"
 
+struct Annotation;
 
 class SemanticAnalyzer : public IVisitor{
 public:
@@ -14,12 +18,17 @@ public:
     void visit(const StringDeclaration* decl);
     void visit(const BoolDeclaration* decl);
     void visit(const ArrayDeclaration* decl);
+    void visit(const VectorDeclaration* decl);
 
     void visit(const BinaryExpression* expr);
     void visit(const PrimaryExpression* expr);
     void visit(const UnaryExpression* expr);
     void visit(const AssignmentExpression* expr);
     void visit(const MethodCall* expr);
+    void visit(const CallExpression* expr);
+    void visit(const ConversionExpression* expr);
+    void visit(const VectorExpression* expr);
+    void visit(const BuiltinCall* expr);
 
     void visit(const PrintStatement* stmt);
     void visit(const WhileLoopStatement* stmt);
@@ -29,16 +38,36 @@ public:
     void visit(const ReturnStatement* stmt);
     void visit(const BlockStatement* stmt);
     void visit(const ExpressionStatement* stmt);
+    void visit(const ArenaStatement* stmt);
 
     void visit(const FunctionDefinition* decl);
     void visit(const FunctionCall* call);
 
     void visit(const Program* program);
+
+    // A function defined in another file of the same --thin-lto program; call before visiting the program
+    void declareExternalFunction(const FunctionDefinition* funcDef);
     
 private:
     SymbolTable& symbolTable;
     std::string currentFunctionReturnType;
     bool insideFunction = false;
+    std::vector<std::string> loopVariables; // Induction variables of the enclosing range loops, read-only in their bodies
+    const ForLoopStatement* parallelLoop = nullptr; // Enclosing parallel loop; its body may only write its reductions and its own variables
+    int parallelScopeId = 0; // Scope of the enclosing parallel loop; variables declared in it or deeper belong to one iteration
+    const FunctionDefinition* currentFunction = nullptr;
+    const Expression* tailPosition = nullptr; // Operand of the ret() being checked; a call there is a tail call
+    int arenaDepth = 0; // Arena blocks around the code being checked
+
+    bool isLoopVariable(const std::string& name) const;
+    void checkLoopAnnotations(const std::vector<Annotation>& annotations) const;
+    void checkParallelLoop(const ForLoopStatement* stmt) const;
+    void checkParallelWrite(const std::string& name, const Expression* value) const;
+    void checkParallelReads(const Expression* value, const std::string& updated = "") const; // updated may be read once, as in its own update
+    int stringArena(const Expression& value); // Depth of the arena a str value may live in, 0 for none
+    void checkArenaEscape(const std::string& name, const SymbolInfo& target, const Expression* value);
+    void declareFunction(const FunctionDefinition* funcDef); // Registers the signature so calls may precede the definition
+    void checkFunctionAnnotations(const FunctionDefinition* funcDef) const;
 };
 
 #endif // SEMANTIC_ANALYZER_H
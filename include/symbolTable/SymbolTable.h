@@ -17,6 +17,8 @@ struct ParamInfo {
 struct SymbolInfo {
     std::string type;
     int scopeId;
+    std::string elementType; // Element type of an array, empty otherwise
+    int arenaDepth = 0; // Number of arena blocks around the declaration, 0 outside any
 };
 
 struct FunctionInfo {
@@ -33,8 +35,9 @@ class SymbolTable {
         void enterScope();
         void leaveScope();
 
-        bool addVariable(const std::string& name, const std::string& type);
+        bool addVariable(const std::string& name, const std::string& type, const std::string& elementType = "", int arenaDepth = 0);
         bool isDeclared(const std::string& name);
+        int getCurrentScopeId() const; // Depth of the innermost scope; a SymbolInfo's scopeId is the one it was declared in
         
         std::optional<SymbolInfo> getSymbolInfo(const std::string& name);
 
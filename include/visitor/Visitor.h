@@ -7,6 +7,7 @@ class FloatDeclaration;
 class BoolDeclaration;
 class StringDeclaration;
 class ArrayDeclaration;
+class VectorDeclaration;
 class AssignmentExpression;
 class LogicOrExpression;
 class LogicAndExpression;
@@ -18,6 +19,10 @@ class PrimaryExpression;
 class BinaryExpression;
 class UnaryExpression;
 class MethodCall;
+class CallExpression;
+class ConversionExpression;
+class VectorExpression;
+class BuiltinCall;
 class LoopStatement;
 class PrintStatement;
 class WhileLoopStatement;
@@ -27,6 +32,7 @@ class IfStatement;
 class ReturnStatement;
 class BlockStatement;
 class ExpressionStatement;
+class ArenaStatement;
 class FunctionDefinition;
 class FunctionCall;
 class Program;
@@ -38,12 +44,17 @@ public:
     virtual void visit(const StringDeclaration* decl) = 0;
     virtual void visit(const BoolDeclaration* decl) = 0;
     virtual void visit(const ArrayDeclaration* decl) = 0;
+    virtual void visit(const VectorDeclaration* decl) = 0;
 
     virtual void visit(const AssignmentExpression* expr) = 0;
     virtual void visit(const PrimaryExpression* expr) = 0;
     virtual void visit(const BinaryExpression* expr) = 0;   
     virtual void visit(const UnaryExpression* expr) = 0;
     virtual void visit(const MethodCall* expr) = 0;
+    virtual void visit(const CallExpression* expr) = 0;
+    virtual void visit(const ConversionExpression* expr) = 0;
+    virtual void visit(const VectorExpression* expr) = 0;
+    virtual void visit(const BuiltinCall* expr) = 0;
     
     virtual void visit(const PrintStatement* stmt) = 0;
     virtual void visit(const WhileLoopStatement* stmt) = 0;
@@ -53,6 +64,7 @@ public:
     virtual void visit(const ReturnStatement* stmt) = 0;
     virtual void visit(const BlockStatement* stmt) = 0;
     virtual void visit(const ExpressionStatement* decl) = 0;
+    virtual void visit(const ArenaStatement* stmt) = 0;
 
     virtual void visit(const FunctionDefinition* decl) = 0;
     virtual void visit(const FunctionCall* call) = 0;
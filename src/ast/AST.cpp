@@ -8,14 +8,18 @@
 
 
 std::unique_ptr<Declaration> Parser::parseIntDeclaration() {
-    consume(Token::Kind::Int, "Expected 'int' for this declaration.");
+    if (!currentToken.is_one_of(Token::Kind::Int, Token::Kind::I8, Token::Kind::I16, Token::Kind::I64)) {
+       throw std::runtime_error("Expected 'int', 'i8', 'i16' or 'i64' for this declaration.");
+    }
+    std::string type = std::string(currentToken.lexeme());
+    consume(currentToken.kind(), "Expected '" + type + "' for this declaration.");
 
     if (!currentToken.is(Token::Kind::Identifier)) {
 
-       throw std::runtime_error("Expected variable name after 'int'.");
+       throw std::runtime_error("Expected variable name after '" + type + "'.");
     }
     std::string name = std::string(currentToken.lexeme());
-    consume(Token::Kind::Identifier, "Expected identifier after 'int'.");
+    consume(Token::Kind::Identifier, "Expected identifier after '" + type + "'.");
 
     consume(Token::Kind::Equal, "Expected '=' after variable name.");
     
@@ -27,20 +31,24 @@ std::unique_ptr<Declaration> Parser::parseIntDeclaration() {
 
     consume(Token::Kind::Semicolon, "Expected ';' after variable declaration.");
     
-    return std::make_unique<IntDeclaration>(name, number);
+    return std::make_unique<IntDeclaration>(name, number, type);
 }
 
 std::unique_ptr<Declaration> Parser::parseFloatDeclaration() {
-    consume(Token::Kind::Float, "Expected 'flt' for this declaration.");
+    if (!currentToken.is_one_of(Token::Kind::Float, Token::Kind::Double)) {
+       throw std::runtime_error("Expected 'flt' or 'dbl' for this declaration.");
+    }
+    std::string keyword = std::string(currentToken.lexeme());
+    consume(currentToken.kind(), "Expected 'flt' or 'dbl' for this declaration.");
     
     if (!currentToken.is(Token::Kind::Identifier)) {
-       throw std::runtime_error("Expected variable name after 'flt'.");
+       throw std::runtime_error("Expected variable name after '" + keyword + "'.");
 
 
     }
 
     std::string name = std::string(currentToken.lexeme());
-    consume(Token::Kind::Identifier, "Expected identifier after 'float'.");
+    consume(Token::Kind::Identifier, "Expected identifier after '" + keyword + "'.");
 
     consume(Token::Kind::Equal, "Expected '=' after variable name.");
     
@@ -55,7 +63,7 @@ std::unique_ptr<Declaration> Parser::parseFloatDeclaration() {
 
     consume(Token::Kind::Semicolon, "Expected ';' after variable declaration.");
     
-    return std::make_unique<FloatDeclaration>(name, number);
+    return std::make_unique<FloatDeclaration>(name, number, normalizeType(keyword));
 }
 
 
@@ -108,7 +116,11 @@ std::unique_ptr<Declaration> Parser::parseBoolDeclaration(){
 }
 
 std::unique_ptr<Declaration> Parser::parseArrayDeclaration() {
-    consume(Token::Kind::Int, "Expected 'int' for array declaration."); // Assuming only int arrays for simplicity
+    if (!isNumericTypeKeyword(currentToken)) {
+        throw std::runtime_error("Arrays hold numbers: expected 'int', 'i8', 'i16', 'i64', 'flt' or 'dbl' for array declaration.");
+    }
+    std::string elementType = normalizeType(std::string(currentToken.lexeme()));
+    consume(currentToken.kind(), "Expected element type for array declaration.");
     consume(Token::Kind::Array, "Expected 'ARRAY' for array declaration.");
     std::string arrayName = std::string(currentToken.lexeme());
     consume(Token::Kind::Identifier, "Expected identifier for array name.");
@@ -126,7 +138,36 @@ std::unique_ptr<Declaration> Parser::parseArrayDeclaration() {
     }
     consume(Token::Kind::RightCurly, "Expected '}' to end array initializer list.");
     consume(Token::Kind::Semicolon, "Expected ';' after array declaration.");
-    return std::make_unique<ArrayDeclaration>(arrayName, std::move(elements));
+    return std::make_unique<ArrayDeclaration>(arrayName, std::move(elements), elementType);
+}
+
+std::unique_ptr<Declaration> Parser::parseVectorDeclaration() {
+    if (!isVectorTypeKeyword(currentToken)) {
+        throw std::runtime_error("Expected a vector type for this declaration.");
+    }
+    std::string type = std::string(currentToken.lexeme());
+    consume(currentToken.kind(), "Expected a vector type for this declaration.");
+    std::string name = std::string(currentToken.lexeme());
+    consume(Token::Kind::Identifier, "Expected variable name after '" + type + "'.");
+    consume(Token::Kind::Equal, "Expected '=' after variable name.");
+
+    std::vector<std::unique_ptr<Expression>> elements;
+    if (currentToken.is(Token::Kind::LeftCurly)) {
+        consume(Token::Kind::LeftCurly, "Expected '{' to start vector initializer.");
+        while (!currentToken.is(Token::Kind::RightCurly)) {
+            elements.push_back(parseUnary());
+            if (!currentToken.is(Token::Kind::Comma)) {
+                break;
+            }
+            consume(Token::Kind::Comma, "Expected ',' or '}' in vector initializer.");
+        }
+        consume(Token::Kind::RightCurly, "Expected '}' to end vector initializer.");
+    }
+    else {
+        elements.push_back(parseUnary()); // one value for every lane
+    }
+    consume(Token::Kind::Semicolon, "Expected ';' after vector declaration.");
+    return std::make_unique<VectorDeclaration>(name, type, std::move(elements));
 }
 
 //Parsing expressions
@@ -224,6 +265,12 @@ std::unique_ptr<Expression> Parser::parseBinary() {
 }
 
 std::unique_ptr<Expression> Parser::parsePrimary() {
+    if (isNumericTypeKeyword(currentToken) && nextToken.is(Token::Kind::LeftParen)) {
+        return parseConversion();
+    }
+    if (isVectorTypeKeyword(currentToken) && nextToken.is(Token::Kind::LeftParen)) {
+        return parseVectorExpression();
+    }
     if (currentToken.is_one_of(Token::Kind::Int, Token::Kind::Float, Token::Kind::String)) {
        throw std::runtime_error("Forbidden keyword for expressions. Please use \"int\", \"flt\", or \"str\" for declarations.");
     }
@@ -239,8 +286,11 @@ std::unique_ptr<Expression> Parser::parsePrimary() {
        throw std::runtime_error("No returning for primary expressions");
 
     }
-    else if (currentToken.is_one_of(Token::Kind::Call, Token::Kind::Function)){
-       throw std::runtime_error("No functions calls or definitions in primary expressions.");
+    else if (currentToken.is(Token::Kind::Function)){
+       throw std::runtime_error("No function definitions in primary expressions.");
+    }
+    else if (currentToken.is(Token::Kind::Call)) {
+        return parseCallExpression();
     }
     //else if (currentToken.is_one_of(Token::Kind::LeftCurly, Token::Kind::RightCurly, Token::Kind::LeftParen, Token::Kind::RightParen, Token::Kind::LeftSquare, Token::Kind::RightSquare)) {
     //   throw std::runtime_error("Forbidden keyword for expressions. Do not use curly braces, parentheses, or square brackets in expressions.");
@@ -248,6 +298,9 @@ std::unique_ptr<Expression> Parser::parsePrimary() {
     else if (currentToken.is(Token::Kind::Comment)) {
         advance();
     }
+    else if (currentToken.is(Token::Kind::Identifier) && nextToken.is(Token::Kind::LeftParen)) {
+        return parseBuiltinCall();
+    }
     else if (currentToken.is(Token::Kind::Identifier)) {
         if (nextToken.is_one_of(Token::Kind::ArrayAdd, Token::Kind::ArrayRemove)) { //method calling
             std::string identifier = std::string(currentToken.lexeme());
@@ -271,7 +324,8 @@ std::unique_ptr<Expression> Parser::parsePrimary() {
     }
 
     else if (currentToken.is(Token::Kind::StringLiteral)) {
-		auto expr = std::make_unique<PrimaryExpression>(std::string(currentToken.lexeme()));
+		// The lexeme excludes the quotes; keep them so the literal is not taken for an identifier
+		auto expr = std::make_unique<PrimaryExpression>("\"" + std::string(currentToken.lexeme()) + "\"");
 		consume(Token::Kind::StringLiteral, "Expected string literal.");
 		return expr;
 	}
@@ -290,15 +344,128 @@ std::unique_ptr<Expression> Parser::parsePrimary() {
     return std::make_unique<PrimaryExpression>(std::string(currentToken.lexeme()));
 }
 
+std::unique_ptr<Expression> Parser::parseConversion() {
+    std::string targetType = std::string(currentToken.lexeme());
+    consume(currentToken.kind(), "Expected a type to convert to.");
+    consume(Token::Kind::LeftParen, "Expected '(' after '" + targetType + "'.");
+    auto expr = parseExpression();
+    consume(Token::Kind::RightParen, "Expected ')' after converted expression.");
+    return std::make_unique<ConversionExpression>(targetType, std::move(expr));
+}
+
+std::unique_ptr<Expression> Parser::parseVectorExpression() {
+    std::string type = std::string(currentToken.lexeme());
+    consume(currentToken.kind(), "Expected a vector type.");
+    consume(Token::Kind::LeftParen, "Expected '(' after '" + type + "'.");
+    std::vector<std::unique_ptr<Expression>> arguments;
+    while (!currentToken.is(Token::Kind::RightParen)) {
+        arguments.push_back(parseExpression());
+        if (currentToken.is(Token::Kind::Comma)) {
+            consume(Token::Kind::Comma, "Expected ',' between lanes.");
+        }
+        else if (!currentToken.is(Token::Kind::RightParen)) {
+            throw std::runtime_error("Expected ',' or ')' after lane value.");
+        }
+    }
+    consume(Token::Kind::RightParen, "Expected ')' after lane values.");
+    return std::make_unique<VectorExpression>(type, std::move(arguments));
+}
+
+std::unique_ptr<Expression> Parser::parseBuiltinCall() {
+    std::string name = std::string(currentToken.lexeme());
+    consume(Token::Kind::Identifier, "Expected built-in name.");
+    consume(Token::Kind::LeftParen, "Expected '(' after '" + name + "'.");
+    std::vector<std::unique_ptr<Expression>> arguments;
+    while (!currentToken.is(Token::Kind::RightParen)) {
+        arguments.push_back(parseExpression());
+        if (currentToken.is(Token::Kind::Comma)) {
+            consume(Token::Kind::Comma, "Expected ',' between arguments.");
+        }
+        else if (!currentToken.is(Token::Kind::RightParen)) {
+            throw std::runtime_error("Expected ',' or ')' after argument.");
+        }
+    }
+    consume(Token::Kind::RightParen, "Expected ')' after arguments.");
+    return std::make_unique<BuiltinCall>(name, std::move(arguments));
+}
+
+std::unique_ptr<Expression> Parser::parseCallExpression() {
+    consume(Token::Kind::Call, "Expected 'call' keyword.");
+    std::string name = std::string(currentToken.lexeme());
+    consume(Token::Kind::Identifier, "Expected function name to be identifier");
+    consume(Token::Kind::LeftParen, "Expected '(' after function name.");
+
+    std::vector<std::unique_ptr<Expression>> arguments;
+    while (!currentToken.is(Token::Kind::RightParen)) {
+        arguments.push_back(parseExpression());
+
+        if (currentToken.is(Token::Kind::Comma)) {
+            consume(Token::Kind::Comma, "Expected ',' between arguments.");
+        }
+        else if (!currentToken.is(Token::Kind::RightParen)) {
+            throw std::runtime_error("Expected ',' or ')' after argument.");
+        }
+    }
+    consume(Token::Kind::RightParen, "Expected ')' after arguments.");
+    return std::make_unique<CallExpression>(name, std::move(arguments));
+}
+
+//Parsing annotations
+std::vector<Annotation> Parser::parseAnnotations() {
+    std::vector<Annotation> annotations;
+
+    while (currentToken.is(Token::Kind::At)) {
+        consume(Token::Kind::At, "Expected '@'");
+        Annotation annotation;
+        annotation.name = std::string(currentToken.lexeme());
+        consume(Token::Kind::Identifier, "Expected annotation name after '@'");
+
+        if (currentToken.is(Token::Kind::LeftParen)) { // optional arguments, e.g. @unroll(8) or @vectorize(width=8)
+            consume(Token::Kind::LeftParen, "Expected '(' after annotation name");
+            while (!currentToken.is(Token::Kind::RightParen)) {
+                std::string key;
+                if (currentToken.is(Token::Kind::Identifier) && peekToken().is(Token::Kind::Equal)) {
+                    key = std::string(currentToken.lexeme());
+                    consume(Token::Kind::Identifier, "Expected annotation argument name");
+                    consume(Token::Kind::Equal, "Expected '=' after annotation argument name");
+                }
+                if (!currentToken.is_one_of(Token::Kind::Number, Token::Kind::Identifier, Token::Kind::True, Token::Kind::False)) {
+                    throw std::runtime_error("Expected number or name as argument of annotation @" + annotation.name);
+                }
+                annotation.arguments.emplace_back(key, std::string(currentToken.lexeme()));
+                consume(currentToken.kind(), "Expected annotation argument");
+
+                if (currentToken.is(Token::Kind::Comma)) {
+                    consume(Token::Kind::Comma, "Expected ',' between annotation arguments");
+                }
+                else if (!currentToken.is(Token::Kind::RightParen)) {
+                    throw std::runtime_error("Expected ',' or ')' after annotation argument");
+                }
+            }
+            consume(Token::Kind::RightParen, "Expected ')' after annotation arguments");
+        }
+        annotations.push_back(std::move(annotation));
+    }
+
+    return annotations;
+}
+
 //Parsing statements
-std::unique_ptr<Statement> Parser::parseLoopStatement(){
+std::unique_ptr<Statement> Parser::parseLoopStatement(std::vector<Annotation> annotations){
 
     consume(Token::Kind::Loop, "Expected 'loop'");
-    if (currentToken.is(Token::Kind::Range)) {
-        return parseForLoop(); 
+    if (currentToken.is(Token::Kind::Parallel)) {
+        consume(Token::Kind::Parallel, "Expected 'parallel'");
+        if (!currentToken.is(Token::Kind::Range)) {
+            throw std::runtime_error("Expected 'range' after 'loop parallel'");
+        }
+        return parseForLoop(std::move(annotations), true);
+    }
+    else if (currentToken.is(Token::Kind::Range)) {
+        return parseForLoop(std::move(annotations)); 
     } 
     else if (currentToken.is(Token::Kind::LeftParen)) {
-        return parseWhileLoop();
+        return parseWhileLoop(std::move(annotations));
     }
     else {
        throw std::runtime_error("Expected either 'range' or '(' after 'loop'");
@@ -307,32 +474,72 @@ std::unique_ptr<Statement> Parser::parseLoopStatement(){
     }
 }
 
-std::unique_ptr<Statement> Parser::parseForLoop(){
+std::unique_ptr<Statement> Parser::parseForLoop(std::vector<Annotation> annotations, bool parallel){
     consume(Token::Kind::Range, "Expected 'range'");
     consume(Token::Kind::LeftParen, "Expected '(' after 'range'");
     
     auto start = parseExpression(); // Parse start of range
     consume(Token::Kind::Comma, "Expected ',' after start value");
     auto end = parseExpression(); // Parse end of range
+
+    std::unique_ptr<Expression> step = nullptr;
+    if (currentToken.is(Token::Kind::Comma)) { // optional step, e.g. range(10, 0, -2)
+        consume(Token::Kind::Comma, "Expected ',' after end value");
+        step = parseExpression();
+    }
     consume(Token::Kind::RightParen, "Expected ')' after range values");
+
+    std::string iteratorName;
+    if (currentToken.is(Token::Kind::As)) { // optional induction variable name, e.g. range(0, 10) as i
+        consume(Token::Kind::As, "Expected 'as'");
+        iteratorName = std::string(currentToken.lexeme());
+        consume(Token::Kind::Identifier, "Expected loop variable name after 'as'");
+    }
+
+    std::vector<Reduction> reductions;
+    while (currentToken.is(Token::Kind::Reduce)) { // reduce(+: total, count) on parallel loops
+        if (!parallel) {
+            throw std::runtime_error("'reduce' is only allowed on 'loop parallel range' loops");
+        }
+        consume(Token::Kind::Reduce, "Expected 'reduce'");
+        consume(Token::Kind::LeftParen, "Expected '(' after 'reduce'");
+        std::string op = std::string(currentToken.lexeme());
+        if (!currentToken.is_one_of(Token::Kind::Plus, Token::Kind::Asterisk)) {
+            throw std::runtime_error("Expected '+' or '*' as reduction operator");
+        }
+        consume(currentToken.kind(), "Expected reduction operator");
+        consume(Token::Kind::Colon, "Expected ':' after reduction operator");
+        while (true) {
+            reductions.push_back({ op, std::string(currentToken.lexeme()) });
+            consume(Token::Kind::Identifier, "Expected variable name in reduction");
+            if (!currentToken.is(Token::Kind::Comma)) {
+                break;
+            }
+            consume(Token::Kind::Comma, "Expected ',' between reduction variables");
+        }
+        consume(Token::Kind::RightParen, "Expected ')' after reduction variables");
+    }
     auto body = parseBlock(); // Parse loop body as a block of statements
     
-    return std::make_unique<ForLoopStatement>(std::move(start), std::move(end), std::move(body));
+    return std::make_unique<ForLoopStatement>(std::move(start), std::move(end), std::move(body), std::move(step), iteratorName, std::move(annotations),
+        parallel, std::move(reductions));
 }
 
-std::unique_ptr<Statement> Parser::parseWhileLoop() {
+std::unique_ptr<Statement> Parser::parseWhileLoop(std::vector<Annotation> annotations) {
     consume(Token::Kind::LeftParen, "Expected '(' after while 'loop'");
     auto condition = parseExpression(); // Parse loop condition
     consume(Token::Kind::RightParen, "Expected ')' after condition while loop");
     auto body = parseBlock(); // Parse loop body as a block of statements
     
-    return std::make_unique<WhileLoopStatement>(std::move(condition), std::move(body));
+    return std::make_unique<WhileLoopStatement>(std::move(condition), std::move(body), std::move(annotations));
 }
 
 //Parsing blocks
 std::unique_ptr<Statement> Parser::parseBlock() {
+    SourceLocation blockStart = currentLocation();
     consume(Token::Kind::LeftCurly, "Expected '{' at start of block");
 
+    std::vector<std::unique_ptr<Declaration>> declarations = parseLocalDeclarations();
     std::vector<std::unique_ptr<Statement>> statements;
 
     if(currentToken.is(Token::Kind::Comment)){
@@ -340,12 +547,50 @@ std::unique_ptr<Statement> Parser::parseBlock() {
     }
 
     while (!currentToken.is(Token::Kind::RightCurly) && !currentToken.is(Token::Kind::End)) {
-        statements.push_back(parseStatement());
+        SourceLocation start = currentLocation();
+        statements.push_back(located(parseStatement(), start));
     }
 
     consume(Token::Kind::RightCurly, "Expected '}' at end of block");
 
-    return std::make_unique<BlockStatement>(std::move(statements));
+    return located<Statement>(std::make_unique<BlockStatement>(std::move(statements), std::move(declarations)), blockStart);
+}
+
+std::vector<std::unique_ptr<Declaration>> Parser::parseLocalDeclarations() {
+    // The block's own variables come first, like a function's globals come before its code
+    std::vector<std::unique_ptr<Declaration>> declarations;
+    while (true) {
+        if (currentToken.is(Token::Kind::Comment)) {
+            advance();
+            continue;
+        }
+        bool declaration = isNumericTypeKeyword(currentToken) || isVectorTypeKeyword(currentToken) || currentToken.is_one_of(Token::Kind::String, Token::Kind::Bool);
+        if (!declaration || peekToken().is(Token::Kind::LeftParen)) { // int(x) starts a statement
+            break;
+        }
+        SourceLocation start = currentLocation();
+        declarations.push_back(located(parseDeclaration(), start));
+    }
+    return declarations;
+}
+
+std::unique_ptr<Statement> Parser::parseArenaBlock() {
+    consume(Token::Kind::Arena, "Expected 'arena'.");
+    SourceLocation blockStart = currentLocation();
+    consume(Token::Kind::LeftCurly, "Expected '{' after 'arena'.");
+
+    // The block's own variables come first, so they live until the arena is released
+    std::vector<std::unique_ptr<Declaration>> declarations = parseLocalDeclarations();
+
+    std::vector<std::unique_ptr<Statement>> statements;
+    while (!currentToken.is(Token::Kind::RightCurly) && !currentToken.is(Token::Kind::End)) {
+        SourceLocation start = currentLocation();
+        statements.push_back(located(parseStatement(), start));
+    }
+    consume(Token::Kind::RightCurly, "Expected '}' at end of arena block");
+
+    auto body = located<Statement>(std::make_unique<BlockStatement>(std::move(statements)), blockStart);
+    return std::make_unique<ArenaStatement>(std::move(declarations), std::move(body));
 }
 
 std::unique_ptr<Statement> Parser::parsePrintStatement() {
@@ -407,7 +652,8 @@ std::unique_ptr<Statement> Parser::parseIfStatement() {
 
 
 //Parsing functions
-std::unique_ptr<Function> Parser::parseFunctionDefinition() {
+std::unique_ptr<Function> Parser::parseFunctionDefinition(std::vector<Annotation> annotations) {
+    SourceLocation functionStart = currentLocation();
     consume(Token::Kind::Function, "Expected 'function' keyword.");
     std::string name = std::string(currentToken.lexeme());
     consume(Token::Kind::Identifier, "Expected function name to be identifer");
@@ -418,8 +664,8 @@ std::unique_ptr<Function> Parser::parseFunctionDefinition() {
     while (!currentToken.is(Token::Kind::RightParen)) {
         
         std::string paramType = std::string(currentToken.lexeme());
-        if (currentToken.is_one_of(Token::Kind::Int, Token::Kind::Float, Token::Kind::String)) {
-            consume(currentToken.kind(), "Expected parameter type of which can be int, flt, or str.");
+        if (isNumericTypeKeyword(currentToken) || isVectorTypeKeyword(currentToken) || currentToken.is(Token::Kind::String)) {
+            consume(currentToken.kind(), "Expected parameter type of which can be int, i8, i16, i64, flt, dbl, a vector type or str.");
         }
         consume(Token::Kind::Colon, "Expected colon after parameter type.");
 
@@ -442,10 +688,10 @@ std::unique_ptr<Function> Parser::parseFunctionDefinition() {
 
     consume(Token::Kind::Arrow, "Expected '->' after parameters.");
     std::string returnType = std::string(currentToken.lexeme());
-    if (currentToken.is_one_of(Token::Kind::Int, Token::Kind::Float, Token::Kind::String, Token::Kind::Bool)) {
-        consume(currentToken.kind(), "Expected return type after '->' of which can be int, flt, str or bool");
+    if (isNumericTypeKeyword(currentToken) || isVectorTypeKeyword(currentToken) || currentToken.is_one_of(Token::Kind::String, Token::Kind::Bool)) {
+        consume(currentToken.kind(), "Expected return type after '->' of which can be int, i8, i16, i64, flt, dbl, a vector type, str or bool");
     } else {
-       throw std::runtime_error("Expected return type of either int, flt, str, or bool");
+       throw std::runtime_error("Expected return type of either int, i8, i16, i64, flt, dbl, str, or bool");
 
 
     }
@@ -454,11 +700,12 @@ std::unique_ptr<Function> Parser::parseFunctionDefinition() {
     consume(Token::Kind::LeftCurly, "Expected '{' before function body.");
     
     while (!currentToken.is(Token::Kind::RightCurly) && !currentToken.is(Token::Kind::End)) {
-        body.push_back(parseStatement()); // Parse each statement in the body
+        SourceLocation start = currentLocation();
+        body.push_back(located(parseStatement(), start)); // Parse each statement in the body
     }
     consume(Token::Kind::RightCurly, "Expected '}' after function body.");
 
-    return std::make_unique<FunctionDefinition>(name, parameters, returnType, std::move(body));
+    return located<Function>(std::make_unique<FunctionDefinition>(name, parameters, returnType, std::move(body), std::move(annotations)), functionStart);
 }
 
 std::unique_ptr<Function> Parser::parseFunctionCall() {
@@ -494,14 +741,27 @@ std::unique_ptr<Program> Parser::parseProgram() {
     std::vector<std::unique_ptr<Expression>> expressions;
 
     while (!currentToken.is(Token::Kind::End)) {
+        SourceLocation start = currentLocation();
         if (currentToken.is_one_of(Token::Kind::Function, Token::Kind::Call)) {
-            program->functions.push_back(parseFunction());
+            program->functions.push_back(located(parseFunction(), start));
+        }
+        else if (currentToken.is(Token::Kind::At)) {
+            auto annotations = parseAnnotations();
+            if (currentToken.is(Token::Kind::Function)) {
+                program->functions.push_back(parseFunctionDefinition(std::move(annotations)));
+            }
+            else if (currentToken.is(Token::Kind::Loop)) {
+                program->statements.push_back(located(parseLoopStatement(std::move(annotations)), start));
+            }
+            else {
+                throw std::runtime_error("Annotations must be followed by 'function' or 'loop'");
+            }
         }
-        else if (currentToken.is_one_of(Token::Kind::Int, Token::Kind::Float, Token::Kind::String, Token::Kind::Bool)) {
-            program->declarations.push_back(parseDeclaration());
+        else if (isNumericTypeKeyword(currentToken) || isVectorTypeKeyword(currentToken) || currentToken.is_one_of(Token::Kind::String, Token::Kind::Bool)) {
+            program->declarations.push_back(located(parseDeclaration(), start));
         } 
         else if (currentToken.is_one_of(Token::Kind::Log, Token::Kind::Return, Token::Kind::If, Token::Kind::Loop, Token::Kind::Else)) {
-            program->statements.push_back(parseStatement());
+            program->statements.push_back(located(parseStatement(), start));
         }
         else {
             program->expressions.push_back(parseExpression());
@@ -0,0 +1,38 @@
+#include "generateMachineCode/CodeGenSession.h"
+#include "generateMachineCode/genObjFile.h"
+
+CodeGenSession::CodeGenSession(const CodeGenTarget& target) : target(target) {
+    GenerateOBJ::initializeTargets();
+}
+
+llvm::TargetMachine* CodeGenSession::targetMachine(llvm::CodeGenOptLevel optLevel) {
+    std::unique_ptr<llvm::TargetMachine>& targetMachine = targetMachines[optLevel];
+    if (!targetMachine) {
+        targetMachine = GenerateOBJ::createTargetMachine(optLevel, target);
+    }
+    return targetMachine.get();
+}
+
+void CodeGenSession::optimize(llvm::Module* module, const OptimizationOptions& options, llvm::CodeGenOptLevel optLevel) {
+    OptimizationOptions targeted = options;
+    if (llvm::TargetMachine* machine = targetMachine(optLevel); machine && module) {
+        GenerateOBJ::setTarget(module, *machine);
+        targeted.targetMachine = machine;
+    }
+    if (!passes || !passes->builtFor(targeted)) {
+        passes = std::make_unique<OptimizationPasses>(targeted);
+    }
+    LLVMOptimizer::optimize(module, targeted, passes.get());
+}
+
+void CodeGenSession::generateObjectFile(llvm::Module* module, const std::string& outputFilename, llvm::CodeGenOptLevel optLevel) {
+    if (llvm::TargetMachine* machine = targetMachine(optLevel)) {
+        GenerateOBJ::emitObjectFile(module, outputFilename, *machine);
+    }
+}
+
+void CodeGenSession::generateBitcodeFile(llvm::Module* module, const std::string& outputFilename, bool withSummary) {
+    if (llvm::TargetMachine* machine = targetMachine(llvm::CodeGenOptLevel::Default)) {
+        GenerateOBJ::writeBitcodeFile(module, outputFilename, *machine, withSummary);
+    }
+}
@@ -0,0 +1,147 @@
+#include "lld/Common/Driver.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/TargetParser/Host.h"
+#include "llvm/TargetParser/Triple.h"
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+
+#include "generateMachineCode/Linker.h"
+
+LLD_HAS_DRIVER(elf)
+
+namespace {
+
+// How the host's libraries are laid out for one architecture
+struct HostABI {
+    const char* emulation; // ld -m
+    const char* dynamicLinker;
+    std::string multiarch; // The directory Debian-style distributions keep the libraries of the architecture in
+};
+
+HostABI hostABI() {
+    llvm::Triple triple(llvm::sys::getDefaultTargetTriple());
+    if (!triple.isOSLinux()) {
+        throw std::runtime_error("--link only links ELF programs on Linux, not for " + triple.str() + "; link the object files with clang.");
+    }
+    switch (triple.getArch()) {
+    case llvm::Triple::x86_64:
+        return { "elf_x86_64", "/lib64/ld-linux-x86-64.so.2", "x86_64-linux-gnu" };
+    case llvm::Triple::aarch64:
+        // CMake links only the X86 code generator, so there are no AArch64 objects to link
+        throw std::runtime_error("--link needs AArch64 objects, but this compiler is built with only the X86 code generator; build it with the AArch64 LLVM components.");
+    default:
+        throw std::runtime_error("--link does not know the C runtime of " + triple.str() + "; link the object files with clang.");
+    }
+}
+
+// The first of directories that has file, or "" if none has it
+std::string findIn(const std::vector<std::string>& directories, const std::string& file) {
+    for (const std::string& directory : directories) {
+        std::error_code EC;
+        if (std::filesystem::exists(std::filesystem::path(directory) / file, EC)) {
+            return directory;
+        }
+    }
+    return "";
+}
+
+// The newest GCC installation with crtbegin files, where clang takes them and libgcc from too
+std::string findGCCDirectory(const HostABI& abi) {
+    std::string newest;
+    int newestVersion = -1;
+    for (const std::string& root : { "/usr/lib/gcc/" + abi.multiarch, "/usr/lib64/gcc/" + abi.multiarch, std::string("/usr/lib/gcc/x86_64-redhat-linux") }) {
+        std::error_code EC;
+        for (const auto& entry : std::filesystem::directory_iterator(root, EC)) {
+            // "12" or "12.2.0"; only the major version decides
+            std::string name = entry.path().filename().string();
+            int version = 0;
+            if (llvm::StringRef(name).split('.').first.getAsInteger(10, version) || version <= newestVersion) {
+                continue;
+            }
+            if (std::filesystem::exists(entry.path() / "crtbeginS.o", EC)) {
+                newest = entry.path().string();
+                newestVersion = version;
+            }
+        }
+    }
+    return newest;
+}
+
+}
+
+void Linker::link(const std::vector<std::string>& objectFiles, const std::string& outputFilename, const LinkOptions& options) {
+    // lld keeps global state it can't always reset; after such a link it must not run again in this process
+    static bool canRunAgain = true;
+    if (!canRunAgain) {
+        throw std::runtime_error("lld can't link another program in this process; link " + outputFilename + " with clang.");
+    }
+    if (options.shared && !options.pie) {
+        throw std::runtime_error("A shared library needs position independent objects; drop --reloc=static.");
+    }
+    for (const std::string& file : objectFiles) {
+        if (!std::filesystem::exists(file)) {
+            throw std::runtime_error("Cannot link " + outputFilename + ": " + file + " does not exist.");
+        }
+    }
+    if (!std::filesystem::exists(options.runtimeLibrary)) {
+        throw std::runtime_error("Cannot link " + outputFilename + ": the SSL runtime " + options.runtimeLibrary + " does not exist (build the SSLRuntime target or pass --runtime=<file>).");
+    }
+
+    HostABI abi = hostABI();
+    std::string gccDirectory = findGCCDirectory(abi);
+    std::vector<std::string> libraryDirectories = { "/usr/lib/" + abi.multiarch, "/lib/" + abi.multiarch, "/usr/lib64", "/lib64", "/usr/lib", "/lib" };
+    std::string crtDirectory = findIn(libraryDirectories, "crti.o");
+    if (gccDirectory.empty() || crtDirectory.empty()) {
+        throw std::runtime_error("Cannot link " + outputFilename + ": no C runtime start files (crti.o, crtbeginS.o) found; install the C and C++ development packages.");
+    }
+    auto crt = [&crtDirectory](const char* file) { return (std::filesystem::path(crtDirectory) / file).string(); };
+    auto gcc = [&gccDirectory](const char* file) { return (std::filesystem::path(gccDirectory) / file).string(); };
+
+    // The same inputs and order clang++ gives ld for an executable or -shared library
+    std::vector<std::string> arguments = { "ld.lld", "-m", abi.emulation, "--eh-frame-hdr", "-o", outputFilename };
+    if (options.shared) {
+        arguments.insert(arguments.end(), { "-shared", crt("crti.o"), gcc("crtbeginS.o") });
+    }
+    else if (options.pie) {
+        arguments.insert(arguments.end(), { "-pie", "-dynamic-linker", abi.dynamicLinker, crt("Scrt1.o"), crt("crti.o"), gcc("crtbeginS.o") });
+    }
+    else {
+        arguments.insert(arguments.end(), { "-dynamic-linker", abi.dynamicLinker, crt("crt1.o"), crt("crti.o"), gcc("crtbegin.o") });
+    }
+    arguments.push_back("-L" + gccDirectory);
+    for (const std::string& directory : libraryDirectories) {
+        if (std::filesystem::is_directory(directory)) {
+            arguments.push_back("-L" + directory);
+        }
+    }
+    arguments.insert(arguments.end(), { "--gc-sections", "--icf=all" });
+    arguments.insert(arguments.end(), objectFiles.begin(), objectFiles.end());
+    arguments.push_back(options.runtimeLibrary);
+    // The runtime is C++ and runs loop parallel on pthreads
+    arguments.insert(arguments.end(), { "-lstdc++", "-lm", "-lgcc_s", "-lgcc", "-lpthread", "-lc", "-lgcc_s", "-lgcc" });
+    arguments.insert(arguments.end(), { options.shared || options.pie ? gcc("crtendS.o") : gcc("crtend.o"), crt("crtn.o") });
+
+    std::vector<const char*> argv;
+    for (const std::string& argument : arguments) {
+        argv.push_back(argument.c_str());
+    }
+
+    std::filesystem::path outputPath = outputFilename;
+    if (outputPath.has_parent_path()) {
+        std::filesystem::create_directories(outputPath.parent_path());
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    lld::Result result = lld::lldMain(argv, llvm::outs(), llvm::errs(), { { lld::Gnu, &lld::elf::link } });
+    canRunAgain = result.canRunAgain;
+    if (result.retCode != 0) {
+        throw std::runtime_error("lld failed to link " + outputFilename + " (exit code " + std::to_string(result.retCode) + ")");
+    }
+
+    std::cout << "Linked " << (options.shared ? "shared library " : "executable ") << outputFilename << " from " << objectFiles.size() << " object file(s) in "
+        << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count() << " ms" << std::endl;
+}
@@ -0,0 +1,151 @@
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Utils/SplitModule.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+#include "generateMachineCode/genObjFile.h"
+#include "generateMachineCode/ParallelCodeGen.h"
+
+std::vector<std::string> ParallelCodeGen::generateObjectFiles(llvm::Module* module, const OptimizationOptions& options, unsigned jobs,
+    const std::string& irFilename, const std::string& objFilename, llvm::CodeGenOptLevel optLevel, const CodeGenTarget& target) {
+
+    std::vector<std::string> objects;
+    if (!module) {
+        std::cerr << "Module is null, cannot generate object files\n";
+        return objects;
+    }
+    // Target machines are not thread safe: this one is for the whole module, each thread creates its own
+    std::unique_ptr<llvm::TargetMachine> targetMachine = GenerateOBJ::createTargetMachine(optLevel, target);
+    if (!targetMachine) {
+        return objects;
+    }
+    GenerateOBJ::setTarget(module, *targetMachine);
+
+    auto start = std::chrono::steady_clock::now();
+
+    // A custom pipeline, or O0's, can't be cut in two, so only the code generator runs in parallel then
+    bool splitPipeline = options.passes.empty() && options.level != llvm::OptimizationLevel::O0;
+    OptimizationOptions wholeModule = options;
+    wholeModule.targetMachine = targetMachine.get();
+    if (splitPipeline) {
+        wholeModule.part = OptimizationOptions::PipelinePart::Simplification;
+    }
+    LLVMOptimizer::optimize(module, wholeModule);
+
+    // Profile instrumentation and use belong to the simplification pipeline, which has already run
+    OptimizationOptions partitionOptions;
+    partitionOptions.level = options.level;
+    partitionOptions.part = OptimizationOptions::PipelinePart::Optimization;
+    partitionOptions.report = options.report;
+    partitionOptions.remarks = options.remarks;
+    partitionOptions.adaptive = options.adaptive;
+
+    // No more partitions than functions to put in them
+    unsigned definitions = 0;
+    for (const llvm::Function& function : *module) {
+        definitions += !function.isDeclaration();
+    }
+    // Partitions only share a context with the module, so each one is moved to its own as bitcode;
+    // internal functions and globals get unique external names so calls between partitions still link
+    std::vector<llvm::SmallVector<char, 0>> partitions;
+    llvm::SplitModule(*module, std::max(1u, std::min(jobs, definitions)), [&partitions](std::unique_ptr<llvm::Module> partition) {
+        partitions.emplace_back();
+        llvm::raw_svector_ostream stream(partitions.back());
+        llvm::WriteBitcodeToFile(*partition, stream);
+    }, false);
+
+    auto splitEnd = std::chrono::steady_clock::now();
+    std::cout << "Split module into " << partitions.size() << " partitions in "
+        << std::chrono::duration_cast<std::chrono::milliseconds>(splitEnd - start).count() << " ms" << std::endl;
+
+    objects.resize(partitions.size());
+    for (unsigned i = 0; i < partitions.size(); ++i) {
+        objects[i] = partitionFilename(objFilename, i);
+    }
+    std::vector<std::string> errors(partitions.size());
+    auto compilePartition = [&](unsigned i) {
+        try {
+            auto partitionStart = std::chrono::steady_clock::now();
+            llvm::LLVMContext context;
+            llvm::MemoryBufferRef bitcode(llvm::StringRef(partitions[i].data(), partitions[i].size()), objects[i]);
+            auto partitionOrError = llvm::parseBitcodeFile(bitcode, context);
+            if (!partitionOrError) {
+                errors[i] = llvm::toString(partitionOrError.takeError());
+                return;
+            }
+            std::unique_ptr<llvm::Module> partition = std::move(*partitionOrError);
+
+            // The partition kept the module's triple, data layout and function attributes
+            std::unique_ptr<llvm::TargetMachine> partitionTarget = GenerateOBJ::createTargetMachine(optLevel, target);
+            if (!partitionTarget) {
+                errors[i] = "Could not create a target machine for " + target.cpuName();
+                return;
+            }
+            if (splitPipeline) {
+                OptimizationOptions threadOptions = partitionOptions;
+                threadOptions.targetMachine = partitionTarget.get();
+                LLVMOptimizer::optimize(partition.get(), threadOptions);
+            }
+
+            std::string partitionIR = partitionFilename(irFilename, i);
+            std::error_code EC;
+            llvm::raw_fd_ostream dest(partitionIR, EC);
+            if (EC) {
+                errors[i] = "Could not open file: " + EC.message() + ", for writing LLVM IR to " + partitionIR;
+                return;
+            }
+            partition->print(dest, nullptr);
+
+            GenerateOBJ::emitObjectFile(partition.get(), objects[i], *partitionTarget);
+            std::cout << "Partition " << i << " took " << std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - partitionStart).count() << " ms" << std::endl;
+        }
+        catch (const std::exception& e) {
+            errors[i] = e.what();
+        }
+    };
+
+    // One thread per core at most; each takes the next partition nobody has started yet
+    unsigned threadCount = std::min<unsigned>(partitions.size(), std::max(1u, std::thread::hardware_concurrency()));
+    std::atomic<unsigned> nextPartition{ 0 };
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&] {
+            for (unsigned i = nextPartition++; i < partitions.size(); i = nextPartition++) {
+                compilePartition(i);
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    for (unsigned i = 0; i < errors.size(); ++i) {
+        if (!errors[i].empty()) {
+            throw std::runtime_error("Partition " + std::to_string(i) + " failed: " + errors[i]);
+        }
+    }
+
+    std::cout << "Compiled " << partitions.size() << " partitions on " << threads.size() << " threads in "
+        << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count() << " ms" << std::endl;
+    return objects;
+}
+
+std::string ParallelCodeGen::partitionFilename(const std::string& filename, unsigned partition) {
+    std::filesystem::path path = filename;
+    std::string extension = path.extension().string();
+    path.replace_extension("." + std::to_string(partition) + extension);
+    return path.string();
+}
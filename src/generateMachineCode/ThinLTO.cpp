@@ -0,0 +1,137 @@
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/IR/GlobalValue.h"
+#include "llvm/LTO/Config.h"
+#include "llvm/LTO/LTO.h"
+#include "llvm/Support/CachePruning.h"
+#include "llvm/Support/Caching.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/TargetParser/Host.h"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <set>
+#include <stdexcept>
+
+#include "generateMachineCode/genObjFile.h"
+#include "generateMachineCode/ThinLTO.h"
+
+void ThinLTO::link(const std::vector<std::string>& bitcodeFiles, const std::vector<std::string>& objectFiles,
+    const llvm::OptimizationLevel& level, llvm::CodeGenOptLevel optLevel, const CodeGenTarget& target, unsigned jobs, const std::string& cacheDir, bool shared) {
+
+    GenerateOBJ::initializeTargets();
+    auto start = std::chrono::steady_clock::now();
+
+    // Same target and code generator settings as GenerateOBJ::generateObjectFile
+    llvm::lto::Config config;
+    config.CPU = target.cpuName();
+    llvm::SmallVector<llvm::StringRef, 64> features;
+    std::string featureString = target.featureString();
+    llvm::StringRef(featureString).split(features, ',', -1, false);
+    for (llvm::StringRef feature : features) {
+        config.MAttrs.push_back(feature.str());
+    }
+    config.RelocModel = target.relocationModel;
+    config.CodeModel = target.codeModel;
+    config.OptLevel = level.getSpeedupLevel();
+    config.CGOptLevel = optLevel;
+    config.DefaultTriple = llvm::sys::getDefaultTargetTriple();
+
+    llvm::lto::LTO lto(std::move(config), llvm::lto::createInProcessThinBackend(llvm::heavyweight_hardware_concurrency(jobs)));
+
+    std::vector<std::unique_ptr<llvm::MemoryBuffer>> buffers; // The inputs refer to them until the link is done
+    std::set<std::string> defined;
+    for (const std::string& file : bitcodeFiles) {
+        auto bufferOrError = llvm::MemoryBuffer::getFile(file);
+        if (!bufferOrError) {
+            throw std::runtime_error("Could not read " + file + ": " + bufferOrError.getError().message());
+        }
+        buffers.push_back(std::move(*bufferOrError));
+
+        auto inputOrError = llvm::lto::InputFile::create(buffers.back()->getMemBufferRef());
+        if (!inputOrError) {
+            throw std::runtime_error("Could not read " + file + ": " + llvm::toString(inputOrError.takeError()));
+        }
+        std::unique_ptr<llvm::lto::InputFile> input = std::move(*inputOrError);
+
+        // What a linker would decide for each symbol: the program's own definitions win. An executable is
+        // only entered through main (by the C runtime), so every other symbol may be internalized; a shared
+        // library exports every symbol that isn't hidden, and those may be preempted by another definition
+        std::vector<llvm::lto::SymbolResolution> resolutions;
+        for (const llvm::lto::InputFile::Symbol& symbol : input->symbols()) {
+            llvm::lto::SymbolResolution resolution;
+            bool exported = shared && symbol.getVisibility() != llvm::GlobalValue::HiddenVisibility;
+            if (!symbol.isUndefined()) {
+                if (!defined.insert(symbol.getName().str()).second) {
+                    throw std::runtime_error("Duplicate symbol '" + symbol.getName().str() + "' in " + file);
+                }
+                resolution.Prevailing = true;
+                resolution.FinalDefinitionInLinkageUnit = !exported;
+            }
+            resolution.VisibleToRegularObj = exported || symbol.getName() == "main";
+            resolution.ExportDynamic = exported;
+            resolutions.push_back(resolution);
+        }
+        if (llvm::Error error = lto.add(std::move(input), resolutions)) {
+            throw std::runtime_error("Could not add " + file + " to the ThinLTO link: " + llvm::toString(std::move(error)));
+        }
+    }
+
+    // Task 0 is the full LTO partition, which stays empty; the module of bitcodeFiles[i] is task i + 1
+    unsigned tasks = lto.getMaxTasks();
+    std::vector<llvm::SmallString<0>> objects(tasks);
+    std::vector<std::unique_ptr<llvm::MemoryBuffer>> cachedObjects(tasks);
+    auto addStream = [&objects](size_t task, const llvm::Twine&) -> llvm::Expected<std::unique_ptr<llvm::CachedFileStream>> {
+        return std::make_unique<llvm::CachedFileStream>(std::make_unique<llvm::raw_svector_ostream>(objects[task]));
+    };
+
+    // Keyed on a module's hash, its imports and exports, the symbol resolutions and the configuration
+    llvm::FileCache cache;
+    std::atomic<unsigned> cacheHits{ 0 };
+    if (!cacheDir.empty()) {
+        auto cacheOrError = llvm::localCache("ThinLTO", "Thin", cacheDir,
+            [&cachedObjects](size_t task, const llvm::Twine&, std::unique_ptr<llvm::MemoryBuffer> object) {
+                cachedObjects[task] = std::move(object);
+            });
+        if (!cacheOrError) {
+            throw std::runtime_error("Could not open the ThinLTO cache " + cacheDir + ": " + llvm::toString(cacheOrError.takeError()));
+        }
+        cache = [localCache = std::move(*cacheOrError), &cacheHits](unsigned task, llvm::StringRef key, const llvm::Twine& moduleName) -> llvm::Expected<llvm::AddStreamFn> {
+            auto addStreamOrError = localCache(task, key, moduleName);
+            // No stream to write to: the object was found and handed to the callback above
+            if (addStreamOrError && !*addStreamOrError) {
+                ++cacheHits;
+            }
+            return addStreamOrError;
+        };
+    }
+
+    if (llvm::Error error = lto.run(addStream, cache)) {
+        throw std::runtime_error("ThinLTO failed: " + llvm::toString(std::move(error)));
+    }
+
+    for (std::size_t i = 0; i < objectFiles.size(); ++i) {
+        std::size_t task = i + 1;
+        llvm::StringRef object = cachedObjects[task] ? cachedObjects[task]->getBuffer() : llvm::StringRef(objects[task]);
+        std::error_code EC;
+        llvm::raw_fd_ostream dest(objectFiles[i], EC, llvm::sys::fs::OF_None);
+        if (EC) {
+            throw std::runtime_error("Could not open file: " + EC.message() + ", for writing the object file " + objectFiles[i]);
+        }
+        dest << object;
+        std::cout << "Object file generated: " << objectFiles[i] << std::endl;
+    }
+
+    if (!cacheDir.empty()) {
+        llvm::pruneCache(cacheDir, llvm::CachePruningPolicy());
+    }
+
+    std::cout << "ThinLTO compiled " << bitcodeFiles.size() << " modules in "
+        << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count() << " ms, "
+        << cacheHits << " from the cache and " << bitcodeFiles.size() - cacheHits << " rebuilt" << std::endl;
+}
@@ -3,46 +3,135 @@
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Target/TargetOptions.h"
 #include "llvm/TargetParser/Host.h"
+#include "llvm/TargetParser/Triple.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Module.h"
 #include "llvm/CodeGen/TargetLoweringObjectFileImpl.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/MC/TargetRegistry.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/Analysis/ModuleSummaryAnalysis.h"
+#include "llvm/Analysis/ProfileSummaryInfo.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/MC/MCSubtargetInfo.h"
 
+#include <algorithm>
 #include <iostream>
 #include <filesystem>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include "generateMachineCode/genObjFile.h"
 
-void GenerateOBJ::generateObjectFile(llvm::Module* module, const std::string& outputFilename) {
-	
-    if (!module) {
-        std::cerr << "Module is null, cannot generate object file\n";
-        return;
+std::string CodeGenTarget::cpuName() const {
+    return cpu == "native" ? llvm::sys::getHostCPUName().str() : cpu;
+}
+
+std::string CodeGenTarget::featureString() const {
+    std::vector<std::string> enabled;
+    llvm::StringMap<bool> hostFeatures;
+    if (cpu == "native" && llvm::sys::getHostCPUFeatures(hostFeatures)) {
+        for (const auto& feature : hostFeatures) {
+            enabled.push_back((feature.getValue() ? "+" : "-") + feature.getKey().str());
+        }
+        // StringMap has no order, and the string ends up in function attributes and the ThinLTO cache key
+        std::sort(enabled.begin(), enabled.end());
+    }
+    if (!features.empty()) {
+        enabled.push_back(features);
     }
-    
-    llvm::InitializeAllTargets();
-    llvm::InitializeAllTargetMCs();
-    llvm::InitializeAllAsmPrinters();
-    LLVMInitializeX86TargetInfo();
-    LLVMInitializeX86Target();
-    LLVMInitializeX86TargetMC();
-    LLVMInitializeX86AsmPrinter();
 
-    std::cout << "Initialized targets" << std::endl;
+    std::string joined;
+    for (const std::string& feature : enabled) {
+        joined += joined.empty() ? feature : "," + feature;
+    }
+    return joined;
+}
+
+void GenerateOBJ::initializeTargets() {
+    // Registering targets is not thread safe, and ParallelCodeGen emits partitions from several threads
+    static std::once_flag initialized;
+    std::call_once(initialized, [] {
+        // Object files are only ever built for the host
+        llvm::InitializeNativeTarget();
+        llvm::InitializeNativeTargetAsmPrinter();
+        llvm::InitializeNativeTargetAsmParser();
+
+        std::cout << "Initialized targets" << std::endl;
+    });
+}
+
+std::unique_ptr<llvm::TargetMachine> GenerateOBJ::createTargetMachine(llvm::CodeGenOptLevel optLevel, const CodeGenTarget& target) {
+    initializeTargets();
 
     auto TargetTriple = llvm::sys::getDefaultTargetTriple();
     std::string Error;
     auto Target = llvm::TargetRegistry::lookupTarget(TargetTriple, Error);
+    if (!Target) {
+        std::cerr << "Could not find target " << TargetTriple << ": " << Error << std::endl;
+        return nullptr;
+    }
+    // A short str keeps its length in the top byte of the length field, which is its last byte only on little-endian targets
+    if (!llvm::Triple(TargetTriple).isLittleEndian()) {
+        std::cerr << "SSL strs need a little-endian target, and " << TargetTriple << " is big-endian" << std::endl;
+        return nullptr;
+    }
 
     llvm::TargetOptions opt;
-    llvm::Reloc::Model RM = llvm::Reloc::Model::PIC_;
-    auto targetMachine = Target->createTargetMachine(TargetTriple, "generic", "", opt, RM);
+    std::string cpu = target.cpuName();
+    std::unique_ptr<llvm::TargetMachine> targetMachine(Target->createTargetMachine(TargetTriple, cpu, target.featureString(), opt, target.relocationModel, target.codeModel, optLevel));
+    // LLVM only warns about an unknown CPU and then builds for the generic one
+    if (targetMachine && !targetMachine->getMCSubtargetInfo()->isCPUStringValid(cpu)) {
+        std::cerr << "Unknown CPU " << cpu << " for " << TargetTriple << " (llc -mcpu=help lists them)" << std::endl;
+        return nullptr;
+    }
+    return targetMachine;
+}
+
+void GenerateOBJ::setTarget(llvm::Module* module, const llvm::TargetMachine& targetMachine) {
+    module->setDataLayout(targetMachine.createDataLayout());
+    module->setTargetTriple(targetMachine.getTargetTriple().str());
+
+    // The optimizer asks each function for its target: the attributes pick the subtarget whose vector
+    // registers and costs it plans with, and keep the choice in bitcode for the LTO link
+    llvm::StringRef cpu = targetMachine.getTargetCPU();
+    llvm::StringRef features = targetMachine.getTargetFeatureString();
+    for (llvm::Function& function : *module) {
+        if (function.isDeclaration()) {
+            continue;
+        }
+        function.addFnAttr("target-cpu", cpu);
+        if (features.empty()) {
+            function.removeFnAttr("target-features");
+        }
+        else {
+            function.addFnAttr("target-features", features);
+        }
+    }
+}
+
+void GenerateOBJ::generateObjectFile(llvm::Module* module, const std::string& outputFilename, llvm::CodeGenOptLevel optLevel, const CodeGenTarget& target) {
+	
+    if (!module) {
+        std::cerr << "Module is null, cannot generate object file\n";
+        return;
+    }
+    
+    std::unique_ptr<llvm::TargetMachine> targetMachine = createTargetMachine(optLevel, target);
+    if (!targetMachine) {
+        return;
+    }
+    emitObjectFile(module, outputFilename, *targetMachine);
+}
 
-    module->setDataLayout(targetMachine->createDataLayout());
-    module->setTargetTriple(TargetTriple);
+void GenerateOBJ::emitObjectFile(llvm::Module* module, const std::string& outputFilename, llvm::TargetMachine& targetMachine) {
+    if (!module) {
+        std::cerr << "Module is null, cannot generate object file\n";
+        return;
+    }
+    setTarget(module, targetMachine);
 
     std::filesystem::path objPath = outputFilename;
     objPath.replace_extension(".o");
@@ -51,7 +140,7 @@ void GenerateOBJ::generateObjectFile(llvm::Module* module, const std::string& ou
 
     llvm::legacy::PassManager pass;
     auto fileType = llvm::CodeGenFileType::ObjectFile;
-    if (targetMachine->addPassesToEmitFile(pass, dest, nullptr, fileType)) {
+    if (targetMachine.addPassesToEmitFile(pass, dest, nullptr, fileType)) {
         llvm::errs() << "TheTargetMachine can't emit a file of this type";
         return;
     }
@@ -59,4 +148,61 @@ void GenerateOBJ::generateObjectFile(llvm::Module* module, const std::string& ou
     pass.run(*module);
     dest.flush();
     std::cout << "Object file generated: " << objPath << std::endl;
-}
\ No newline at end of file
+}
+
+void GenerateOBJ::generateBitcodeFile(llvm::Module* module, const std::string& outputFilename, bool withSummary, const CodeGenTarget& target) {
+    if (!module) {
+        std::cerr << "Module is null, cannot generate bitcode file\n";
+        return;
+    }
+
+    std::unique_ptr<llvm::TargetMachine> targetMachine = createTargetMachine(llvm::CodeGenOptLevel::Default, target);
+    if (!targetMachine) {
+        return;
+    }
+    writeBitcodeFile(module, outputFilename, *targetMachine, withSummary);
+}
+
+void GenerateOBJ::writeBitcodeFile(llvm::Module* module, const std::string& outputFilename, const llvm::TargetMachine& targetMachine, bool withSummary) {
+    if (!module) {
+        std::cerr << "Module is null, cannot generate bitcode file\n";
+        return;
+    }
+
+    // The link step reads the target from the module
+    setTarget(module, targetMachine);
+
+    std::filesystem::path bitcodePath = outputFilename;
+    bitcodePath.replace_extension(".bc");
+    std::error_code EC;
+    llvm::raw_fd_ostream dest(bitcodePath.string(), EC, llvm::sys::fs::OF_None);
+    if (EC) {
+        std::cerr << "Could not open file: " << EC.message() << ", for writing bitcode to " << bitcodePath << std::endl;
+        return;
+    }
+
+    if (withSummary) {
+        llvm::ProfileSummaryInfo profileSummary(*module);
+        llvm::ModuleSummaryIndex summary = llvm::buildModuleSummaryIndex(*module, nullptr, &profileSummary);
+        llvm::WriteBitcodeToFile(*module, dest, false, &summary, true);
+    }
+    else {
+        llvm::WriteBitcodeToFile(*module, dest);
+    }
+    dest.flush();
+    std::cout << "Bitcode file generated: " << bitcodePath << std::endl;
+}
+
+std::optional<llvm::Reloc::Model> GenerateOBJ::parseRelocationModel(const std::string& name) {
+    if (name == "static") return llvm::Reloc::Static;
+    if (name == "pic") return llvm::Reloc::PIC_;
+    return std::nullopt;
+}
+
+std::optional<llvm::CodeModel::Model> GenerateOBJ::parseCodeModel(const std::string& name) {
+    if (name == "small") return llvm::CodeModel::Small;
+    if (name == "medium") return llvm::CodeModel::Medium;
+    if (name == "large") return llvm::CodeModel::Large;
+    if (name == "kernel") return llvm::CodeModel::Kernel;
+    return std::nullopt;
+}
@@ -35,9 +35,34 @@ void Token::lexeme(std::string_view lexeme) noexcept {
     m_lexeme = std::move(lexeme);
 }
 
+unsigned Token::line() const noexcept { return m_line; }
+
+unsigned Token::column() const noexcept { return m_column; }
+
+void Token::location(unsigned line, unsigned column) noexcept {
+    m_line = line;
+    m_column = column;
+}
+
 Token Lexer::atom(Token::Kind kind) noexcept { return Token(kind, m_beg++, 1); }
 
 Token Lexer::next() noexcept {
+  Token token = scan();
+  const char* start = token.lexeme().data();
+  if (start == nullptr || start < m_line_scan) {
+    return token;
+  }
+  for (; m_line_scan < start; ++m_line_scan) {
+    if (*m_line_scan == '\n') {
+      ++m_line;
+      m_line_begin = m_line_scan + 1;
+    }
+  }
+  token.location(m_line, static_cast<unsigned>(start - m_line_begin) + 1);
+  return token;
+}
+
+Token Lexer::scan() noexcept {
   while (is_space(peek())) get();
 
   const char* token_start = m_beg;
@@ -116,6 +141,8 @@ Token Lexer::next() noexcept {
       return string_literal();
     case '|':
       return atom(Token::Kind::Pipe);
+    case '@':
+      return atom(Token::Kind::At);
     default:
       if (is_identifier_char(peek())) {
             return identifier();
@@ -136,7 +163,7 @@ Token Lexer::next() noexcept {
 
 Token Lexer::identifier() noexcept {
    const char* start = m_beg;
-    while (is_identifier_char(peek())) get();
+    while (is_identifier_char(peek()) || is_digit(peek())) get(); // digits may follow the first character, as in i64
     
     // Example keyword checking, needs to be expanded based on actual language keywords
     std::string_view text(start, std::distance(start, m_beg));
@@ -148,6 +175,14 @@ Token Lexer::identifier() noexcept {
         {"loop", Token::Kind::Loop},
         {"int", Token::Kind::Int},
         {"flt", Token::Kind::Float},
+        {"i8", Token::Kind::I8},
+        {"i16", Token::Kind::I16},
+        {"i64", Token::Kind::I64},
+        {"dbl", Token::Kind::Double},
+        {"vec4f", Token::Kind::Vec4f},
+        {"vec8f", Token::Kind::Vec8f},
+        {"vec4i", Token::Kind::Vec4i},
+        {"vec8i", Token::Kind::Vec8i},
         {"str", Token::Kind::String},
         {"bool", Token::Kind::Bool},
         {"log", Token::Kind::Log},
@@ -163,7 +198,11 @@ Token Lexer::identifier() noexcept {
         {"call", Token::Kind::Call},
         {"true", Token::Kind::True},
         {"false", Token::Kind::False},
-		{"ARRAY", Token::Kind::Array}
+		{"ARRAY", Token::Kind::Array},
+        {"as", Token::Kind::As},
+        {"parallel", Token::Kind::Parallel},
+        {"reduce", Token::Kind::Reduce},
+        {"arena", Token::Kind::Arena}
     };
 
     auto keyword = keywords.find(text);
@@ -200,7 +239,7 @@ Token Lexer::slash_or_comment() noexcept {
         while (peek() != '\0' && peek() != '\n') {
           get(); // Consume all characters until the end of line or end of file
         }
-        return next(); // Recursively call next() to get the next valid token after the comment
+        return scan(); // Recursively call scan() to get the next valid token after the comment
     } 
     
     else {
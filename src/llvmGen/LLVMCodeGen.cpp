@@ -4,6 +4,15 @@
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/IR/Type.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/IR/MDBuilder.h"
+#include "llvm/BinaryFormat/Dwarf.h"
+#include "runtime/SSLRuntime.h"
+
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
+#include <limits>
+#include <optional>
 
 LLVMCodeGen::LLVMCodeGen()
 	: module(new llvm::Module("MyModule", context)), builder(context) {
@@ -18,10 +27,39 @@ llvm::Module* LLVMCodeGen::getModule() const {
 	return module;
 }
 
- llvm::Value* LLVMCodeGen::evaluateExpression(Expression* expr) {
+void LLVMCodeGen::enableDebugInfo(const std::string& sourcePath) {
+	std::filesystem::path path = std::filesystem::absolute(sourcePath);
+	debugBuilder = std::make_unique<llvm::DIBuilder>(*module);
+	debugFile = debugBuilder->createFile(path.filename().string(), path.parent_path().string());
+	// DWARF has no language code for SSL; C is the closest one debuggers and profilers understand
+	debugUnit = debugBuilder->createCompileUnit(llvm::dwarf::DW_LANG_C, debugFile, "SSLang", false, "", 0);
+	module->addModuleFlag(llvm::Module::Warning, "Debug Info Version", llvm::DEBUG_METADATA_VERSION);
+	module->addModuleFlag(llvm::Module::Warning, "Dwarf Version", 5);
+}
+
+void LLVMCodeGen::enableFunctionInstrumentation() {
+	instrumentFunctions = true;
+}
+
+void LLVMCodeGen::declareExternalFunction(const FunctionDefinition* funcDef) {
+	declareFunction(funcDef);
+}
+
+void LLVMCodeGen::setLibraryModule() {
+	libraryModule = true;
+}
+
+ const EscapeAnalysis& LLVMCodeGen::getEscapeAnalysis() const {
+	 return escapeAnalysis;
+ }
+
+ llvm::Value* LLVMCodeGen::evaluateExpression(Expression* expr, llvm::Type* literalType) {
 	 std::cout << "Beginning of evaluateExpression()\n";
 	 // This function should visit the expression and return an llvm::Value* representing its value.
+	 llvm::Type* enclosingLiteralType = this->literalType;
+	 this->literalType = literalType;
 	 expr->accept(this);
+	 this->literalType = enclosingLiteralType;
 	 std::cout << "After accepting the expression\n";
 	 if (!lastValue) {
 		 std::cerr << "Error evaluating expression.\n";
@@ -59,12 +97,6 @@ llvm::Module* LLVMCodeGen::getModule() const {
 			 std::cerr << "Expected a GlobalVariable for global variable: " << expr->name << std::endl;
 			 return;
 		 }
-		 // Check if the global variable is a string (i.e., an array of i8)
-		 if (globalVar->getValueType()->isArrayTy() && globalVar->getValueType()->getArrayElementType()->isIntegerTy(8)) {
-			 lastValue = globalVar;
-			 std::cout << "Using global string variable directly: " << expr->name << std::endl;
-			 return;
-		 }
 		 type = globalVar->getValueType();
 	 }
 	 else {
@@ -109,10 +141,29 @@ llvm::Module* LLVMCodeGen::getModule() const {
 
 	 // Set insertion point to the start of 'main' by default, or to a specific place as needed
 	 builder.SetInsertPoint(&mainFunction->getEntryBlock());
+
+	 // main runs the top-level calls; until one sets its own line, code is attributed to no particular line
+	 if (debugBuilder) {
+		 llvm::DISubprogram* subprogram = mainFunction->getSubprogram();
+		 if (!subprogram) {
+			 subprogram = createDebugFunction(mainFunction, "main", { 1, 1 });
+		 }
+		 builder.SetCurrentDebugLocation(llvm::DILocation::get(context, 0, 0, subprogram));
+	 }
  }
 
  void LLVMCodeGen::visit(const Program* program) {
 
+	// Decides which local arrays and strs are given stack buffers before their functions are emitted
+	escapeAnalysis.visit(program);
+
+	// Declare every prototype before emitting any code, so calls resolve regardless of definition order
+	for (const auto& func : program->functions) {
+		if (const FunctionDefinition* funcDef = func->getDefinition()) {
+			declareFunction(funcDef);
+		}
+	}
+
 	for (const auto& decl : program->declarations) {
 		decl->accept(this);
 	}
@@ -128,30 +179,45 @@ llvm::Module* LLVMCodeGen::getModule() const {
 		func->accept(this);
 	}
 
-	ensureMainFunctionExist();
+	// Another module of the program has main
+	if (!libraryModule) {
+		ensureMainFunctionExist();
 
-	// Complete the 'main' function with a return statement. Return 0 as a conventional success code.
-	builder.CreateRet(llvm::ConstantInt::get(context, llvm::APInt(32, 0)));
+		// Global arrays live until the program ends
+		emitArrayCleanup(globalArrays, 0);
 
-	std::cout << "Finished creating return statement for main function\n";
+		// Complete the 'main' function with a return statement. Return 0 as a conventional success code.
+		builder.CreateRet(llvm::ConstantInt::get(context, llvm::APInt(32, 0)));
+
+		std::cout << "Finished creating return statement for main function\n";
+	}
 
 	// Reset the builder's insertion point to avoid dangling references
 	builder.ClearInsertionPoint();
+	builder.SetCurrentDebugLocation(llvm::DebugLoc());
+
+	if (debugBuilder) {
+		debugBuilder->finalize();
+	}
 
     std::cout << "Finished visiting program\n";
 
 	currentLocals.clear();
 	globals.clear();
+	globalArrays.clear();
 	 
  }
 
  void LLVMCodeGen::visit(const IntDeclaration* decl) {
-	 llvm::Constant* initVal = llvm::ConstantInt::get(context, llvm::APInt(32, std::stoi(decl->number), true));
+	 llvm::Type* type = getLLVMType(decl->type);
+	 std::int64_t value = 0;
+	 std::from_chars(decl->number.data(), decl->number.data() + decl->number.size(), value);
+	 llvm::Constant* initVal = llvm::ConstantInt::get(type, value, true);
 	 
 	 if (currentFunction) { //need testing
 		 // Handle as local variable
 		 llvm::IRBuilder<> tmpBuilder(&currentFunction->getEntryBlock(), currentFunction->getEntryBlock().begin());
-		 llvm::AllocaInst* alloca = tmpBuilder.CreateAlloca(llvm::Type::getInt32Ty(context), 0, decl->name);
+		 llvm::AllocaInst* alloca = tmpBuilder.CreateAlloca(type, 0, decl->name);
 		 builder.CreateStore(initVal, alloca);
 
 		 // Remember the variable for later use within the function
@@ -162,7 +228,7 @@ llvm::Module* LLVMCodeGen::getModule() const {
 		 // Create a global variable in the module.
 		 llvm::GlobalVariable* gVar = new llvm::GlobalVariable(
 			 *module,
-			 llvm::Type::getInt32Ty(context), // Assuming 32-bit integers
+			 type,                            // i8, i16, i32 or i64
 			 false,                           // isConstant: false since it's a variable
 			 llvm::GlobalValue::ExternalLinkage,
 			 initVal,                         // Initializer
@@ -170,19 +236,23 @@ llvm::Module* LLVMCodeGen::getModule() const {
 		 );
 
 		 // Optionally, set alignment
-		 gVar->setAlignment(llvm::MaybeAlign(4));
+		 gVar->setAlignment(llvm::MaybeAlign(type->getPrimitiveSizeInBits() / 8));
 		 globals[decl->name] = gVar;
+		 declareDebugGlobal(gVar, decl->name, decl->location);
 	 }
  }
 
  void LLVMCodeGen::visit(const FloatDeclaration* decl) {
 	 
-	 llvm::ConstantFP* initVal = llvm::ConstantFP::get(context, llvm::APFloat(std::stof(decl->number)));
+	 llvm::Type* type = getLLVMType(decl->type);
+	 double value = 0.0;
+	 std::from_chars(decl->number.data(), decl->number.data() + decl->number.size(), value);
+	 llvm::Constant* initVal = llvm::ConstantFP::get(type, value); // a dbl keeps the digits a flt would round away
 
 	 if (currentFunction) {
 		 // Handle as local variable
 		 llvm::IRBuilder<> tmpBuilder(&currentFunction->getEntryBlock(), currentFunction->getEntryBlock().begin());
-		 llvm::AllocaInst* alloca = tmpBuilder.CreateAlloca(llvm::Type::getFloatTy(context), nullptr, decl->name);
+		 llvm::AllocaInst* alloca = tmpBuilder.CreateAlloca(type, nullptr, decl->name);
 		 builder.CreateStore(initVal, alloca);
 
 		 // Remember the variable for later use within the function
@@ -193,7 +263,7 @@ llvm::Module* LLVMCodeGen::getModule() const {
 		 // Handle as global variable
 		 llvm::GlobalVariable* gVar = new llvm::GlobalVariable(
 			 *module,
-			 llvm::Type::getFloatTy(context), // Assuming 32-bit integers
+			 type,                            // float or double
 			 false,                           // isConstant: false since it's a variable
 			 llvm::GlobalValue::ExternalLinkage,
 			 initVal,                         // Initializer
@@ -201,42 +271,40 @@ llvm::Module* LLVMCodeGen::getModule() const {
 		 );
 
 		 // Optionally, set alignment
-		 gVar->setAlignment(llvm::MaybeAlign(4));
+		 gVar->setAlignment(llvm::MaybeAlign(type->getPrimitiveSizeInBits() / 8));
 
 		 globals[decl->name] = gVar;
+		 declareDebugGlobal(gVar, decl->name, decl->location);
 		 
 	 }
 
  }
 
  void LLVMCodeGen::visit(const StringDeclaration* decl) {
+	 llvm::Constant* strValue = getStringConstant(decl->value);
 	 if (currentFunction) {
-		 auto& context = builder.getContext();
-		 llvm::Type* charType = llvm::Type::getInt8Ty(context);
-		 auto strValue = builder.CreateGlobalStringPtr(decl->value, "globalStr");
-		 llvm::ArrayType* strType = llvm::ArrayType::get(charType, decl->value.size() + 1); // +1 for null terminator
-		 auto alloca = builder.CreateAlloca(strType, nullptr, decl->name);
+		 llvm::AllocaInst* alloca = llvm_util::createEntryBlockAlloca(currentFunction, decl->name, getStringType());
 		 builder.CreateStore(strValue, alloca);
 		 
 		 currentLocals[decl->name] = alloca;
+		 createStringBuffer(decl, decl->name);
 	 }
 
 	 else {
 		 std::cout << "String declared globally" << std::endl;
-		 auto& context = builder.getContext();
 
-
-		 llvm::Constant* strConstant = llvm::ConstantDataArray::getString(context, decl->value, true);
+		 // The variable holds the { data, length } value, so assigning a new string is a single store
 		 llvm::GlobalVariable* gVar = new llvm::GlobalVariable(
 			 *module,
-			 strConstant->getType(),
-			 true, // isConstant
-			 llvm::GlobalValue::PrivateLinkage,
-			 strConstant,
+			 getStringType(),
+			 false, // isConstant
+			 llvm::GlobalValue::ExternalLinkage,
+			 strValue,
 			 decl->name
 		 );
-		 gVar->setAlignment(llvm::MaybeAlign(1));		 
+		 gVar->setAlignment(llvm::MaybeAlign(8));
 		 globals[decl->name] = gVar;
+		 declareDebugGlobal(gVar, decl->name, decl->location);
 
 	 }
  }
@@ -269,17 +337,57 @@ llvm::Module* LLVMCodeGen::getModule() const {
 
 		 // Save the global variable in globals for later reference
 		 globals[decl->name] = gVar;
+		 declareDebugGlobal(gVar, decl->name, decl->location);
+	 }
+ }
+
+ void LLVMCodeGen::visit(const VectorDeclaration* decl) {
+	 auto* type = llvm::cast<llvm::FixedVectorType>(getLLVMType(decl->type));
+	 std::vector<llvm::Constant*> lanes;
+	 for (const auto& element : decl->elements) {
+		 auto* lane = llvm::dyn_cast_or_null<llvm::Constant>(evaluateExpression(element.get(), type->getElementType()));
+		 if (!lane) {
+			 std::cerr << "non-constant expression in vector initializer is not supported." << std::endl;
+			 return;
+		 }
+		 lanes.push_back(lane);
+	 }
+	 llvm::Constant* initVal = lanes.size() == 1 ? llvm::ConstantVector::getSplat(type->getElementCount(), lanes[0]) : llvm::ConstantVector::get(lanes);
+	 // Aligned to the whole vector so loads and stores of it are single aligned vector moves
+	 llvm::Align alignment(type->getPrimitiveSizeInBits() / 8);
+
+	 if (currentFunction) {
+		 llvm::IRBuilder<> tmpBuilder(&currentFunction->getEntryBlock(), currentFunction->getEntryBlock().begin());
+		 llvm::AllocaInst* alloca = tmpBuilder.CreateAlloca(type, nullptr, decl->name);
+		 alloca->setAlignment(alignment);
+		 builder.CreateAlignedStore(initVal, alloca, alignment);
+		 currentLocals[decl->name] = alloca;
+	 }
+	 else {
+		 llvm::GlobalVariable* gVar = new llvm::GlobalVariable(
+			 *module,
+			 type,                            // <4 x float>, <8 x i32>, ...
+			 false,                           // isConstant: false since it's a variable
+			 llvm::GlobalValue::ExternalLinkage,
+			 initVal,                         // Initializer
+			 decl->name                       // Variable name
+		 );
+		 gVar->setAlignment(alignment);
+		 globals[decl->name] = gVar;
+		 declareDebugGlobal(gVar, decl->name, decl->location);
 	 }
  }
 
  void LLVMCodeGen::visit(const ArrayDeclaration* decl) {
-	 llvm::Type* elementType = llvm::Type::getInt32Ty(context);  // assuming array of integers
+	 llvm::Type* elementType = getLLVMType(decl->elementType); // i8 arrays pack four times as many lanes per vector as int arrays; flt and dbl arrays hold floating point
+	 llvm::Type* ptrType = llvm::PointerType::getUnqual(llvm::Type::getInt8Ty(context));
+	 llvm::Type* sizeType = llvm::Type::getInt64Ty(context);
 	 std::vector<llvm::Constant*> initvalues;
 
 	 // evaluate each element expression to initialize the array
 	 for (const auto& expr : decl->elements) {
-		 llvm::Value* eval = evaluateExpression(expr.get());
-		 if (auto consteval = llvm::dyn_cast<llvm::ConstantInt>(eval)) {
+		 llvm::Value* eval = evaluateExpression(expr.get(), elementType);
+		 if (auto consteval = llvm::dyn_cast_or_null<llvm::Constant>(eval)) {
 			 initvalues.push_back(consteval);
 		 }
 		 else {
@@ -288,15 +396,43 @@ llvm::Module* LLVMCodeGen::getModule() const {
 		 }
 	 }
 
-	 llvm::ArrayType* arraytype = llvm::ArrayType::get(elementType, decl->elements.size());
-	 llvm::Constant* arrayinit = llvm::ConstantArray::get(arraytype, initvalues);
+	 // Arrays are { data, length, capacity, inline buffer }. The data pointer starts out at the inline
+	 // buffer, which holds at least arrayInlineCapacity elements (or the whole initializer if it is longer),
+	 // and only moves to the heap once add() outgrows it.
+	 std::uint64_t inlineCapacity = std::max<std::uint64_t>(arrayInlineCapacity, initvalues.size());
+	 // A local array escape analysis bounded gets room for everything it can hold, so it never grows
+	 const EscapeAnalysis::Allocation* allocation = currentFunction ? escapeAnalysis.find(decl, decl->name) : nullptr;
+	 bool bounded = allocation && allocation->onStack;
+	 if (bounded) {
+		 inlineCapacity = std::max<std::uint64_t>(inlineCapacity, *allocation->bound);
+	 }
+	 llvm::ArrayType* inlineType = llvm::ArrayType::get(elementType, inlineCapacity);
+	 initvalues.resize(inlineCapacity, llvm::Constant::getNullValue(elementType));
+	 llvm::Constant* inlineInit = llvm::ConstantArray::get(inlineType, initvalues);
+
+	 llvm::StructType* arraytype = llvm::StructType::get(context, { ptrType, sizeType, sizeType, inlineType });
+	 llvm::Constant* length = llvm::ConstantInt::get(sizeType, decl->elements.size());
+	 llvm::Constant* capacity = llvm::ConstantInt::get(sizeType, inlineCapacity);
 
 	 if (currentFunction) {
 		 std::cout << "current function" << std::endl;
 		 llvm::IRBuilder<> tmpbuilder(&currentFunction->getEntryBlock(), currentFunction->getEntryBlock().begin());
 		 llvm::AllocaInst* alloca = tmpbuilder.CreateAlloca(arraytype, nullptr, decl->name);
-		 builder.CreateStore(arrayinit, alloca);
+		 llvm::Value* inlineBuffer = builder.CreateStructGEP(arraytype, alloca, 3, "inlineBuf");
+		 builder.CreateStore(inlineInit, inlineBuffer);
+		 builder.CreateStore(inlineBuffer, builder.CreateStructGEP(arraytype, alloca, 0, "dataPtr"));
+		 builder.CreateStore(length, builder.CreateStructGEP(arraytype, alloca, 1, "lenPtr"));
+		 builder.CreateStore(capacity, builder.CreateStructGEP(arraytype, alloca, 2, "capPtr"));
 		 currentLocals[decl->name] = alloca;
+		 if (bounded) {
+			 boundedArrays.insert(alloca); // nothing to free or release
+		 }
+		 else if (!arenas.empty()) {
+			 arenaArrays[alloca] = arenas.back(); // released with the arena block
+		 }
+		 else {
+			 functionArrays.push_back(alloca); // freed when it goes out of scope
+		 }
 	 }
 	 else {
 		 // global array
@@ -306,63 +442,393 @@ llvm::Module* LLVMCodeGen::getModule() const {
 			 arraytype,
 			 false, // isconstant: false since it's a variable
 			 llvm::GlobalValue::InternalLinkage,
-			 arrayinit, 
+			 nullptr, // initializer points into the global itself, set below
 			 decl->name 
 		 );
-		 gVar->setAlignment(llvm::MaybeAlign(4)); // alignment for 32-bit integers
+		 llvm::Constant* inlineBuffer = llvm::ConstantExpr::getInBoundsGetElementPtr(arraytype, gVar,
+			 llvm::ArrayRef<llvm::Constant*>{ llvm::ConstantInt::get(llvm::Type::getInt32Ty(context), 0), llvm::ConstantInt::get(llvm::Type::getInt32Ty(context), 3) });
+		 gVar->setInitializer(llvm::ConstantStruct::get(arraytype, { inlineBuffer, length, capacity, inlineInit }));
+		 gVar->setAlignment(llvm::MaybeAlign(8)); // alignment for the data pointer and length fields
 		 globals[decl->name] = gVar;
+		 globalArrays.push_back(gVar); // freed when main returns
 	 }
 }
 
  void LLVMCodeGen::visit(const ReturnStatement* stmt) {
 	 // First, evaluate the expression to get its value
-	 llvm::Value* returnValue = evaluateExpression(stmt->expression.get());
+	 llvm::Value* returnValue = evaluateExpression(stmt->expression.get(), currentFunction ? currentFunction->getReturnType() : nullptr);
 
 	 if (!returnValue) {
 		 std::cerr << "Error evaluating return expression." << std::endl;
 		 return;
 	 }
 
+	 // A musttail call has to be followed directly by the ret, so arrays are released (and the profiled
+	 // frame is left, as the callee replaces it) before the call
+	 auto* tailCall = llvm::dyn_cast<llvm::CallInst>(returnValue);
+	 if (tailCall && tailCall->isMustTailCall()) {
+		 builder.SetInsertPoint(tailCall);
+		 emitArrayCleanup(functionArrays, 0);
+		 emitArenaRelease(0);
+		 emitLocalStringArenaRelease();
+		 emitProfileExit();
+		 builder.SetInsertPoint(tailCall->getParent());
+	 }
+	 else {
+		 emitArrayCleanup(functionArrays, 0);
+		 emitArenaRelease(0);
+		 emitLocalStringArenaRelease();
+		 emitProfileExit();
+	 }
 	 builder.CreateRet(returnValue);
  }
 
 
 
  void LLVMCodeGen::visit(const ForLoopStatement* stmt) {
+	 // Bounds and step are evaluated once, before the loop, so the trip count is loop-invariant
+	 llvm::Value* startVal = evaluateExpression(stmt->start.get());
+	 llvm::Value* endVal = evaluateExpression(stmt->end.get());
+	 if (!startVal || !endVal) {
+		 std::cerr << "Error evaluating range bounds for loop." << std::endl;
+		 return;
+	 }
+	 unifyLiteralOperands(stmt->start.get(), startVal, stmt->end.get(), endVal); // range(0, n) counts in the type of n
+
+	 if (stmt->parallel) {
+		 emitParallelLoop(stmt, startVal, endVal);
+		 return;
+	 }
+
+	 llvm::ConstantInt* stepVal = llvm::ConstantInt::get(llvm::cast<llvm::IntegerType>(startVal->getType()), 1);
+	 if (stmt->step) {
+		 stepVal = llvm::dyn_cast_or_null<llvm::ConstantInt>(evaluateExpression(stmt->step.get(), startVal->getType()));
+		 if (!stepVal || stepVal->isZero()) {
+			 std::cerr << "Loop step must be a non-zero integer constant." << std::endl;
+			 return;
+		 }
+	 }
+
+	 emitCountedLoop(startVal, endVal, stepVal, stmt->iteratorName, stmt->body.get(), stmt->annotations);
+ }
+
+ void LLVMCodeGen::emitParallelLoop(const ForLoopStatement* stmt, llvm::Value* startVal, llvm::Value* endVal) {
+	 // The body is outlined into `void body(i32 lo, i32 hi, ptr ctx, i32 worker)` and handed to the runtime
+	 // thread pool. ctx is an array of pointers: first the locals of the enclosing function, which the body
+	 // copies in (it cannot write them), then one [max workers x T] slot array per reduction. A copied array
+	 // keeps pointing at the enclosing function's elements and is not freed by the body. Each worker
+	 // folds its chunk into its own slot and the slots are combined into the variables after the loop.
 	 llvm::Function* function = builder.GetInsertBlock()->getParent();
+	 llvm::Type* ptrType = llvm::PointerType::getUnqual(llvm::Type::getInt8Ty(context));
+	 llvm::Type* int32Type = llvm::Type::getInt32Ty(context);
+
+	 std::vector<std::pair<std::string, llvm::AllocaInst*>> captures;
+	 for (const auto& [name, value] : currentLocals) {
+		 auto* alloca = llvm::dyn_cast<llvm::AllocaInst>(value);
+		 bool reduced = std::any_of(stmt->reductions.begin(), stmt->reductions.end(), [&](const Reduction& r) { return r.variable == name; });
+		 if (alloca && alloca->getFunction() == function && !reduced) {
+			 captures.emplace_back(name, alloca);
+		 }
+	 }
+	 std::sort(captures.begin(), captures.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+	 struct ReductionSlots {
+		 const Reduction* reduction;
+		 llvm::Value* variable;
+		 llvm::Type* type;
+		 llvm::ArrayType* slotsType;
+	 };
+	 std::vector<ReductionSlots> reductions;
+	 for (const auto& reduction : stmt->reductions) {
+		 llvm::Value* variable = lookupVariable(reduction.variable);
+		 llvm::Type* type = getVariableType(variable);
+		 if (!type) {
+			 std::cerr << "Reduction variable " << reduction.variable << " not found." << std::endl;
+			 return;
+		 }
+		 reductions.push_back({ &reduction, variable, type, llvm::ArrayType::get(type, sslParallelMaxWorkers) });
+	 }
 
-	 // Pre-loop setup. Assuming 'start' initializes the loop variable
-	 llvm::Value* startVal = evaluateExpression(stmt->start.get());
-	 llvm::AllocaInst* loopVar = llvm_util::createEntryBlockAlloca(function, "loopVar", startVal->getType());
-	 builder.CreateStore(startVal, loopVar);
+	 llvm::ArrayType* contextType = llvm::ArrayType::get(ptrType, std::max<std::size_t>(1, captures.size() + reductions.size()));
+	 llvm::AllocaInst* parallelContext = llvm_util::createEntryBlockAlloca(function, "parallel.ctx", contextType);
+	 auto contextSlot = [&](llvm::Value* ctx, std::size_t index) {
+		 return builder.CreateConstInBoundsGEP2_32(contextType, ctx, 0, static_cast<unsigned>(index));
+	 };
+
+	 for (std::size_t i = 0; i < captures.size(); ++i) {
+		 builder.CreateStore(captures[i].second, contextSlot(parallelContext, i));
+	 }
+
+	 llvm::Value* workerCount = builder.CreateCall(getRuntimeFunction("ssl_parallel_worker_count", int32Type, {}), {}, "workers");
+	 std::vector<llvm::AllocaInst*> slotArrays;
+	 for (std::size_t i = 0; i < reductions.size(); ++i) {
+		 llvm::AllocaInst* slots = llvm_util::createEntryBlockAlloca(function, reductions[i].reduction->variable + ".slots", reductions[i].slotsType);
+		 builder.CreateStore(slots, contextSlot(parallelContext, captures.size() + i));
+		 slotArrays.push_back(slots);
+	 }
+	 emitWorkerLoop(workerCount, [&](llvm::Value* worker) {
+		 for (std::size_t i = 0; i < reductions.size(); ++i) {
+			 llvm::Value* slot = builder.CreateInBoundsGEP(reductions[i].slotsType, slotArrays[i], { builder.getInt32(0), worker });
+			 builder.CreateStore(getReductionIdentity(reductions[i].reduction->op, reductions[i].type), slot);
+		 }
+	 });
+
+	 // Outline the body; the code generator state of the enclosing function is put back afterwards
+	 llvm::FunctionType* bodyType = llvm::FunctionType::get(llvm::Type::getVoidTy(context), { int32Type, int32Type, ptrType, int32Type }, false);
+	 llvm::Function* bodyFunction = llvm::Function::Create(bodyType, llvm::Function::InternalLinkage, function->getName() + ".parallel", module);
+	 {
+		 llvm::IRBuilderBase::InsertPointGuard insertPointGuard(builder);
+		 llvm::Function* enclosingFunction = currentFunction;
+		 auto enclosingLocals = std::move(currentLocals);
+		 auto enclosingArrays = std::move(functionArrays);
+		 auto enclosingArenas = std::move(arenas);
+		 llvm::Value* enclosingStringArena = localStringArena;
+		 currentLocals.clear();
+		 functionArrays.clear();
+		 arenas.clear();
+		 localStringArena = nullptr; // The body runs on other threads; its strs fall back to each thread's string arena
+		 currentFunction = bodyFunction;
+
+		 auto argument = bodyFunction->arg_begin();
+		 llvm::Argument* lo = &*argument++;
+		 llvm::Argument* hi = &*argument++;
+		 llvm::Argument* ctx = &*argument++;
+		 llvm::Argument* worker = &*argument;
+		 lo->setName("lo");
+		 hi->setName("hi");
+		 ctx->setName("ctx");
+		 worker->setName("worker");
+
+		 builder.SetInsertPoint(llvm::BasicBlock::Create(context, "entry", bodyFunction));
+		 if (debugBuilder) {
+			 llvm::DISubprogram* bodySubprogram = createDebugFunction(bodyFunction, bodyFunction->getName().str(), stmt->location);
+			 builder.SetCurrentDebugLocation(llvm::DILocation::get(context, stmt->location.line, stmt->location.column, bodySubprogram));
+		 }
+		 for (std::size_t i = 0; i < captures.size(); ++i) {
+			 llvm::Type* type = captures[i].second->getAllocatedType();
+			 llvm::Value* source = builder.CreateLoad(ptrType, contextSlot(ctx, i));
+			 llvm::AllocaInst* local = llvm_util::createEntryBlockAlloca(bodyFunction, captures[i].first, type);
+			 builder.CreateStore(builder.CreateLoad(type, source, captures[i].first), local);
+			 currentLocals[captures[i].first] = local;
+		 }
+		 std::vector<llvm::AllocaInst*> accumulators;
+		 for (const auto& reduction : reductions) {
+			 llvm::AllocaInst* accumulator = llvm_util::createEntryBlockAlloca(bodyFunction, reduction.reduction->variable, reduction.type);
+			 builder.CreateStore(getReductionIdentity(reduction.reduction->op, reduction.type), accumulator);
+			 currentLocals[reduction.reduction->variable] = accumulator;
+			 accumulators.push_back(accumulator);
+		 }
+
+		 emitCountedLoop(lo, hi, builder.getInt32(1), stmt->iteratorName, stmt->body.get(), stmt->annotations);
+
+		 for (std::size_t i = 0; i < reductions.size(); ++i) {
+			 llvm::Value* slots = builder.CreateLoad(ptrType, contextSlot(ctx, captures.size() + i));
+			 llvm::Value* slot = builder.CreateInBoundsGEP(reductions[i].slotsType, slots, { builder.getInt32(0), worker });
+			 llvm::Value* partial = builder.CreateLoad(reductions[i].type, accumulators[i]);
+			 llvm::Value* combined = emitReductionOp(reductions[i].reduction->op, builder.CreateLoad(reductions[i].type, slot), partial);
+			 builder.CreateStore(combined, slot);
+		 }
+		 builder.CreateRetVoid();
+		 if (debugBuilder) {
+			 debugBuilder->finalizeSubprogram(bodyFunction->getSubprogram());
+		 }
+		 llvm::verifyFunction(*bodyFunction, &llvm::errs());
+
+		 currentFunction = enclosingFunction;
+		 currentLocals = std::move(enclosingLocals);
+		 functionArrays = std::move(enclosingArrays);
+		 arenas = std::move(enclosingArenas);
+		 localStringArena = enclosingStringArena;
+	 }
+
+	 llvm::FunctionCallee parallelFor = getRuntimeFunction("ssl_parallel_for", llvm::Type::getVoidTy(context), { int32Type, int32Type, ptrType, ptrType });
+	 builder.CreateCall(parallelFor, { startVal, endVal, bodyFunction, parallelContext });
+
+	 emitWorkerLoop(workerCount, [&](llvm::Value* worker) {
+		 for (std::size_t i = 0; i < reductions.size(); ++i) {
+			 llvm::Value* slot = builder.CreateInBoundsGEP(reductions[i].slotsType, slotArrays[i], { builder.getInt32(0), worker });
+			 llvm::Value* current = builder.CreateLoad(reductions[i].type, reductions[i].variable);
+			 llvm::Value* combined = emitReductionOp(reductions[i].reduction->op, current, builder.CreateLoad(reductions[i].type, slot));
+			 builder.CreateStore(combined, reductions[i].variable);
+		 }
+	 });
+ }
+
+ void LLVMCodeGen::emitWorkerLoop(llvm::Value* workerCount, const std::function<void(llvm::Value*)>& emitBody) {
+	 // for (worker = 0; worker < workerCount; ++worker); the runtime always reports at least one worker,
+	 // so the exit test can compare worker against workerCount - 1 like emitCountedLoop does
+	 llvm::Function* function = builder.GetInsertBlock()->getParent();
+	 llvm::BasicBlock* preheaderBB = builder.GetInsertBlock();
+	 llvm::BasicBlock* bodyBB = llvm::BasicBlock::Create(context, "workerLoop", function);
+	 llvm::BasicBlock* endBB = llvm::BasicBlock::Create(context, "workerLoopEnd", function);
+	 llvm::Value* lastWorker = builder.CreateNUWSub(workerCount, builder.getInt32(1), "lastWorker");
+	 builder.CreateBr(bodyBB);
+
+	 builder.SetInsertPoint(bodyBB);
+	 llvm::PHINode* worker = builder.CreatePHI(workerCount->getType(), 2, "worker");
+	 worker->addIncoming(builder.getInt32(0), preheaderBB);
+	 emitBody(worker);
+	 llvm::Value* nextWorker = builder.CreateAdd(worker, builder.getInt32(1), "nextWorker", true, true);
+	 worker->addIncoming(nextWorker, builder.GetInsertBlock());
+	 builder.CreateCondBr(builder.CreateICmpULT(worker, lastWorker), bodyBB, endBB);
+
+	 builder.SetInsertPoint(endBB);
+ }
+
+ llvm::Constant* LLVMCodeGen::getReductionIdentity(const std::string& op, llvm::Type* type) {
+	 int identity = op == "*" ? 1 : 0;
+	 if (type->isFloatingPointTy()) {
+		 return llvm::ConstantFP::get(type, identity);
+	 }
+	 return llvm::ConstantInt::get(type, identity);
+ }
+
+ llvm::Value* LLVMCodeGen::emitReductionOp(const std::string& op, llvm::Value* lhs, llvm::Value* rhs) {
+	 bool isFloat = lhs->getType()->isFloatingPointTy();
+	 if (op == "*") {
+		 return isFloat ? builder.CreateFMul(lhs, rhs, "reduced") : builder.CreateMul(lhs, rhs, "reduced");
+	 }
+	 return isFloat ? builder.CreateFAdd(lhs, rhs, "reduced") : builder.CreateAdd(lhs, rhs, "reduced");
+ }
+
+ llvm::MDNode* LLVMCodeGen::buildLoopMetadata(const std::vector<Annotation>& annotations) {
+	 if (annotations.empty()) {
+		 return nullptr;
+	 }
+
+	 // Counts were validated by the semantic analyzer
+	 auto countOf = [](const std::string& value) {
+		 unsigned count = 0;
+		 std::from_chars(value.data(), value.data() + value.size(), count);
+		 return count;
+	 };
+	 auto hint = [&](const char* name, llvm::Constant* value = nullptr) -> llvm::Metadata* {
+		 llvm::SmallVector<llvm::Metadata*, 2> operands{ llvm::MDString::get(context, name) };
+		 if (value) {
+			 operands.push_back(llvm::ConstantAsMetadata::get(value));
+		 }
+		 return llvm::MDNode::get(context, operands);
+	 };
+
+	 // First operand is the self reference that makes the node a distinct loop ID. With -g the loop's
+	 // line follows, so optimization remarks about it point at the source.
+	 llvm::SmallVector<llvm::Metadata*, 4> properties{ nullptr };
+	 if (llvm::DILocation* loopLocation = builder.getCurrentDebugLocation().get()) {
+		 properties.push_back(loopLocation);
+	 }
+	 for (const auto& annotation : annotations) {
+		 std::optional<std::string> count = annotation.argument("");
+		 if (annotation.name == "unroll") {
+			 properties.push_back(count ? hint("llvm.loop.unroll.count", builder.getInt32(countOf(*count))) : hint("llvm.loop.unroll.enable"));
+		 }
+		 else if (annotation.name == "nounroll") {
+			 properties.push_back(hint("llvm.loop.unroll.disable"));
+		 }
+		 else if (annotation.name == "vectorize") {
+			 properties.push_back(hint("llvm.loop.vectorize.enable", builder.getTrue()));
+			 if (std::optional<std::string> width = annotation.argument("width")) {
+				 properties.push_back(hint("llvm.loop.vectorize.width", builder.getInt32(countOf(*width))));
+			 }
+		 }
+		 else if (annotation.name == "interleave") {
+			 properties.push_back(hint("llvm.loop.interleave.count", builder.getInt32(countOf(*count))));
+		 }
+		 else {
+			 std::cerr << "Ignoring unknown loop annotation @" << annotation.name << std::endl;
+		 }
+	 }
 
-	 // Create BasicBlocks for the loop condition check, loop body, and loop end (to exit the loop)
-	 llvm::BasicBlock* condBB = llvm::BasicBlock::Create(context, "forCond", function);
+	 llvm::MDNode* loopID = llvm::MDNode::getDistinct(context, properties);
+	 loopID->replaceOperandWith(0, loopID);
+	 return loopID;
+ }
+
+ void LLVMCodeGen::emitCountedLoop(llvm::Value* startVal, llvm::Value* endVal, llvm::ConstantInt* stepVal, const std::string& iteratorName, const Statement* body,
+	 const std::vector<Annotation>& annotations) {
+	 // Emits the loop already in rotated, canonical form so trip-count analysis, the unroller and the
+	 // vectorizer recognize it directly:
+	 //   guard:  if !(start < end) goto forEnd else goto forPreheader
+	 //   forPreheader: limit = end - step
+	 //   forBody: iv = phi [start, forPreheader], [next, forInc]; body
+	 //   forInc:  next = add iv, step; if (iv < limit) goto forBody else goto forExit
+	 //   forExit: goto forEnd
+	 // The preheader and the dedicated exit put the loop in loop-simplify form.
+	 // A negative step counts down and compares with '>' instead.
+	 // Testing iv against end - step rather than next against end keeps the exit test from
+	 // overflowing near the type's limits, e.g. i8 range(0, 125, 10). Where end - step itself
+	 // would overflow no second iteration fits, so end is first clamped to TYPE_MIN + step
+	 // (TYPE_MAX + step when descending). The add carries no nsw: it wraps on the last iteration.
+	 llvm::Function* function = builder.GetInsertBlock()->getParent();
+	 bool descending = stepVal->isNegative();
+	 llvm::DebugLoc headerLocation = builder.getCurrentDebugLocation(); // the increment and exit test belong to the loop line, not the body's last
+
+	 auto emitCompare = [&](llvm::Value* value, const llvm::Twine& name) {
+		 return descending ? builder.CreateICmpSGT(value, endVal, name) : builder.CreateICmpSLT(value, endVal, name);
+	 };
+
+	 llvm::BasicBlock* preheaderBB = llvm::BasicBlock::Create(context, "forPreheader", function);
 	 llvm::BasicBlock* bodyBB = llvm::BasicBlock::Create(context, "forBody", function);
+	 llvm::BasicBlock* latchBB = llvm::BasicBlock::Create(context, "forInc", function);
 	 llvm::BasicBlock* endBB = llvm::BasicBlock::Create(context, "forEnd", function);
 
-	 // Branch to condition block to start loop execution
-	 builder.CreateBr(condBB);
-
-	 // Loop condition block
-	 builder.SetInsertPoint(condBB);
-	 llvm::Value* endVal = evaluateExpression(stmt->end.get());
-	 llvm::Value* loopVarValue = builder.CreateLoad(loopVar->getAllocatedType(), loopVar, "loopVar");
-	 // Assuming 'end' evaluates whether to continue the loop
-	 llvm::Value* condValue = builder.CreateICmpSLT(loopVarValue, endVal, "loopcond"); // Compare if loopVar < endVal
-	 builder.CreateCondBr(condValue, bodyBB, endBB);
+	 builder.CreateCondBr(emitCompare(startVal, "loopGuard"), preheaderBB, endBB);
+	 builder.SetInsertPoint(preheaderBB);
+	 llvm::Value* clampedEnd = endVal;
+	 if (!stepVal->isOne() && !stepVal->isMinusOne()) {
+		 unsigned bits = stepVal->getType()->getIntegerBitWidth();
+		 llvm::APInt bound = descending ? llvm::APInt::getSignedMaxValue(bits) + stepVal->getValue() : llvm::APInt::getSignedMinValue(bits) + stepVal->getValue();
+		 llvm::Constant* boundVal = llvm::ConstantInt::get(stepVal->getType(), bound);
+		 llvm::Value* outOfRange = descending ? builder.CreateICmpSGT(endVal, boundVal, "endPastBound") : builder.CreateICmpSLT(endVal, boundVal, "endPastBound");
+		 clampedEnd = builder.CreateSelect(outOfRange, boundVal, endVal, "clampedEnd");
+	 }
+	 llvm::Value* limitVal = builder.CreateNSWSub(clampedEnd, stepVal, "loopLimit");
+	 builder.CreateBr(bodyBB);
 
-	 // Loop body
 	 builder.SetInsertPoint(bodyBB);
-	 stmt->body->accept(this); // Execute the loop body
+	 llvm::PHINode* inductionVar = builder.CreatePHI(startVal->getType(), 2, iteratorName.empty() ? "loopVar" : iteratorName);
+	 inductionVar->addIncoming(startVal, preheaderBB);
+
+	 // The body reads the induction variable through a named local; it is promoted back to the phi by mem2reg
+	 std::optional<llvm::Value*> shadowedLocal;
+	 if (!iteratorName.empty()) {
+		 auto previous = currentLocals.find(iteratorName);
+		 if (previous != currentLocals.end()) {
+			 shadowedLocal = previous->second;
+		 }
+		 llvm::AllocaInst* loopVar = llvm_util::createEntryBlockAlloca(function, iteratorName, startVal->getType());
+		 builder.CreateStore(inductionVar, loopVar);
+		 currentLocals[iteratorName] = loopVar;
+		 declareDebugVariable(loopVar, iteratorName, 0);
+	 }
+
+	 body->accept(this); // Execute the loop body
+
+	 if (!iteratorName.empty()) {
+		 if (shadowedLocal) {
+			 currentLocals[iteratorName] = *shadowedLocal;
+		 }
+		 else {
+			 currentLocals.erase(iteratorName);
+		 }
+	 }
 
-	 // Loop increment
-	 llvm::Value* stepVal = llvm::ConstantInt::get(context, llvm::APInt(32, 1)); // Assuming an increment by 1
-	 llvm::Value* nextVar = builder.CreateAdd(loopVarValue, stepVal, "nextVar");
-	 builder.CreateStore(nextVar, loopVar);
+	 if (!builder.GetInsertBlock()->getTerminator()) {
+		 builder.CreateBr(latchBB);
+	 }
 
-	 // After body, jump back to check condition again
-	 builder.CreateBr(condBB);
+	 // Loop increment and exit test
+	 builder.SetInsertPoint(latchBB);
+	 builder.SetCurrentDebugLocation(headerLocation);
+	 llvm::Value* nextVar = builder.CreateAdd(inductionVar, stepVal, "nextVar");
+	 inductionVar->addIncoming(nextVar, latchBB);
+	 llvm::BasicBlock* exitBB = llvm::BasicBlock::Create(context, "forExit", function, endBB);
+	 llvm::Value* loopCond = descending ? builder.CreateICmpSGT(inductionVar, limitVal, "loopcond") : builder.CreateICmpSLT(inductionVar, limitVal, "loopcond");
+	 llvm::BranchInst* latchBranch = builder.CreateCondBr(loopCond, bodyBB, exitBB);
+	 if (llvm::MDNode* loopID = buildLoopMetadata(annotations)) {
+		 latchBranch->setMetadata(llvm::LLVMContext::MD_loop, loopID);
+	 }
+	 builder.SetInsertPoint(exitBB);
+	 builder.CreateBr(endBB);
 
 	 // Continue with the rest of the code after the loop
 	 builder.SetInsertPoint(endBB);
@@ -395,8 +861,13 @@ llvm::Module* LLVMCodeGen::getModule() const {
 	 // Populate loopBodyBB
 	 builder.SetInsertPoint(loopBodyBB);
 	 stmt->body->accept(this);
-	 // Jump back to conditionBB to re-evaluate the condition
-	 builder.CreateBr(conditionBB);
+	 // Jump back to conditionBB to re-evaluate the condition; the back edge carries the loop pragmas
+	 if (!builder.GetInsertBlock()->getTerminator()) {
+		 llvm::BranchInst* backEdge = builder.CreateBr(conditionBB);
+		 if (llvm::MDNode* loopID = buildLoopMetadata(stmt->annotations)) {
+			 backEdge->setMetadata(llvm::LLVMContext::MD_loop, loopID);
+		 }
+	 }
 
 	 // Continue with the rest of the code after the loop
 	 builder.SetInsertPoint(loopExitBB);
@@ -410,29 +881,36 @@ llvm::Module* LLVMCodeGen::getModule() const {
 	 // Create blocks for the then, else (optional), and merge parts of the if statement
 	 llvm::BasicBlock* thenBB = llvm::BasicBlock::Create(context, "then", function);
 	 llvm::BasicBlock* elseBB = stmt->elseBody ? llvm::BasicBlock::Create(context, "else", function) : nullptr;
+	 llvm::BasicBlock* mergeBB = llvm::BasicBlock::Create(context, "ifEnd", function);
 
 	 // Assuming 'condition' is an Expression that can be evaluated to a value
 	 llvm::Value* condValue = evaluateExpression(stmt->condition.get());; // Evaluate the condition expression
      
-	 if (elseBB) {
-		 builder.CreateCondBr(condValue, thenBB, elseBB);
-	 }
+	 builder.CreateCondBr(condValue, thenBB, elseBB ? elseBB : mergeBB);
 
 	 // Populate the 'then' block
 	 builder.SetInsertPoint(thenBB);
 	 // Visit/translate the body of the 'then' part
 	 stmt->thenBody->accept(this);
+	 // Branches that end in a ret do not fall through to the merge block
+	 if (!builder.GetInsertBlock()->getTerminator()) {
+		 builder.CreateBr(mergeBB);
+	 }
 
 	 if (stmt->elseBody) {
 		 //function->getBasicBlockList().push_back(elseBB);
 		 builder.SetInsertPoint(elseBB);
 		 stmt->elseBody->accept(this);
+		 if (!builder.GetInsertBlock()->getTerminator()) {
+			 builder.CreateBr(mergeBB);
+		 }
 	 }
 
+	 builder.SetInsertPoint(mergeBB);
  }
 
  void LLVMCodeGen::visit(const AssignmentStatement* stmt) {
-	 llvm::Value* valueToAssign = evaluateExpression(stmt->expression.get());
+	 llvm::Value* valueToAssign = evaluateExpression(stmt->expression.get(), getVariableType(lookupVariable(stmt->name)));
 	 if (!valueToAssign) {
 		 std::cerr << "Error evaluating expression for assignment to " << stmt->name << std::endl;
 		 return;
@@ -462,22 +940,6 @@ llvm::Module* LLVMCodeGen::getModule() const {
 	 
 	 std::cout << "Visiting print statement in LLVMCodeGen" << std::endl;
 
-	 llvm::Function* printfFunc = module->getFunction("printf");
-	 if (!printfFunc) {
-		 llvm::FunctionType* printfType = llvm::FunctionType::get(
-			 llvm::IntegerType::getInt32Ty(context),
-			 llvm::PointerType::getUnqual(llvm::Type::getInt8Ty(context)),
-			 true); // Indicates a variadic function
-		 printfFunc = llvm::Function::Create(
-			 printfType,
-			 llvm::Function::ExternalLinkage,
-			 "printf",
-			 module);
-		 std::cout << "Declared printf in module" << std::endl;
-	 }
-
-	 std::cout << "Found printf function " << std::endl;
-
 	 // Evaluate the expression
 	 llvm::Value* valueToPrint = evaluateExpression(stmt->expr.get());
 	 if (!valueToPrint) {
@@ -489,60 +951,56 @@ llvm::Module* LLVMCodeGen::getModule() const {
 		 valueToPrint->getType()->print(llvm::errs());
 		 llvm::errs() << "\n";
 	 }
-	 llvm::Value* formatStr = nullptr;
 
-	 std::cout << "Created format string for print statement" << std::endl; 
+	 // log() goes through the buffered SSL runtime (src/runtime) instead of printf,
+	 // so every value type gets its own entry point and no format string is parsed at run time.
+	 llvm::Type* voidType = llvm::Type::getVoidTy(context);
+
+	 // i8 and i16 print through the i32 entry point
+	 if (valueToPrint->getType()->isIntegerTy(8) || valueToPrint->getType()->isIntegerTy(16)) {
+		 valueToPrint = builder.CreateSExt(valueToPrint, llvm::Type::getInt32Ty(context), "widened");
+	 }
 
 	 if (valueToPrint->getType()->isIntegerTy(32)) {
-		 // Integer
 		 std::cout << "Integer value to print" << std::endl;
-		 formatStr = builder.CreateGlobalStringPtr("%d\n", "printedFormatInt");
+		 llvm::FunctionCallee logFunc = getRuntimeFunction("ssl_log_i32", voidType, { llvm::Type::getInt32Ty(context) });
+		 builder.CreateCall(logFunc, { valueToPrint });
 	 }
 	 else if (valueToPrint->getType()->isFloatTy()) {
-		 // Float
 		 std::cout << "Float value to print" << std::endl;
-		 llvm::Value* castedValueToPrint = valueToPrint;
-		 formatStr = builder.CreateGlobalStringPtr("%f\n", "printedFloatInt");
-		 castedValueToPrint = builder.CreateFPExt(valueToPrint, llvm::Type::getDoubleTy(context), "floatToDouble");
-
-		 std::vector<llvm::Value*> printfArgs = { formatStr, castedValueToPrint };
-		 builder.CreateCall(printfFunc, printfArgs);
-		 std::cout << "Finished float print statement" << std::endl;
-		 return;
+		 llvm::FunctionCallee logFunc = getRuntimeFunction("ssl_log_f32", voidType, { llvm::Type::getFloatTy(context) });
+		 builder.CreateCall(logFunc, { valueToPrint });
 	 }
-
-	 else if (valueToPrint->getType()->isIntegerTy(1)) { //boolean
-		 // Boolean
+	 else if (valueToPrint->getType()->isIntegerTy(64)) {
+		 llvm::FunctionCallee logFunc = getRuntimeFunction("ssl_log_i64", voidType, { llvm::Type::getInt64Ty(context) });
+		 builder.CreateCall(logFunc, { valueToPrint });
+	 }
+	 else if (valueToPrint->getType()->isDoubleTy()) {
+		 llvm::FunctionCallee logFunc = getRuntimeFunction("ssl_log_f64", voidType, { llvm::Type::getDoubleTy(context) });
+		 builder.CreateCall(logFunc, { valueToPrint });
+	 }
+	 else if (valueToPrint->getType()->isIntegerTy(1)) {
 		 std::cout << "Boolean value to print" << std::endl;
-		 formatStr = builder.CreateGlobalStringPtr("%s\n", "printedFormatBool");
-		 // Convert the boolean to a string for printing
-		 llvm::Value* trueStr = builder.CreateGlobalStringPtr("true", "trueStr");
-		 llvm::Value* falseStr = builder.CreateGlobalStringPtr("false", "falseStr");
-		 valueToPrint = builder.CreateSelect(valueToPrint, trueStr, falseStr);
+		 llvm::FunctionCallee logFunc = getRuntimeFunction("ssl_log_bool", voidType, { llvm::Type::getInt1Ty(context) });
+		 if (auto* func = llvm::dyn_cast<llvm::Function>(logFunc.getCallee())) {
+			 func->addParamAttr(0, llvm::Attribute::ZExt); // C 'bool' is passed zero-extended
+		 }
+		 llvm::CallInst* logCall = builder.CreateCall(logFunc, { valueToPrint });
+		 logCall->addParamAttr(0, llvm::Attribute::ZExt);
+	 }
+	 else if (valueToPrint->getType() == getStringType()) {
+		 // Printed by length, so strings may contain any bytes
+		 std::cout << "String value to print" << std::endl;
+		 llvm::FunctionCallee logFunc = getRuntimeFunction("ssl_log_str", voidType, { llvm::PointerType::getUnqual(llvm::Type::getInt8Ty(context)) });
+		 builder.CreateCall(logFunc, { emitStringArgument(valueToPrint) });
 	 }
 	 else {
-		 llvm::GlobalVariable* gVar = llvm::dyn_cast<llvm::GlobalVariable>(valueToPrint);
-
-		 if (gVar) { //handling special cases for strings as they are global variables
-
-			 std::cout << "String value to print" << std::endl;
-			 formatStr = builder.CreateGlobalStringPtr("%s\n", "printedFormatString");
-			 std::vector<llvm::Value*> printfArgs = { formatStr, valueToPrint };
-			 builder.CreateCall(printfFunc, printfArgs);
-			 return;
-		 }
-
-		 else {
-			 std::cerr << "Unsupported type for print statement" << std::endl;
-			 valueToPrint->getType()->print(llvm::errs());
-			 llvm::errs() << "\n"; // Print the type to standard error
-			 return;
-		 }
+		 std::cerr << "Unsupported type for print statement" << std::endl;
+		 valueToPrint->getType()->print(llvm::errs());
+		 llvm::errs() << "\n"; // Print the type to standard error
+		 return;
 	 }
 
-	 std::vector<llvm::Value*> printfArgs = { formatStr, valueToPrint};
-	 builder.CreateCall(printfFunc, printfArgs);
-
 	 std::cout << "Finished print statement" << std::endl;
  }
 
@@ -551,18 +1009,65 @@ llvm::Module* LLVMCodeGen::getModule() const {
 	 std::cout << "Visiting block statement" << std::endl;
 	 // Save the current state of local variables for the current scope
 	 auto previousLocals = currentLocals;
+	 std::size_t previousArrayCount = functionArrays.size();
+
+	 // A block is a lexical scope for the debugger too
+	 bool openedDebugBlock = false;
+	 if (debugBuilder && builder.GetInsertBlock() && stmt->location.line != 0) {
+		 if (llvm::DIScope* parent = getDebugScope(builder.GetInsertBlock()->getParent())) {
+			 debugBlocks.push_back(debugBuilder->createLexicalBlock(parent, debugFile, stmt->location.line, stmt->location.column));
+			 openedDebugBlock = true;
+		 }
+	 }
+
+	 for (const auto& decl : stmt->declarations) {
+		 emitDebugLocation(decl.get());
+		 decl->accept(this);
+	 }
 
 	 // Process each statement in the block
 	 for (const auto& statement : stmt->statements) {
+		 emitDebugLocation(statement.get());
 		 statement->accept(this);
 	 }
 
+	 if (openedDebugBlock) {
+		 debugBlocks.pop_back();
+	 }
+
+	 // Arrays declared in this block end their lifetime here (unless a return already released them)
+	 if (builder.GetInsertBlock() && !builder.GetInsertBlock()->getTerminator()) {
+		 emitArrayCleanup(functionArrays, previousArrayCount);
+	 }
+	 functionArrays.resize(previousArrayCount);
+
 	 // Restore the previous state of local variables, exiting the current scope
 	 currentLocals = previousLocals;
 
 	 std::cout << "Finished block statement" << std::endl;
  }
 
+ void LLVMCodeGen::visit(const ArenaStatement* stmt) {
+	 // Everything the block allocates comes from one arena, released with a single call where the block ends
+	 llvm::Type* ptrType = llvm::PointerType::getUnqual(llvm::Type::getInt8Ty(context));
+	 llvm::FunctionCallee enterArena = getRuntimeFunction("ssl_arena_enter", ptrType, {});
+	 arenas.push_back(builder.CreateCall(enterArena, {}, "arena"));
+	 auto previousLocals = currentLocals;
+
+	 for (const auto& decl : stmt->declarations) {
+		 emitDebugLocation(decl.get());
+		 decl->accept(this);
+	 }
+	 stmt->body->accept(this);
+
+	 // A ret inside the block has released the arena already
+	 if (builder.GetInsertBlock() && !builder.GetInsertBlock()->getTerminator()) {
+		 emitArenaRelease(arenas.size() - 1);
+	 }
+	 arenas.pop_back();
+	 currentLocals = previousLocals;
+ }
+
  void LLVMCodeGen::visit(const ExpressionStatement* stmt) {
 	 //Generate LLVM IR for an expression statement.
 	 llvm::Value* exprValue = evaluateExpression(stmt->expression.get());
@@ -571,14 +1076,40 @@ llvm::Module* LLVMCodeGen::getModule() const {
  void LLVMCodeGen::visit(const BinaryExpression* expr) {
 	 //Generate LLVM IR for a binary expression.
      // Evaluate the left and right subexpressions
-	 llvm::Value* left = evaluateExpression(expr->left.get());
-	 llvm::Value* right = evaluateExpression(expr->right.get());
+	 // An arithmetic result has the type of its operands, so a literal-only sum takes the type expected of it
+	 bool arithmetic = expr->op == "+" || expr->op == "-" || expr->op == "*" || expr->op == "/" || expr->op == "%";
+	 llvm::Type* operandLiteralType = arithmetic ? literalType : nullptr;
+	 llvm::Value* left = evaluateExpression(expr->left.get(), operandLiteralType);
+	 llvm::Value* right = evaluateExpression(expr->right.get(), operandLiteralType);
 
 	 if (!left || !right) {
 		 std::cerr << "Error evaluating binary expression" << std::endl;
 		 lastValue = nullptr;
 		 return;
 	 }
+	 if (left->getType() == getStringType()) {
+		 llvm::AllocaInst* stackBuffer = nullptr;
+		 if (const EscapeAnalysis::Allocation* target = escapeAnalysis.concatTarget(expr)) {
+			 auto buffer = stringBuffers.find(target);
+			 stackBuffer = buffer != stringBuffers.end() ? buffer->second : nullptr;
+		 }
+		 lastValue = emitStringBinary(expr->op, left, right, stackBuffer);
+		 return;
+	 }
+	 unifyLiteralOperands(expr->left.get(), left, expr->right.get(), right);
+
+	 if (left->getType()->isFPOrFPVectorTy()) {
+		 emitFloatingBinary(expr->op, left, right); // vector operands work lane by lane
+		 return;
+	 }
+	 if (expr->op == "and") {
+		 lastValue = builder.CreateAnd(left, right, "andtmp");
+		 return;
+	 }
+	 else if (expr->op == "or") {
+		 lastValue = builder.CreateOr(left, right, "ortmp");
+		 return;
+	 }
 	 
 	 if (expr->op == "+") {
 		 lastValue = builder.CreateAdd(left, right, "addtmp");
@@ -650,13 +1181,16 @@ llvm::Module* LLVMCodeGen::getModule() const {
  void LLVMCodeGen::visit(const UnaryExpression* expr) {
 	 //Generate LLVM IR for a unary expression.
 
-	 llvm::Value* operand = evaluateExpression(expr->expr.get());
+	 llvm::Value* operand = evaluateExpression(expr->expr.get(), expr->op == "-" ? literalType : nullptr);
 	 if (!operand) {
 		 std::cerr << "Null operand in unary expression." << std::endl;
 		 return;
 	 }
 
-	 if (expr->op == "-") {
+	 if (expr->op == "-" && operand->getType()->isFPOrFPVectorTy()) {
+		 lastValue = builder.CreateFNeg(operand, "negtmp");
+	 }
+	 else if (expr->op == "-") {
 		 // Assuming the operand is an integer
 		 lastValue = builder.CreateNeg(operand, "negtmp");
 	 }
@@ -694,15 +1228,26 @@ llvm::Module* LLVMCodeGen::getModule() const {
 	 std::cout << "length of expr->name: " << expr->name.length() << "\n";
 	 std::cout << "expr->name: " << expr->name << "\n";
 
+	 // Literals are untyped: they take the type their context expects (literalType), int or flt otherwise
 	 if (std::regex_match(expr->name, intRegex)) {
-		 int value = std::stoi(expr->name);
-		 lastValue = llvm::ConstantInt::get(context, llvm::APInt(32, value, true));
+		 std::int64_t value = expr->getIntegerConstant().value_or(0);
+		 // A vector type splats the literal across its lanes
+		 llvm::Type* type = literalType && literalType->isIntOrIntVectorTy() && !literalType->isIntOrIntVectorTy(1) ? literalType
+			 : integerFitsType(value, "int") ? llvm::Type::getInt32Ty(context) : llvm::Type::getInt64Ty(context);
+		 lastValue = llvm::ConstantInt::get(type, value, true);
 		 return;
 	 }
 	 else if (std::regex_match(expr->name, floatRegex)) {
 		 std::cout << "Primary expression is float: " << expr->name << std::endl;
-		 float value = std::stof(expr->name);
-		 lastValue = llvm::ConstantFP::get(context, llvm::APFloat(value));
+		 const char* first = expr->name.data();
+		 const char* last = first + expr->name.size();
+		 if (*first == '+') {
+			 ++first;
+		 }
+		 double value = 0.0;
+		 std::from_chars(first, last, value);
+		 llvm::Type* type = literalType && literalType->isFPOrFPVectorTy() ? literalType : llvm::Type::getFloatTy(context);
+		 lastValue = llvm::ConstantFP::get(type, value);
 		 return;
 	 }
 	 else if (expr->name == "true" || expr->name == "false") {
@@ -715,7 +1260,7 @@ llvm::Module* LLVMCodeGen::getModule() const {
 		 // Strings are a bit more complex due to their global nature
 		 std::cout << "Primary expression is string: " << expr->name << std::endl;
 		 std::string strLiteral = expr->name.substr(1, expr->name.length() - 2); // Remove quotes
-		 lastValue = builder.CreateGlobalStringPtr(strLiteral, "strLiteral");
+		 lastValue = getStringConstant(strLiteral);
 		 return;
 	 }
 	 else {
@@ -747,7 +1292,7 @@ llvm::Module* LLVMCodeGen::getModule() const {
 
  void LLVMCodeGen::visit(const AssignmentExpression* expr) {
 	 std::cout << "Assignment expression: " << expr->name << " =" << std::endl;
-	 llvm::Value* valueToAssign = evaluateExpression(expr->expression.get());
+	 llvm::Value* valueToAssign = evaluateExpression(expr->expression.get(), getVariableType(lookupVariable(expr->name)));
 	 if (!valueToAssign) {
 		 std::cerr << "Error evaluating the expression to assign." << std::endl;
 		 return;
@@ -790,38 +1335,46 @@ llvm::Module* LLVMCodeGen::getModule() const {
 
  void LLVMCodeGen::visit(const MethodCall* expr) {
 	 std::cout << "Method call: " << expr->name << std::endl;
-	 
-	//if (expr->name == "add") {
-	//	llvm::Value* arrayPtr = globals[expr->object->getName()]; // Get the array pointer
-	//	std::cout << "Processed the array pointer" << std::endl;
-	//	llvm::Value* elementToAdd = evaluateExpression(expr->arguments[0].get());
-	//	std::cout << "Processed the elementToAdd" << std::endl;
-	//	llvm::Value* currentSize = getCurrentSize(arrayPtr); // You need to manage size separately
-	//	std::cout << "Processed the currentSize" << std::endl;
-	//	llvm::Value* capacity = getCapacity(arrayPtr); // Same for capacity
-	//	std::cout << "Processed the capacity" << std::endl;
-	//	addElementToArray(arrayPtr, elementToAdd, currentSize, capacity);
-	//	std::cout << "Processed addElementToArray" << std::endl;
-	//}
-	//else if (expr->name == "remove") {
-	//	llvm::Value* arrayPtr = globals[expr->object->getName()]; // Get the array pointer
-	//	llvm::Value* currentSize = getCurrentSize(arrayPtr); // You need to manage size separately
-	//	removeLastElementFromArray(arrayPtr, currentSize);
-	//}
-	//else {
-	//	std::cout << "The object name is: " << expr->object->getName() << std::endl;
-	//	std::cerr << "Unsupported method call: " << expr->name << std::endl;
-	//}    
-}
 
+	 if (!currentFunction) {
+		 ensureMainFunctionExist();
+	 }
 
- void LLVMCodeGen::visit(const FunctionDefinition* funcDef) {
+	 llvm::Value* arrayPtr = lookupVariable(expr->object->getName());
+	 llvm::StructType* arrayType = arrayPtr ? getArrayType(arrayPtr) : nullptr;
+	 if (!arrayType) {
+		 std::cerr << "Array " << expr->object->getName() << " not found for method call." << std::endl;
+		 lastValue = nullptr;
+		 return;
+	 }
 
-	 std::cout << "We are visiting a function definition\n";
+	 if (expr->name == "add") {
+		 llvm::Type* elementType = arrayType->getElementType(3)->getArrayElementType();
+		 llvm::Value* elementToAdd = evaluateExpression(expr->arguments[0].get(), elementType);
+		 if (!elementToAdd) {
+			 std::cerr << "Error evaluating the element to add." << std::endl;
+			 return;
+		 }
+		 lastValue = emitArrayAdd(arrayPtr, arrayType, elementToAdd);
+	 }
+	 else if (expr->name == "remove") {
+		 lastValue = emitArrayRemove(arrayPtr, arrayType);
+	 }
+	 else {
+		 std::cout << "The object name is: " << expr->object->getName() << std::endl;
+		 std::cerr << "Unsupported method call: " << expr->name << std::endl;
+		 lastValue = nullptr;
+	 }
+}
 
-	 std::cout << funcDef->toString() << std::endl;
 
-	 std::cout << "Function name: " << funcDef->name << std::endl;
+ llvm::Function* LLVMCodeGen::declareFunction(const FunctionDefinition* funcDef) {
+
+	 if (llvm::Function* existing = module->getFunction(funcDef->name)) {
+		 return existing;
+	 }
+
+	 std::cout << "Declaring function: " << funcDef->name << std::endl;
 
 	 std::vector<llvm::Type*> paramTypes;
 
@@ -829,26 +1382,9 @@ llvm::Module* LLVMCodeGen::getModule() const {
 
 	 for (const auto& param : funcDef->parameters) {
 
-		 llvm::Type* type = nullptr;
-		 
 		 std::cout << "Parameter name: " << param.name << "\n";
 
-		 if (param.type == "int") {
-			 type = llvm::Type::getInt32Ty(context);
-		 }
-		 else if (param.type == "float") {
-			 type = llvm::Type::getFloatTy(context);
-		 }
-		 else if (param.type == "bool") {
-			 type = llvm::Type::getInt1Ty(context);
-		 }
-		 else if (param.type == "string") {
-			 std::cout << "String parameter\n";
-			 type = llvm::PointerType::getUnqual(llvm::Type::getInt8Ty(context));
-		 }
-		 else if (param.type == "void") { 
-			 type = llvm::Type::getVoidTy(context);
-		 }
+		 llvm::Type* type = getLLVMType(param.type);
 		 // Add more type mappings as necessary
 		 if (type) {
 			 std::cout << "There is a type\n";
@@ -856,44 +1392,74 @@ llvm::Module* LLVMCodeGen::getModule() const {
 		 }
 		 else {
 			 std::cerr << "Unsupported parameter type: " << param.type << std::endl;
-			 lastValue = nullptr;
-			 return; // Skip unsupported types
+			 return nullptr; // Skip unsupported types
 		 }
 	 }
-	 std::cout << "last value for function definition: " << lastValue << std::endl;
 	 llvm::Type* returnType = nullptr;
 
 	 std::cout << "This is the function return type: " << funcDef->returnType << "\n";
 
-	 if (funcDef->returnType == "int") {
-		 returnType = llvm::Type::getInt32Ty(context);
+	 returnType = getLLVMType(funcDef->returnType);
+	 if (!returnType) {
+		 std::cerr << "Unsupported return type: " << funcDef->returnType << std::endl;
+		 return nullptr;
 	 }
-	 else if (funcDef->returnType == "flt") {
-		 std::cout << "Function return type is float\n";
-		 returnType = llvm::Type::getFloatTy(context);
+
+	 llvm::FunctionType* functionType = llvm::FunctionType::get(returnType, paramTypes, false);
+	 llvm::Function* function = llvm::Function::Create(functionType, llvm::Function::ExternalLinkage, funcDef->name, module);
+	 function->setCallingConv(sslCallingConv);
+
+	 // Inlining and layout hints
+	 if (funcDef->hasAnnotation("inline")) {
+		 function->addFnAttr(llvm::Attribute::AlwaysInline);
 	 }
-	 else if (funcDef->returnType == "bool") {
-		 returnType = llvm::Type::getInt1Ty(context);
+	 if (funcDef->hasAnnotation("noinline")) {
+		 function->addFnAttr(llvm::Attribute::NoInline);
 	 }
-	 else if (funcDef->returnType == "str") { //return type for string not working atm
-		 std::cout << "String return type\n";
-		 returnType = llvm::PointerType::getUnqual(llvm::Type::getInt8Ty(context));
-		 std::cout << "String return type set\n";
+	 if (funcDef->hasAnnotation("hot")) {
+		 function->addFnAttr(llvm::Attribute::Hot);
 	 }
-	 else if (funcDef->returnType == "void") {
-		 returnType = llvm::Type::getVoidTy(context);
+	 if (funcDef->hasAnnotation("cold")) {
+		 // Cold code is kept small and placed away from the hot paths
+		 function->addFnAttr(llvm::Attribute::Cold);
+		 function->addFnAttr(llvm::Attribute::MinSize);
+		 function->addFnAttr(llvm::Attribute::OptimizeForSize);
 	 }
-
-	 llvm::FunctionType* functionType = llvm::FunctionType::get(returnType, paramTypes, false);
-	 llvm::Function* function = llvm::Function::Create(functionType, llvm::Function::ExternalLinkage, funcDef->name, module);
 	 std::cout << "Function created" << std::endl;
+	 return function;
+ }
+
+ void LLVMCodeGen::visit(const FunctionDefinition* funcDef) {
+
+	 std::cout << "We are visiting a function definition\n";
+
+	 std::cout << funcDef->toString() << std::endl;
+
+	 llvm::Function* function = declareFunction(funcDef);
+	 if (!function) {
+		 lastValue = nullptr;
+		 return;
+	 }
+	 if (!function->empty()) {
+		 std::cerr << "Function " << funcDef->name << " is already defined." << std::endl;
+		 return;
+	 }
+	 llvm::Type* returnType = function->getReturnType();
 
 	 currentFunction = function; // Track the current function
+	 functionArrays.clear();
+	 arenaArrays.clear();
+	 boundedArrays.clear();
+	 stringBuffers.clear();
 	 std::cout << "Tracking current function" << std::endl;
 
 	 // Create a new basic block to start insertion into.
 	 llvm::BasicBlock* entryBB = llvm::BasicBlock::Create(context, "entry", function);
 	 builder.SetInsertPoint(entryBB);
+	 if (debugBuilder) {
+		 llvm::DISubprogram* subprogram = createDebugFunction(function, funcDef->name, funcDef->location);
+		 builder.SetCurrentDebugLocation(llvm::DILocation::get(context, funcDef->location.line, funcDef->location.column, subprogram));
+	 }
 
 	 //builder.CreateBr(entryBB);// Branch to itself to ensure the block has a terminator
 	 
@@ -909,40 +1475,56 @@ llvm::Module* LLVMCodeGen::getModule() const {
 
 		 // Store the initial value into the alloca.
 		 builder.CreateStore(&arg, alloca);
+		 declareDebugVariable(alloca, funcDef->parameters[idx].name, idx + 1);
 
 		 // Add arguments to variable currentLocals
 		 currentLocals[arg.getName().str()] = alloca;
+		 if (arg.getType() == getStringType()) {
+			 createStringBuffer(funcDef, funcDef->parameters[idx].name);
+		 }
 
 		 idx++;
 	 }
+	 enterLocalStringArena(funcDef->name);
+	 emitProfileEnter(funcDef->name);
 
 	 // Visit each statement in the function body to generate their IR
 	 for (const auto& stmt : funcDef->body) {
 		 std::cout << "Visiting function body" << std::endl;
+		 emitDebugLocation(stmt.get());
 		 stmt->accept(this);
 	 }
 
 	 std::cout << "Finished visiting function body" << std::endl;
 
-	 //auto currentBB = builder.GetInsertBlock();
 	 //After visiting all statements, ensure the current block has a terminator
-	 if (!entryBB->getTerminator()) {
+	 if (!builder.GetInsertBlock()->getTerminator()) {
 		 if (returnType->isVoidTy()) {
-			 builder.SetInsertPoint(entryBB);
+			 emitArrayCleanup(functionArrays, 0);
+			 emitLocalStringArenaRelease();
+			 emitProfileExit();
 			 builder.CreateRetVoid(); // Proper terminator for void functions
 		 }
 		 else {
 			 // You should handle non-void return types appropriately, potentially with an unreachable instruction or default return
 			 llvm::Value* returnValue = llvm::Constant::getNullValue(returnType);
-			 builder.SetInsertPoint(entryBB);
+			 emitArrayCleanup(functionArrays, 0);
+			 emitLocalStringArenaRelease();
+			 emitProfileExit();
 			 builder.CreateRet(returnValue);
 		 }
 	 }
+	 functionArrays.clear();
+	 localStringArena = nullptr;
 
 	 currentFunction = nullptr; // Clear the current function
 
 	 // Reset the builder's insert point
 	 builder.ClearInsertionPoint();
+	 builder.SetCurrentDebugLocation(llvm::DebugLoc());
+	 if (debugBuilder) {
+		 debugBuilder->finalizeSubprogram(function->getSubprogram());
+	 }
 
 	 std::cout << "Resetted builder's insertion point" << std::endl;
 
@@ -956,6 +1538,7 @@ llvm::Module* LLVMCodeGen::getModule() const {
 		// Step 1: Find the LLVM function in the current module by name.
 		
 	    ensureMainFunctionExist();
+		emitDebugLocation(call);
 		
 		std::cout << "Main function existed in FunctionCall" <<	std::endl;
 
@@ -973,7 +1556,8 @@ llvm::Module* LLVMCodeGen::getModule() const {
 		// Step 2: Evaluate the arguments and prepare them for the call instruction.
 		std::vector<llvm::Value*> argsValues;
 		for (auto& arg : call->arguments) {
-			llvm::Value* argValue = evaluateExpression(arg.get());
+			llvm::Type* paramType = argsValues.size() < calleeFunction->arg_size() ? calleeFunction->getFunctionType()->getParamType(argsValues.size()) : nullptr;
+			llvm::Value* argValue = evaluateExpression(arg.get(), paramType);
 			std::cout << "Evaluated an argument for function call\n";
 			if (!argValue) {
 				std::cerr << "Argument evaluation failed for function call: " << call->name << std::endl;
@@ -992,6 +1576,7 @@ llvm::Module* LLVMCodeGen::getModule() const {
 		}
 		
 		llvm::CallInst* callInst = builder.CreateCall(calleeFunction, argsValues);
+		callInst->setCallingConv(calleeFunction->getCallingConv());
 		
 		std::cout << "Created call instruction" << std::endl;
 
@@ -1007,6 +1592,209 @@ llvm::Module* LLVMCodeGen::getModule() const {
 		std::cout << "Function call visited" << std::endl;
 }
 
+ void LLVMCodeGen::visit(const CallExpression* expr) {
+	 llvm::Function* calleeFunction = module->getFunction(expr->name);
+	 if (!calleeFunction) {
+		 std::cerr << "Unknown function referenced: " << expr->name << std::endl;
+		 lastValue = nullptr;
+		 return;
+	 }
+
+	 std::vector<llvm::Value*> argsValues;
+	 for (const auto& arg : expr->arguments) {
+		 llvm::Type* paramType = argsValues.size() < calleeFunction->arg_size() ? calleeFunction->getFunctionType()->getParamType(argsValues.size()) : nullptr;
+		 llvm::Value* argValue = evaluateExpression(arg.get(), paramType);
+		 if (!argValue) {
+			 std::cerr << "Argument evaluation failed for function call: " << expr->name << std::endl;
+			 lastValue = nullptr;
+			 return;
+		 }
+		 argsValues.push_back(argValue);
+	 }
+
+	 llvm::CallInst* callInst = builder.CreateCall(calleeFunction, argsValues);
+	 callInst->setCallingConv(calleeFunction->getCallingConv());
+
+	 // A call in tail position reuses the caller's frame, so recursion runs in constant stack space.
+	 // musttail needs the same calling convention on both sides, which only holds between SSL functions.
+	 if (expr->tailCall && currentFunction && currentFunction->getCallingConv() == calleeFunction->getCallingConv()
+		 && currentFunction->getReturnType() == calleeFunction->getReturnType()) {
+		 callInst->setTailCallKind(llvm::CallInst::TCK_MustTail);
+	 }
+	 else if (expr->tailCall) {
+		 callInst->setTailCallKind(llvm::CallInst::TCK_Tail);
+	 }
+
+	 functionCalls.push_back(expr->name);
+	 lastValue = callInst;
+ }
+
+ void LLVMCodeGen::visit(const ConversionExpression* expr) {
+	 llvm::Value* value = evaluateExpression(expr->expr.get());
+	 llvm::Type* targetType = getLLVMType(expr->targetType);
+	 if (!value || !targetType) {
+		 std::cerr << "Error evaluating conversion to " << expr->targetType << std::endl;
+		 lastValue = nullptr;
+		 return;
+	 }
+
+	 llvm::Type* sourceType = value->getType();
+	 if (sourceType->isIntegerTy() && targetType->isIntegerTy()) {
+		 lastValue = builder.CreateSExtOrTrunc(value, targetType, "convtmp"); // narrowing keeps the low bits
+	 }
+	 else if (sourceType->isIntegerTy()) {
+		 lastValue = builder.CreateSIToFP(value, targetType, "convtmp");
+	 }
+	 else if (targetType->isIntegerTy()) {
+		 // Saturates instead of producing poison when the value does not fit, and NaN becomes 0
+		 lastValue = builder.CreateIntrinsic(llvm::Intrinsic::fptosi_sat, { targetType, sourceType }, { value }, nullptr, "convtmp");
+	 }
+	 else {
+		 lastValue = builder.CreateFPCast(value, targetType, "convtmp");
+	 }
+ }
+
+ void LLVMCodeGen::visit(const VectorExpression* expr) {
+	 auto* type = llvm::cast<llvm::FixedVectorType>(getLLVMType(expr->type));
+	 llvm::Type* elementType = type->getElementType();
+
+	 if (expr->arguments.size() == 1) {
+		 llvm::Value* value = evaluateExpression(expr->arguments[0].get(), elementType);
+		 if (!value) {
+			 lastValue = nullptr;
+			 return;
+		 }
+		 if (!value->getType()->isVectorTy()) {
+			 lastValue = builder.CreateVectorSplat(type->getNumElements(), value, "splat");
+		 }
+		 else if (value->getType() == type) {
+			 lastValue = value;
+		 }
+		 else if (elementType->isFloatingPointTy()) {
+			 lastValue = builder.CreateSIToFP(value, type, "convtmp");
+		 }
+		 else {
+			 // Same saturating conversion as int(x) on a single flt
+			 lastValue = builder.CreateIntrinsic(llvm::Intrinsic::fptosi_sat, { type, value->getType() }, { value }, nullptr, "convtmp");
+		 }
+		 return;
+	 }
+
+	 llvm::Value* vector = llvm::PoisonValue::get(type);
+	 for (unsigned i = 0; i < expr->arguments.size(); ++i) {
+		 llvm::Value* lane = evaluateExpression(expr->arguments[i].get(), elementType);
+		 if (!lane) {
+			 lastValue = nullptr;
+			 return;
+		 }
+		 vector = builder.CreateInsertElement(vector, lane, builder.getInt32(i), "lane");
+	 }
+	 lastValue = vector;
+ }
+
+ void LLVMCodeGen::visit(const BuiltinCall* expr) {
+	 if (!currentFunction) {
+		 ensureMainFunctionExist();
+	 }
+
+	 if (expr->takesArray()) {
+		 llvm::Value* arrayPtr = lookupVariable(expr->arguments[0]->getName());
+		 llvm::StructType* arrayType = arrayPtr ? getArrayType(arrayPtr) : nullptr;
+		 llvm::Value* index = evaluateExpression(expr->arguments[1].get());
+		 if (!arrayType || !index) {
+			 std::cerr << "Array " << expr->arguments[0]->getName() << " not found for " << expr->name << "." << std::endl;
+			 lastValue = nullptr;
+			 return;
+		 }
+		 llvm::Type* elementType = arrayType->getElementType(3)->getArrayElementType();
+		 // Array data is only aligned to its element, so the vector access is too
+		 llvm::Align alignment(elementType->getPrimitiveSizeInBits() / 8);
+		 if (expr->name == "store") {
+			 llvm::Value* vector = evaluateExpression(expr->arguments[2].get());
+			 if (!vector) {
+				 lastValue = nullptr;
+				 return;
+			 }
+			 unsigned lanes = llvm::cast<llvm::FixedVectorType>(vector->getType())->getNumElements();
+			 builder.CreateAlignedStore(vector, emitVectorSlot(arrayPtr, arrayType, index, lanes), alignment);
+			 lastValue = vector;
+		 }
+		 else {
+			 unsigned lanes = expr->name == "load4" ? 4 : 8;
+			 llvm::Type* vectorType = llvm::FixedVectorType::get(elementType, lanes);
+			 lastValue = builder.CreateAlignedLoad(vectorType, emitVectorSlot(arrayPtr, arrayType, index, lanes), alignment, "vload");
+		 }
+		 return;
+	 }
+
+	 std::vector<llvm::Value*> args;
+	 for (const auto& argument : expr->arguments) {
+		 llvm::Value* value = evaluateExpression(argument.get());
+		 if (!value) {
+			 std::cerr << "Error evaluating argument of " << expr->name << "." << std::endl;
+			 lastValue = nullptr;
+			 return;
+		 }
+		 args.push_back(value);
+	 }
+
+	 llvm::Value* value = args[0];
+	 if (expr->name == "len") {
+		 // The length is kept in the string value itself, so this is a load rather than a scan. len() is
+		 // an int, so a str of 2 GB or more stops the program rather than reporting a wrapped length
+		 llvm::Value* length = emitStringLength(value);
+		 llvm::Function* function = builder.GetInsertBlock()->getParent();
+		 llvm::BasicBlock* trapBB = llvm::BasicBlock::Create(context, "lenTooLong", function);
+		 llvm::BasicBlock* fitsBB = llvm::BasicBlock::Create(context, "lenFits", function);
+		 llvm::MDBuilder mdBuilder(context);
+		 llvm::Value* tooLong = builder.CreateICmpUGT(length, builder.getInt64(std::numeric_limits<std::int32_t>::max()), "tooLong");
+		 builder.CreateCondBr(tooLong, trapBB, fitsBB, mdBuilder.createBranchWeights(1, 1 << 20));
+
+		 builder.SetInsertPoint(trapBB);
+		 builder.CreateIntrinsic(llvm::Intrinsic::trap, {}, {});
+		 builder.CreateUnreachable();
+
+		 builder.SetInsertPoint(fitsBB);
+		 lastValue = builder.CreateTrunc(length, builder.getInt32Ty(), "len");
+		 return;
+	 }
+	 bool floating = value->getType()->isFPOrFPVectorTy();
+	 if (expr->name == "hsum") {
+		 if (floating) {
+			 // Reassociation lets the lanes be added pairwise instead of strictly left to right
+			 auto* sum = builder.CreateFAddReduce(llvm::ConstantFP::getNegativeZero(value->getType()->getScalarType()), value);
+			 sum->setHasAllowReassoc(true);
+			 lastValue = sum;
+		 }
+		 else {
+			 lastValue = builder.CreateAddReduce(value);
+		 }
+	 }
+	 else if (expr->name == "hmin") {
+		 lastValue = floating ? builder.CreateFPMinReduce(value) : builder.CreateIntMinReduce(value, true);
+	 }
+	 else if (expr->name == "hmax") {
+		 lastValue = floating ? builder.CreateFPMaxReduce(value) : builder.CreateIntMaxReduce(value, true);
+	 }
+	 else if (expr->name == "any") {
+		 lastValue = builder.CreateOrReduce(value);
+	 }
+	 else if (expr->name == "all") {
+		 lastValue = builder.CreateAndReduce(value);
+	 }
+	 else if (expr->name == "select") {
+		 unifyLiteralOperands(expr->arguments[1].get(), args[1], expr->arguments[2].get(), args[2]);
+		 lastValue = builder.CreateSelect(value, args[1], args[2], "selecttmp");
+	 }
+	 else if (expr->name == "lane") {
+		 lastValue = builder.CreateExtractElement(value, args[1], "lanetmp");
+	 }
+	 else {
+		 std::cerr << "Unsupported built-in: " << expr->name << std::endl;
+		 lastValue = nullptr;
+	 }
+ }
+
  void LLVMCodeGen::initializeExternalFunctions() {
 	llvm::FunctionType* mallocType = llvm::FunctionType::get(llvm::PointerType::get(llvm::Type::getInt8Ty(context), 0), { llvm::Type::getInt64Ty(context) }, false);
 	mallocFunction = llvm::Function::Create(mallocType, llvm::Function::ExternalLinkage, "malloc", module);
@@ -1019,4 +1807,620 @@ llvm::Module* LLVMCodeGen::getModule() const {
 	 
  }
 
- 
\ No newline at end of file
+ void LLVMCodeGen::emitProfileEnter(const std::string& functionName) {
+	 if (!instrumentFunctions) {
+		 return;
+	 }
+	 // ssl_profile_site: the name and an id the runtime assigns on the first call
+	 llvm::Type* ptrType = llvm::PointerType::getUnqual(llvm::Type::getInt8Ty(context));
+	 llvm::Type* int32Type = llvm::Type::getInt32Ty(context);
+	 llvm::StructType* siteType = llvm::StructType::get(context, { ptrType, int32Type });
+	 llvm::Constant* name = builder.CreateGlobalStringPtr(functionName, "ssl.profile.name." + functionName);
+	 auto* site = new llvm::GlobalVariable(*module, siteType, false, llvm::GlobalValue::InternalLinkage,
+		 llvm::ConstantStruct::get(siteType, { name, llvm::ConstantInt::getSigned(int32Type, -1) }), "ssl.profile." + functionName);
+	 builder.CreateCall(getRuntimeFunction("ssl_profile_enter", llvm::Type::getVoidTy(context), { ptrType }), { site });
+ }
+
+ void LLVMCodeGen::emitProfileExit() {
+	 // Parallel loop bodies are not instrumented; their time counts toward the function running the loop
+	 if (!instrumentFunctions || !currentFunction || builder.GetInsertBlock()->getParent() != currentFunction) {
+		 return;
+	 }
+	 builder.CreateCall(getRuntimeFunction("ssl_profile_exit", llvm::Type::getVoidTy(context), {}), {});
+ }
+
+ llvm::FunctionCallee LLVMCodeGen::getRuntimeFunction(const std::string& name, llvm::Type* returnType, llvm::ArrayRef<llvm::Type*> paramTypes) {
+	 llvm::FunctionType* funcType = llvm::FunctionType::get(returnType, paramTypes, false);
+	 llvm::FunctionCallee callee = module->getOrInsertFunction(name, funcType);
+	 // The log and str comparison helpers only print or compare, never unwind and always return. Without this
+	 // a call in a loop body keeps the latch from being guaranteed to execute, and the induction variable
+	 // cannot be proven not to wrap. The other entry points run SSL code (ssl_parallel_for) or may abort when out of memory.
+	 bool returningLeaf = name.rfind("ssl_log_", 0) == 0 || name == "ssl_str_equals";
+	 auto* func = llvm::dyn_cast<llvm::Function>(callee.getCallee());
+	 if (returningLeaf && func) {
+		 func->addFnAttr(llvm::Attribute::NoUnwind);
+		 func->addFnAttr(llvm::Attribute::WillReturn);
+	 }
+	 return callee;
+ }
+
+ llvm::Type* LLVMCodeGen::getLLVMType(const std::string& type) {
+	 // Source spellings (flt, str, dbl) and the semantic analyzer's (float, string, double) are both accepted
+	 std::string normalized = normalizeType(type);
+	 if (unsigned bits = integerTypeBits(normalized)) {
+		 return llvm::Type::getIntNTy(context, bits);
+	 }
+	 if (normalized == "float") {
+		 return llvm::Type::getFloatTy(context);
+	 }
+	 if (normalized == "double") {
+		 return llvm::Type::getDoubleTy(context);
+	 }
+	 if (normalized == "bool") {
+		 return llvm::Type::getInt1Ty(context);
+	 }
+	 if (normalized == "string") {
+		 return getStringType();
+	 }
+	 if (normalized == "void") {
+		 return llvm::Type::getVoidTy(context);
+	 }
+	 if (unsigned lanes = vectorLanes(normalized)) {
+		 // Masks are what vector comparisons produce: one i1 per lane
+		 llvm::Type* elementType = isMaskType(normalized) ? llvm::Type::getInt1Ty(context) : getLLVMType(vectorElementType(normalized));
+		 return llvm::FixedVectorType::get(elementType, lanes);
+	 }
+	 return nullptr;
+ }
+
+ llvm::Type* LLVMCodeGen::getVariableType(llvm::Value* storage) {
+	 if (auto* alloca = llvm::dyn_cast_or_null<llvm::AllocaInst>(storage)) {
+		 return alloca->getAllocatedType();
+	 }
+	 if (auto* global = llvm::dyn_cast_or_null<llvm::GlobalVariable>(storage)) {
+		 return global->getValueType();
+	 }
+	 return nullptr;
+ }
+
+ void LLVMCodeGen::unifyLiteralOperands(Expression* leftExpr, llvm::Value*& left, Expression* rightExpr, llvm::Value*& right) {
+	 if (left->getType() == right->getType()) {
+		 return;
+	 }
+	 // Same rule as the semantic analyzer: a literal that fits the other operand's type is re-emitted in it
+	 auto fits = [](Expression* literal, llvm::Type* type) {
+		 if (!literal->isNumericLiteral()) {
+			 return false;
+		 }
+		 type = type->getScalarType(); // a literal next to a vector is splatted
+		 if (type->isFloatingPointTy()) {
+			 return !literal->getIntegerConstant().has_value();
+		 }
+		 auto value = literal->getIntegerConstant();
+		 return type->isIntegerTy() && value.has_value() && llvm::isIntN(type->getIntegerBitWidth(), *value);
+	 };
+	 if (fits(rightExpr, left->getType())) {
+		 right = evaluateExpression(rightExpr, left->getType());
+	 }
+	 else if (fits(leftExpr, right->getType())) {
+		 left = evaluateExpression(leftExpr, right->getType());
+	 }
+ }
+
+ void LLVMCodeGen::emitFloatingBinary(const std::string& op, llvm::Value* left, llvm::Value* right) {
+	 if (op == "+") {
+		 lastValue = builder.CreateFAdd(left, right, "addtmp");
+	 }
+	 else if (op == "-") {
+		 lastValue = builder.CreateFSub(left, right, "subtmp");
+	 }
+	 else if (op == "*") {
+		 lastValue = builder.CreateFMul(left, right, "multmp");
+	 }
+	 else if (op == "/") {
+		 lastValue = builder.CreateFDiv(left, right, "divtmp");
+	 }
+	 else if (op == "%") {
+		 lastValue = builder.CreateFRem(left, right, "modtmp");
+	 }
+	 else if (op == "<") {
+		 lastValue = builder.CreateFCmpOLT(left, right, "cmptmp");
+	 }
+	 else if (op == ">") {
+		 lastValue = builder.CreateFCmpOGT(left, right, "cmptmp");
+	 }
+	 else if (op == "<=") {
+		 lastValue = builder.CreateFCmpOLE(left, right, "cmptmp");
+	 }
+	 else if (op == ">=") {
+		 lastValue = builder.CreateFCmpOGE(left, right, "cmptmp");
+	 }
+	 else if (op == "equals") {
+		 lastValue = builder.CreateFCmpOEQ(left, right, "cmptmp");
+	 }
+	 else if (op == "notEquals") {
+		 lastValue = builder.CreateFCmpUNE(left, right, "cmptmp"); // true for NaN, the negation of equals
+	 }
+	 else {
+		 std::cerr << "Unsupported binary operation on floating-point operands: " << op << std::endl;
+		 lastValue = nullptr;
+	 }
+ }
+
+ llvm::DISubprogram* LLVMCodeGen::createDebugFunction(llvm::Function* function, const std::string& name, SourceLocation location) {
+	 std::vector<llvm::Metadata*> signature{ getDebugType(function->getReturnType()) }; // nullptr stands for void
+	 for (llvm::Argument& arg : function->args()) {
+		 signature.push_back(getDebugType(arg.getType()));
+	 }
+	 llvm::DISubroutineType* type = debugBuilder->createSubroutineType(debugBuilder->getOrCreateTypeArray(signature));
+	 llvm::DISubprogram* subprogram = debugBuilder->createFunction(debugFile, name, function->getName(), debugFile, location.line, type, location.line,
+		 llvm::DINode::FlagPrototyped, llvm::DISubprogram::SPFlagDefinition);
+	 function->setSubprogram(subprogram);
+	 return subprogram;
+ }
+
+ llvm::DIScope* LLVMCodeGen::getDebugScope(llvm::Function* function) {
+	 // Blocks opened in an enclosing function stay on the stack while a parallel loop body is outlined
+	 for (auto block = debugBlocks.rbegin(); block != debugBlocks.rend(); ++block) {
+		 if ((*block)->getSubprogram() == function->getSubprogram()) {
+			 return *block;
+		 }
+	 }
+	 return function->getSubprogram();
+ }
+
+ void LLVMCodeGen::emitDebugLocation(const ASTNode* node) {
+	 if (!debugBuilder || !builder.GetInsertBlock() || node->location.line == 0) {
+		 return;
+	 }
+	 if (llvm::DIScope* scope = getDebugScope(builder.GetInsertBlock()->getParent())) {
+		 builder.SetCurrentDebugLocation(llvm::DILocation::get(context, node->location.line, node->location.column, scope));
+	 }
+ }
+
+ void LLVMCodeGen::declareDebugVariable(llvm::AllocaInst* storage, const std::string& name, unsigned argNo) {
+	 llvm::DILocation* location = builder.getCurrentDebugLocation().get();
+	 llvm::DIType* type = debugBuilder && location ? getDebugType(storage->getAllocatedType()) : nullptr;
+	 if (!type) {
+		 return;
+	 }
+	 llvm::DIScope* scope = location->getScope();
+	 llvm::DILocalVariable* variable = argNo != 0
+		 ? debugBuilder->createParameterVariable(scope, name, argNo, debugFile, location->getLine(), type, true)
+		 : debugBuilder->createAutoVariable(scope, name, debugFile, location->getLine(), type, true);
+	 debugBuilder->insertDeclare(storage, variable, debugBuilder->createExpression(), location, builder.GetInsertBlock());
+ }
+
+ void LLVMCodeGen::declareDebugGlobal(llvm::GlobalVariable* global, const std::string& name, SourceLocation location) {
+	 llvm::DIType* type = debugBuilder ? getDebugType(global->getValueType()) : nullptr;
+	 if (!type) {
+		 return;
+	 }
+	 global->addDebugInfo(debugBuilder->createGlobalVariableExpression(debugUnit, name, global->getName(), debugFile, location.line, type,
+		 global->hasLocalLinkage()));
+ }
+
+ llvm::DIType* LLVMCodeGen::getDebugType(llvm::Type* type) {
+	 // Named with the SSL spellings, so the debugger shows flt and i64 rather than float and long
+	 if (type->isIntegerTy(1)) {
+		 return debugBuilder->createBasicType("bool", 8, llvm::dwarf::DW_ATE_boolean);
+	 }
+	 if (type->isIntegerTy()) {
+		 unsigned bits = type->getIntegerBitWidth();
+		 return debugBuilder->createBasicType(bits == 32 ? "int" : "i" + std::to_string(bits), bits, llvm::dwarf::DW_ATE_signed);
+	 }
+	 if (type->isFloatTy()) {
+		 return debugBuilder->createBasicType("flt", 32, llvm::dwarf::DW_ATE_float);
+	 }
+	 if (type->isDoubleTy()) {
+		 return debugBuilder->createBasicType("dbl", 64, llvm::dwarf::DW_ATE_float);
+	 }
+	 if (type == getStringType()) {
+		 // Strings of up to 15 bytes are stored in these two fields rather than behind data
+		 llvm::DIType* charType = debugBuilder->createBasicType("char", 8, llvm::dwarf::DW_ATE_signed_char);
+		 llvm::DIType* dataType = debugBuilder->createPointerType(charType, 64);
+		 llvm::DIType* lengthType = getDebugType(llvm::Type::getInt64Ty(context));
+		 llvm::DICompositeType* debugString = debugBuilder->createStructType(debugUnit, "str", debugFile, 0, 128, 64, llvm::DINode::FlagZero, nullptr, {});
+		 llvm::Metadata* members[] = {
+			 debugBuilder->createMemberType(debugString, "data", debugFile, 0, 64, 64, 0, llvm::DINode::FlagZero, dataType),
+			 debugBuilder->createMemberType(debugString, "length", debugFile, 0, 64, 64, 64, llvm::DINode::FlagZero, lengthType),
+		 };
+		 debugBuilder->replaceArrays(debugString, debugBuilder->getOrCreateArray(members));
+		 return debugString;
+	 }
+	 if (auto* vectorType = llvm::dyn_cast<llvm::FixedVectorType>(type)) {
+		 llvm::DIType* elementType = getDebugType(vectorType->getElementType());
+		 std::uint64_t bits = vectorType->getNumElements() * vectorType->getScalarSizeInBits();
+		 llvm::Metadata* lanes = debugBuilder->getOrCreateSubrange(0, vectorType->getNumElements());
+		 return debugBuilder->createVectorType(bits, static_cast<std::uint32_t>(bits), elementType, debugBuilder->getOrCreateArray(lanes));
+	 }
+	 if (auto* arrayType = llvm::dyn_cast<llvm::ArrayType>(type)) {
+		 llvm::DIType* elementType = getDebugType(arrayType->getElementType());
+		 std::uint64_t elementBits = arrayType->getElementType()->getPrimitiveSizeInBits();
+		 if (!elementType || elementBits == 0) {
+			 return nullptr;
+		 }
+		 llvm::Metadata* elements = debugBuilder->getOrCreateSubrange(0, arrayType->getNumElements());
+		 return debugBuilder->createArrayType(arrayType->getNumElements() * elementBits, static_cast<std::uint32_t>(elementBits), elementType,
+			 debugBuilder->getOrCreateArray(elements));
+	 }
+	 return nullptr;
+ }
+
+ llvm::Value* LLVMCodeGen::lookupVariable(const std::string& name) {
+	 auto localIt = currentLocals.find(name);
+	 if (localIt != currentLocals.end()) {
+		 return localIt->second;
+	 }
+	 auto globalIt = globals.find(name);
+	 if (globalIt != globals.end()) {
+		 return globalIt->second;
+	 }
+	 return nullptr;
+ }
+
+ llvm::StructType* LLVMCodeGen::getArrayType(llvm::Value* arrayPtr) {
+	 llvm::Type* storedType = nullptr;
+	 if (auto* alloca = llvm::dyn_cast<llvm::AllocaInst>(arrayPtr)) {
+		 storedType = alloca->getAllocatedType();
+	 }
+	 else if (auto* globalVar = llvm::dyn_cast<llvm::GlobalVariable>(arrayPtr)) {
+		 storedType = globalVar->getValueType();
+	 }
+
+	 // Every array type starts with the { data, length, capacity } header followed by the inline buffer
+	 auto* structType = llvm::dyn_cast_or_null<llvm::StructType>(storedType);
+	 if (!structType || structType->getNumElements() != 4 || !structType->getElementType(3)->isArrayTy()) {
+		 return nullptr;
+	 }
+	 return structType;
+ }
+
+ llvm::StructType* LLVMCodeGen::getArrayHeaderType() {
+	 if (!arrayHeaderType) {
+		 llvm::Type* ptrType = llvm::PointerType::getUnqual(llvm::Type::getInt8Ty(context));
+		 llvm::Type* sizeType = llvm::Type::getInt64Ty(context);
+		 arrayHeaderType = llvm::StructType::create(context, { ptrType, sizeType, sizeType }, "SSLArrayHeader");
+	 }
+	 return arrayHeaderType;
+ }
+
+ llvm::StructType* LLVMCodeGen::getStringType() {
+	 if (!stringType) {
+		 llvm::Type* ptrType = llvm::PointerType::getUnqual(llvm::Type::getInt8Ty(context));
+		 stringType = llvm::StructType::create(context, { ptrType, llvm::Type::getInt64Ty(context) }, "SSLString");
+	 }
+	 return stringType;
+ }
+
+ llvm::Constant* LLVMCodeGen::getStringConstant(const std::string& text) {
+	 // Literals point at a constant, whatever their length; only strings built at run time are stored inline
+	 llvm::Constant* bytes = llvm::ConstantDataArray::getString(context, text, false);
+	 auto* storage = new llvm::GlobalVariable(*module, bytes->getType(), true, llvm::GlobalValue::PrivateLinkage, bytes, "str");
+	 storage->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
+	 storage->setAlignment(llvm::MaybeAlign(1));
+	 llvm::Constant* length = llvm::ConstantInt::get(llvm::Type::getInt64Ty(context), text.size());
+	 return llvm::ConstantStruct::get(getStringType(), { storage, length });
+ }
+
+ llvm::Value* LLVMCodeGen::emitStringArgument(llvm::Value* string) {
+	 llvm::AllocaInst* slot = llvm_util::createEntryBlockAlloca(builder.GetInsertBlock()->getParent(), "strarg", getStringType());
+	 builder.CreateStore(string, slot);
+	 return slot;
+ }
+
+ llvm::Value* LLVMCodeGen::emitStringLength(llvm::Value* string) {
+	 // A negative length field marks an inline string, whose length is in the low 7 bits of the top byte
+	 llvm::Value* field = builder.CreateExtractValue(string, 1, "lenfield");
+	 llvm::Value* isInline = builder.CreateICmpSLT(field, builder.getInt64(0), "inline");
+	 llvm::Value* inlineLength = builder.CreateAnd(builder.CreateLShr(field, 56), builder.getInt64(0x7f), "inlinelen");
+	 return builder.CreateSelect(isInline, inlineLength, field, "strlen");
+ }
+
+ llvm::Value* LLVMCodeGen::emitStringBinary(const std::string& op, llvm::Value* left, llvm::Value* right, llvm::AllocaInst* stackBuffer) {
+	 llvm::Type* ptrType = llvm::PointerType::getUnqual(llvm::Type::getInt8Ty(context));
+	 if (op == "+") {
+		 llvm::Value* leftArg = emitStringArgument(left);
+		 llvm::Value* rightArg = emitStringArgument(right);
+		 llvm::AllocaInst* result = llvm_util::createEntryBlockAlloca(builder.GetInsertBlock()->getParent(), "concat", getStringType());
+		 if (stackBuffer) {
+			 // The str it is assigned to never leaves the function, so the bytes stay in its frame while they fit
+			 llvm::Type* sizeType = llvm::Type::getInt64Ty(context);
+			 llvm::Value* capacity = llvm::ConstantInt::get(sizeType, stackBuffer->getAllocatedType()->getArrayNumElements());
+			 llvm::Value* arena = !arenas.empty() ? arenas.back() : localStringArena ? localStringArena : llvm::ConstantPointerNull::get(llvm::cast<llvm::PointerType>(ptrType));
+			 llvm::FunctionCallee concat = getRuntimeFunction("ssl_str_concat_local", llvm::Type::getVoidTy(context), { ptrType, sizeType, ptrType, ptrType, ptrType, ptrType });
+			 builder.CreateCall(concat, { builder.CreatePointerCast(stackBuffer, ptrType), capacity, arena, leftArg, rightArg, result });
+		 }
+		 else if (!arenas.empty()) {
+			 // Inside an arena block the result belongs to the innermost arena
+			 llvm::FunctionCallee concat = getRuntimeFunction("ssl_str_concat_in", llvm::Type::getVoidTy(context), { ptrType, ptrType, ptrType, ptrType });
+			 builder.CreateCall(concat, { arenas.back(), leftArg, rightArg, result });
+		 }
+		 else {
+			 llvm::FunctionCallee concat = getRuntimeFunction("ssl_str_concat", llvm::Type::getVoidTy(context), { ptrType, ptrType, ptrType });
+			 builder.CreateCall(concat, { leftArg, rightArg, result });
+		 }
+		 return builder.CreateLoad(getStringType(), result, "concattmp");
+	 }
+	 if (op == "equals" || op == "notEquals") {
+		 llvm::FunctionCallee equals = getRuntimeFunction("ssl_str_equals", llvm::Type::getInt1Ty(context), { ptrType, ptrType });
+		 if (auto* func = llvm::dyn_cast<llvm::Function>(equals.getCallee())) {
+			 func->addRetAttr(llvm::Attribute::ZExt); // C 'bool' is returned zero-extended
+		 }
+		 llvm::Value* same = builder.CreateCall(equals, { emitStringArgument(left), emitStringArgument(right) }, "streq");
+		 return op == "equals" ? same : builder.CreateNot(same, "strne");
+	 }
+	 std::cerr << "Unsupported string operation: " << op << std::endl;
+	 return nullptr;
+ }
+
+ void LLVMCodeGen::createStringBuffer(const ASTNode* declaration, const std::string& name) {
+	 const EscapeAnalysis::Allocation* allocation = escapeAnalysis.find(declaration, name);
+	 // Results of up to sslStringInlineCapacity bytes are kept in the value itself and need no buffer
+	 if (!allocation || !allocation->onStack || allocation->stackBytes <= static_cast<std::uint64_t>(sslStringInlineCapacity)) {
+		 return;
+	 }
+	 llvm::Type* bufferType = llvm::ArrayType::get(llvm::Type::getInt8Ty(context), allocation->stackBytes);
+	 stringBuffers[allocation] = llvm_util::createEntryBlockAlloca(currentFunction, name + ".buf", bufferType);
+ }
+
+ llvm::Function* LLVMCodeGen::getArrayGrowFunction() {
+	 // Out-of-line slow path for add(): doubles the capacity, moving the elements from the inline
+	 // buffer to the heap the first time and using realloc after that. Traps when out of memory.
+	 if (llvm::Function* growFunction = module->getFunction("ssl.array.grow")) {
+		 return growFunction;
+	 }
+
+	 llvm::Type* ptrType = llvm::PointerType::getUnqual(llvm::Type::getInt8Ty(context));
+	 llvm::Type* sizeType = llvm::Type::getInt64Ty(context);
+	 llvm::StructType* headerType = getArrayHeaderType();
+
+	 llvm::FunctionType* growType = llvm::FunctionType::get(llvm::Type::getVoidTy(context), { ptrType, ptrType, sizeType }, false);
+	 llvm::Function* growFunction = llvm::Function::Create(growType, llvm::Function::InternalLinkage, "ssl.array.grow", module);
+	 growFunction->addFnAttr(llvm::Attribute::NoInline);
+	 growFunction->addFnAttr(llvm::Attribute::Cold);
+
+	 llvm::Argument* header = growFunction->getArg(0);
+	 llvm::Argument* inlineBuffer = growFunction->getArg(1);
+	 llvm::Argument* elementSize = growFunction->getArg(2);
+	 header->setName("header");
+	 inlineBuffer->setName("inlineBuf");
+	 elementSize->setName("elementSize");
+
+	 llvm::BasicBlock* entryBB = llvm::BasicBlock::Create(context, "entry", growFunction);
+	 llvm::BasicBlock* sizedBB = llvm::BasicBlock::Create(context, "sized", growFunction);
+	 llvm::BasicBlock* fromInlineBB = llvm::BasicBlock::Create(context, "fromInline", growFunction);
+	 llvm::BasicBlock* copyBB = llvm::BasicBlock::Create(context, "copy", growFunction);
+	 llvm::BasicBlock* fromHeapBB = llvm::BasicBlock::Create(context, "fromHeap", growFunction);
+	 llvm::BasicBlock* doneBB = llvm::BasicBlock::Create(context, "done", growFunction);
+	 llvm::BasicBlock* failBB = llvm::BasicBlock::Create(context, "outOfMemory", growFunction);
+
+	 llvm::IRBuilder<> growBuilder(entryBB);
+	 llvm::MDBuilder mdBuilder(context);
+	 llvm::Value* dataPtr = growBuilder.CreateStructGEP(headerType, header, 0, "dataPtr");
+	 llvm::Value* lenPtr = growBuilder.CreateStructGEP(headerType, header, 1, "lenPtr");
+	 llvm::Value* capPtr = growBuilder.CreateStructGEP(headerType, header, 2, "capPtr");
+	 llvm::Value* data = growBuilder.CreateLoad(ptrType, dataPtr, "data");
+	 llvm::Value* capacity = growBuilder.CreateLoad(sizeType, capPtr, "cap");
+	 // capacity * 2 * elementSize must fit in 64 bits, or the buffer would be smaller than the elements it holds
+	 llvm::Value* doubled = growBuilder.CreateIntrinsic(llvm::Intrinsic::umul_with_overflow, { sizeType }, { capacity, growBuilder.getInt64(2) }, nullptr, "doubled");
+	 llvm::Value* newCapacity = growBuilder.CreateExtractValue(doubled, 0, "newCap");
+	 llvm::Value* bytes = growBuilder.CreateIntrinsic(llvm::Intrinsic::umul_with_overflow, { sizeType }, { newCapacity, elementSize }, nullptr, "bytes");
+	 llvm::Value* newBytes = growBuilder.CreateExtractValue(bytes, 0, "newBytes");
+	 llvm::Value* overflow = growBuilder.CreateOr(growBuilder.CreateExtractValue(doubled, 1), growBuilder.CreateExtractValue(bytes, 1), "overflow");
+	 growBuilder.CreateCondBr(overflow, failBB, sizedBB, mdBuilder.createBranchWeights(1, 1 << 20));
+
+	 growBuilder.SetInsertPoint(sizedBB);
+	 llvm::Value* isInline = growBuilder.CreateICmpEQ(data, inlineBuffer, "isInline");
+	 growBuilder.CreateCondBr(isInline, fromInlineBB, fromHeapBB);
+
+	 growBuilder.SetInsertPoint(fromInlineBB);
+	 llvm::Value* heapData = growBuilder.CreateCall(mallocFunction, { newBytes }, "heapData");
+	 growBuilder.CreateCondBr(growBuilder.CreateIsNull(heapData, "mallocFailed"), failBB, copyBB, mdBuilder.createBranchWeights(1, 1 << 20));
+
+	 growBuilder.SetInsertPoint(copyBB);
+	 llvm::Value* length = growBuilder.CreateLoad(sizeType, lenPtr, "len");
+	 growBuilder.CreateMemCpy(heapData, llvm::MaybeAlign(), data, llvm::MaybeAlign(), growBuilder.CreateMul(length, elementSize, "usedBytes"));
+	 growBuilder.CreateBr(doneBB);
+
+	 growBuilder.SetInsertPoint(fromHeapBB);
+	 llvm::Value* grownData = growBuilder.CreateCall(reallocFunction, { data, newBytes }, "grownData");
+	 growBuilder.CreateCondBr(growBuilder.CreateIsNull(grownData, "reallocFailed"), failBB, doneBB, mdBuilder.createBranchWeights(1, 1 << 20));
+
+	 // Out of memory, or more elements than memory can address: stop rather than write past the buffer
+	 growBuilder.SetInsertPoint(failBB);
+	 growBuilder.CreateIntrinsic(llvm::Intrinsic::trap, {}, {});
+	 growBuilder.CreateUnreachable();
+
+	 growBuilder.SetInsertPoint(doneBB);
+	 llvm::PHINode* newData = growBuilder.CreatePHI(ptrType, 2, "newData");
+	 newData->addIncoming(heapData, copyBB);
+	 newData->addIncoming(grownData, fromHeapBB);
+	 growBuilder.CreateStore(newData, dataPtr);
+	 growBuilder.CreateStore(newCapacity, capPtr);
+	 growBuilder.CreateRetVoid();
+
+	 llvm::verifyFunction(*growFunction, &llvm::errs());
+	 return growFunction;
+ }
+
+ llvm::Function* LLVMCodeGen::getArrayFreeFunction() {
+	 // Releases an array's heap buffer, if it ever left its inline buffer. Small enough to be inlined at every scope exit.
+	 if (llvm::Function* freeArrayFunction = module->getFunction("ssl.array.free")) {
+		 return freeArrayFunction;
+	 }
+
+	 llvm::Type* ptrType = llvm::PointerType::getUnqual(llvm::Type::getInt8Ty(context));
+	 llvm::FunctionType* freeArrayType = llvm::FunctionType::get(llvm::Type::getVoidTy(context), { ptrType, ptrType }, false);
+	 llvm::Function* freeArrayFunction = llvm::Function::Create(freeArrayType, llvm::Function::InternalLinkage, "ssl.array.free", module);
+
+	 llvm::Argument* header = freeArrayFunction->getArg(0);
+	 llvm::Argument* inlineBuffer = freeArrayFunction->getArg(1);
+	 header->setName("header");
+	 inlineBuffer->setName("inlineBuf");
+
+	 llvm::BasicBlock* entryBB = llvm::BasicBlock::Create(context, "entry", freeArrayFunction);
+	 llvm::BasicBlock* releaseBB = llvm::BasicBlock::Create(context, "release", freeArrayFunction);
+	 llvm::BasicBlock* doneBB = llvm::BasicBlock::Create(context, "done", freeArrayFunction);
+
+	 llvm::IRBuilder<> freeBuilder(entryBB);
+	 llvm::Value* dataPtr = freeBuilder.CreateStructGEP(getArrayHeaderType(), header, 0, "dataPtr");
+	 llvm::Value* data = freeBuilder.CreateLoad(ptrType, dataPtr, "data");
+	 llvm::Value* isHeap = freeBuilder.CreateICmpNE(data, inlineBuffer, "isHeap");
+	 freeBuilder.CreateCondBr(isHeap, releaseBB, doneBB);
+
+	 freeBuilder.SetInsertPoint(releaseBB);
+	 freeBuilder.CreateCall(freeFunction, { data });
+	 freeBuilder.CreateBr(doneBB);
+
+	 freeBuilder.SetInsertPoint(doneBB);
+	 freeBuilder.CreateRetVoid();
+
+	 llvm::verifyFunction(*freeArrayFunction, &llvm::errs());
+	 return freeArrayFunction;
+ }
+
+ llvm::Value* LLVMCodeGen::emitVectorSlot(llvm::Value* arrayPtr, llvm::StructType* arrayType, llvm::Value* index, unsigned lanes) {
+	 // A vector access touches lanes elements at once, so all of them must be inside the array: index + lanes <= length
+	 llvm::Function* function = builder.GetInsertBlock()->getParent();
+	 llvm::Type* ptrType = llvm::PointerType::getUnqual(llvm::Type::getInt8Ty(context));
+	 llvm::Type* sizeType = llvm::Type::getInt64Ty(context);
+	 llvm::Type* elementType = arrayType->getElementType(3)->getArrayElementType();
+
+	 llvm::Value* length = builder.CreateLoad(sizeType, builder.CreateStructGEP(arrayType, arrayPtr, 1, "lenPtr"), "len");
+	 llvm::Value* wideIndex = builder.CreateSExt(index, sizeType, "idx");
+	 llvm::Value* laneCount = llvm::ConstantInt::get(sizeType, lanes);
+	 // A negative index is a huge unsigned one, so one unsigned compare covers both ends
+	 llvm::Value* tooShort = builder.CreateICmpULT(length, laneCount, "tooShort");
+	 llvm::Value* pastEnd = builder.CreateICmpUGT(wideIndex, builder.CreateSub(length, laneCount), "pastEnd");
+	 llvm::Value* outOfBounds = builder.CreateOr(tooShort, pastEnd, "outOfBounds");
+
+	 llvm::BasicBlock* trapBB = llvm::BasicBlock::Create(context, "vectorOutOfBounds", function);
+	 llvm::BasicBlock* accessBB = llvm::BasicBlock::Create(context, "vectorAccess", function);
+	 llvm::MDBuilder mdBuilder(context);
+	 builder.CreateCondBr(outOfBounds, trapBB, accessBB, mdBuilder.createBranchWeights(1, 1 << 20));
+
+	 builder.SetInsertPoint(trapBB);
+	 builder.CreateIntrinsic(llvm::Intrinsic::trap, {}, {});
+	 builder.CreateUnreachable();
+
+	 builder.SetInsertPoint(accessBB);
+	 llvm::Value* data = builder.CreateLoad(ptrType, builder.CreateStructGEP(arrayType, arrayPtr, 0, "dataPtr"), "data");
+	 return builder.CreateInBoundsGEP(elementType, data, wideIndex, "vslot");
+ }
+
+ llvm::Value* LLVMCodeGen::emitArrayAdd(llvm::Value* arrayPtr, llvm::StructType* arrayType, llvm::Value* element) {
+	 // Fast path is inline: one capacity check, a store and a length bump. Only a full array calls the grow slow path.
+	 llvm::Function* function = builder.GetInsertBlock()->getParent();
+	 llvm::Type* ptrType = llvm::PointerType::getUnqual(llvm::Type::getInt8Ty(context));
+	 llvm::Type* sizeType = llvm::Type::getInt64Ty(context);
+	 llvm::Type* elementType = arrayType->getElementType(3)->getArrayElementType();
+
+	 llvm::Value* lenPtr = builder.CreateStructGEP(arrayType, arrayPtr, 1, "lenPtr");
+	 llvm::Value* capPtr = builder.CreateStructGEP(arrayType, arrayPtr, 2, "capPtr");
+	 llvm::Value* length = builder.CreateLoad(sizeType, lenPtr, "len");
+	 llvm::Value* capacity = builder.CreateLoad(sizeType, capPtr, "cap");
+
+	 llvm::BasicBlock* growBB = llvm::BasicBlock::Create(context, "arrayGrow", function);
+	 llvm::BasicBlock* storeBB = llvm::BasicBlock::Create(context, "arrayStore", function);
+
+	 llvm::MDBuilder mdBuilder(context);
+	 llvm::Value* isFull = builder.CreateICmpUGE(length, capacity, "isFull");
+	 builder.CreateCondBr(isFull, growBB, storeBB, mdBuilder.createBranchWeights(1, 1 << 20));
+
+	 builder.SetInsertPoint(growBB);
+	 llvm::Value* inlineBuffer = builder.CreateStructGEP(arrayType, arrayPtr, 3, "inlineBuf");
+	 llvm::Value* elementSize = llvm::ConstantInt::get(sizeType, elementType->getPrimitiveSizeInBits() / 8);
+	 auto arena = arenaArrays.find(arrayPtr);
+	 if (boundedArrays.count(arrayPtr)) {
+		 // Escape analysis sized the inline buffer for every add, so this is unreachable
+		 builder.CreateIntrinsic(llvm::Intrinsic::trap, {}, {});
+	 }
+	 else if (arena != arenaArrays.end()) {
+		 // Doubles inside the arena, in place while nothing was allocated after the elements; never freed on its own
+		 llvm::Value* dataPtr = builder.CreateStructGEP(arrayType, arrayPtr, 0, "dataPtr");
+		 llvm::Value* newCapacity = builder.CreateShl(capacity, 1, "newCap");
+		 llvm::FunctionCallee resize = getRuntimeFunction("ssl_arena_resize", ptrType, { ptrType, ptrType, sizeType, sizeType });
+		 llvm::Value* newData = builder.CreateCall(resize, { arena->second, builder.CreateLoad(ptrType, dataPtr, "data"),
+			 builder.CreateMul(length, elementSize, "usedBytes"), builder.CreateMul(newCapacity, elementSize, "newBytes") }, "grownData");
+		 builder.CreateStore(newData, dataPtr);
+		 builder.CreateStore(newCapacity, capPtr);
+	 }
+	 else {
+		 builder.CreateCall(getArrayGrowFunction(), { arrayPtr, inlineBuffer, elementSize });
+	 }
+	 builder.CreateBr(storeBB);
+
+	 builder.SetInsertPoint(storeBB);
+	 llvm::Value* data = builder.CreateLoad(ptrType, builder.CreateStructGEP(arrayType, arrayPtr, 0, "dataPtr"), "data");
+	 llvm::Value* slot = builder.CreateInBoundsGEP(elementType, data, length, "slot");
+	 builder.CreateStore(element, slot);
+	 builder.CreateStore(builder.CreateNUWAdd(length, llvm::ConstantInt::get(sizeType, 1), "newLen"), lenPtr);
+	 return element;
+ }
+
+ llvm::Value* LLVMCodeGen::emitArrayRemove(llvm::Value* arrayPtr, llvm::StructType* arrayType) {
+	 // Pops the last element and evaluates to it; removing from an empty array is a no-op that yields 0.
+	 llvm::Function* function = builder.GetInsertBlock()->getParent();
+	 llvm::Type* ptrType = llvm::PointerType::getUnqual(llvm::Type::getInt8Ty(context));
+	 llvm::Type* sizeType = llvm::Type::getInt64Ty(context);
+	 llvm::Type* elementType = arrayType->getElementType(3)->getArrayElementType();
+
+	 llvm::Value* lenPtr = builder.CreateStructGEP(arrayType, arrayPtr, 1, "lenPtr");
+	 llvm::Value* length = builder.CreateLoad(sizeType, lenPtr, "len");
+	 llvm::BasicBlock* checkBB = builder.GetInsertBlock();
+	 llvm::BasicBlock* popBB = llvm::BasicBlock::Create(context, "arrayPop", function);
+	 llvm::BasicBlock* doneBB = llvm::BasicBlock::Create(context, "arrayPopDone", function);
+
+	 llvm::Value* isEmpty = builder.CreateICmpEQ(length, llvm::ConstantInt::get(sizeType, 0), "isEmpty");
+	 builder.CreateCondBr(isEmpty, doneBB, popBB);
+
+	 builder.SetInsertPoint(popBB);
+	 llvm::Value* newLength = builder.CreateSub(length, llvm::ConstantInt::get(sizeType, 1), "newLen");
+	 llvm::Value* data = builder.CreateLoad(ptrType, builder.CreateStructGEP(arrayType, arrayPtr, 0, "dataPtr"), "data");
+	 llvm::Value* removed = builder.CreateLoad(elementType, builder.CreateInBoundsGEP(elementType, data, newLength, "slot"), "removed");
+	 builder.CreateStore(newLength, lenPtr);
+	 builder.CreateBr(doneBB);
+
+	 builder.SetInsertPoint(doneBB);
+	 llvm::PHINode* result = builder.CreatePHI(elementType, 2, "popped");
+	 result->addIncoming(llvm::Constant::getNullValue(elementType), checkBB);
+	 result->addIncoming(removed, popBB);
+	 return result;
+ }
+
+ void LLVMCodeGen::emitArenaRelease(std::size_t firstIndex) {
+	 llvm::FunctionCallee exitArena = getRuntimeFunction("ssl_arena_exit", llvm::Type::getVoidTy(context), { llvm::PointerType::getUnqual(llvm::Type::getInt8Ty(context)) });
+	 for (std::size_t i = arenas.size(); i > firstIndex; --i) {
+		 builder.CreateCall(exitArena, { arenas[i - 1] });
+	 }
+ }
+
+ void LLVMCodeGen::enterLocalStringArena(const std::string& functionName) {
+	 // Only a str without a known bound can outgrow its buffer; the others never leave the frame
+	 for (const EscapeAnalysis::Allocation& allocation : escapeAnalysis.getAllocations()) {
+		 if (allocation.function == functionName && allocation.kind == "str" && allocation.onStack && !allocation.bound) {
+			 llvm::FunctionCallee enterArena = getRuntimeFunction("ssl_arena_enter", llvm::PointerType::getUnqual(llvm::Type::getInt8Ty(context)), {});
+			 localStringArena = builder.CreateCall(enterArena, {}, "strArena");
+			 return;
+		 }
+	 }
+	 localStringArena = nullptr;
+ }
+
+ void LLVMCodeGen::emitLocalStringArenaRelease() {
+	 if (localStringArena) {
+		 llvm::FunctionCallee exitArena = getRuntimeFunction("ssl_arena_exit", llvm::Type::getVoidTy(context), { llvm::PointerType::getUnqual(llvm::Type::getInt8Ty(context)) });
+		 builder.CreateCall(exitArena, { localStringArena });
+	 }
+ }
+
+ void LLVMCodeGen::emitArrayCleanup(const std::vector<llvm::Value*>& arrays, std::size_t firstIndex) {
+	 // Release in reverse declaration order, starting from the most recently declared array
+	 for (std::size_t i = arrays.size(); i > firstIndex; --i) {
+		 llvm::Value* arrayPtr = arrays[i - 1];
+		 llvm::StructType* arrayType = getArrayType(arrayPtr);
+		 llvm::Value* inlineBuffer = builder.CreateStructGEP(arrayType, arrayPtr, 3, "inlineBuf");
+		 builder.CreateCall(getArrayFreeFunction(), { arrayPtr, inlineBuffer });
+	 }
+ }
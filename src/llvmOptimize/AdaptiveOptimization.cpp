@@ -0,0 +1,159 @@
+#include <iostream>
+
+#include "llvm/ADT/StringSet.h"
+#include "llvm/Analysis/BlockFrequencyInfo.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/ProfileSummaryInfo.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/PassManager.h"
+
+#include "llvmOptimize/AdaptiveOptimization.h"
+
+namespace {
+
+const char* tierAttribute = "ssl-opt-tier";
+
+// What Reduced functions skip: the passes that cost the most on large straight-line code (InstCombine alone is
+// most of O3 on initialization code) and the vectorizers, which have nothing to do without loops
+const llvm::StringSet<> expensivePasses = {
+	"InstCombinePass", "AggressiveInstCombinePass", "CorrelatedValuePropagationPass", "JumpThreadingPass",
+	"GVNPass", "NewGVNPass", "DSEPass", "MemCpyOptPass", "ReassociatePass", "SCCPPass", "BDCEPass",
+	"ConstraintEliminationPass", "SpeculativeExecutionPass", "MergedLoadStoreMotionPass",
+	"LoopVectorizePass", "SLPVectorizerPass", "VectorCombinePass"
+};
+
+// The function a function or loop pass is about to run on; module and SCC passes are never skipped
+const llvm::Function* functionOf(const llvm::Any& ir) {
+	if (const auto* function = llvm::any_cast<const llvm::Function*>(&ir)) {
+		return *function;
+	}
+	if (const auto* loop = llvm::any_cast<const llvm::Loop*>(&ir)) {
+		return (*loop)->getHeader()->getParent();
+	}
+	return nullptr;
+}
+
+// Runs at the start of the optimization pipeline, when the profile counts are in the IR and inlining is done
+struct ProfileTierPass : llvm::PassInfoMixin<ProfileTierPass> {
+	llvm::PreservedAnalyses run(llvm::Module& module, llvm::ModuleAnalysisManager& MAM) {
+		llvm::ProfileSummaryInfo& profile = MAM.getResult<llvm::ProfileSummaryAnalysis>(module);
+		if (!profile.hasProfileSummary()) {
+			return llvm::PreservedAnalyses::all();
+		}
+		llvm::FunctionAnalysisManager& FAM = MAM.getResult<llvm::FunctionAnalysisManagerModuleProxy>(module).getManager();
+
+		unsigned promoted = 0, demoted = 0;
+		for (llvm::Function& function : module) {
+			if (function.isDeclaration()) {
+				continue;
+			}
+			// The profile of one run does not override @hot or @cold. Profile use marks the functions it finds
+			// cold with the same attribute, which only ever agrees with demoting them
+			AdaptiveOptimization::Tier tier = AdaptiveOptimization::tierOf(function);
+			llvm::BlockFrequencyInfo& frequencies = FAM.getResult<llvm::BlockFrequencyAnalysis>(function);
+			if (tier != AdaptiveOptimization::Tier::Full && !function.hasFnAttribute(llvm::Attribute::Cold)
+				&& profile.isFunctionHotInCallGraph(&function, frequencies)) {
+				AdaptiveOptimization::apply(function, AdaptiveOptimization::Tier::Full);
+				++promoted;
+			}
+			else if (tier != AdaptiveOptimization::Tier::Minimal && !function.hasFnAttribute(llvm::Attribute::Hot)
+				&& !function.hasFnAttribute(llvm::Attribute::AlwaysInline) && profile.isFunctionColdInCallGraph(&function, frequencies)) {
+				AdaptiveOptimization::apply(function, AdaptiveOptimization::Tier::Minimal);
+				++demoted;
+			}
+		}
+		std::cout << "Profile moved " << promoted << " functions to the full pipeline and " << demoted << " to optnone" << std::endl;
+		return promoted || demoted ? llvm::PreservedAnalyses::none() : llvm::PreservedAnalyses::all();
+	}
+};
+
+}
+
+AdaptiveOptimization::Tier AdaptiveOptimization::classify(const llvm::Function& function) {
+	if (function.hasFnAttribute(llvm::Attribute::Hot)) {
+		return Tier::Full;
+	}
+	// optnone requires noinline, which @inline functions can't have
+	if (function.hasFnAttribute(llvm::Attribute::Cold)) {
+		return function.hasFnAttribute(llvm::Attribute::AlwaysInline) ? Tier::Reduced : Tier::Minimal;
+	}
+
+	// Any loop may be a hot kernel, however large the function
+	llvm::DominatorTree dominators(const_cast<llvm::Function&>(function));
+	llvm::LoopInfo loops(dominators);
+	if (!loops.empty()) {
+		return Tier::Full;
+	}
+	return function.getInstructionCount() > hugeFunctionInstructions ? Tier::Reduced : Tier::Full;
+}
+
+AdaptiveOptimization::Tier AdaptiveOptimization::tierOf(const llvm::Function& function) {
+	if (function.hasOptNone()) {
+		return Tier::Minimal;
+	}
+	return function.getFnAttribute(tierAttribute).getValueAsString() == "reduced" ? Tier::Reduced : Tier::Full;
+}
+
+void AdaptiveOptimization::apply(llvm::Function& function, Tier tier) {
+	if (tierOf(function) == Tier::Reduced && !function.hasFnAttribute(llvm::Attribute::Cold)) {
+		function.removeFnAttr(llvm::Attribute::OptimizeForSize);
+	}
+	switch (tier) {
+	case Tier::Full:
+		function.addFnAttr(tierAttribute, "full");
+		break;
+	case Tier::Reduced:
+		function.addFnAttr(tierAttribute, "reduced");
+		function.addFnAttr(llvm::Attribute::OptimizeForSize);
+		break;
+	case Tier::Minimal:
+		// The verifier rejects optnone together with a size attribute or without noinline
+		function.addFnAttr(tierAttribute, "minimal");
+		function.removeFnAttr(llvm::Attribute::MinSize);
+		function.removeFnAttr(llvm::Attribute::OptimizeForSize);
+		function.addFnAttr(llvm::Attribute::OptimizeNone);
+		function.addFnAttr(llvm::Attribute::NoInline);
+		break;
+	}
+}
+
+void AdaptiveOptimization::classifyModule(llvm::Module& module) {
+	unsigned counts[3] = { 0, 0, 0 };
+	for (llvm::Function& function : module) {
+		if (function.isDeclaration() || function.hasFnAttribute(tierAttribute)) {
+			continue;
+		}
+		Tier tier = classify(function);
+		apply(function, tier);
+		++counts[static_cast<int>(tier)];
+	}
+	// The partitions of --jobs were classified as one module
+	if (counts[0] + counts[1] + counts[2] == 0) {
+		return;
+	}
+	std::cout << "Adaptive optimization: " << counts[0] << " functions get the full pipeline, " << counts[1]
+		<< " only the cleanups and " << counts[2] << " are left unoptimized" << std::endl;
+}
+
+void AdaptiveOptimization::registerCallbacks(llvm::PassInstrumentationCallbacks& callbacks) {
+	callbacks.registerShouldRunOptionalPassCallback([](llvm::StringRef pass, llvm::Any ir) {
+		const llvm::Function* function = functionOf(ir);
+		if (!function) {
+			return true;
+		}
+		switch (tierOf(*function)) {
+		case Tier::Minimal:
+			return false;
+		case Tier::Reduced:
+			return !expensivePasses.contains(pass);
+		default:
+			return true;
+		}
+	});
+}
+
+void AdaptiveOptimization::registerProfilePolicy(llvm::PassBuilder& builder) {
+	builder.registerOptimizerEarlyEPCallback([](llvm::ModulePassManager& MPM, llvm::OptimizationLevel) {
+		MPM.addPass(ProfileTierPass());
+	});
+}
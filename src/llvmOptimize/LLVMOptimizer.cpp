@@ -9,46 +9,262 @@
 #include "llvm/Passes/PassBuilder.h"
 #include "llvm/Passes/OptimizationLevel.h"
 #include "llvm/IR/Verifier.h"
+#include "llvm/ProfileData/InstrProfReader.h"
+#include "llvm/ProfileData/InstrProfWriter.h"
+#include "llvm/Support/PGOOptions.h"
+#include "llvm/Support/VirtualFileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetMachine.h"
 
+#include "llvmOptimize/AdaptiveOptimization.h"
 #include "llvmOptimize/LLVMOptimizer.h"
+#include "llvmOptimize/LogCoalescing.h"
+#include "llvmOptimize/OptimizationRemarks.h"
+#include "llvmOptimize/OptimizationReport.h"
 
-void LLVMOptimizer::optimize(llvm::Module* module) {
+#include <chrono>
+#include <filesystem>
+#include <optional>
+#include <vector>
 
-	if (!module) {
-		std::cerr << "Optimization aborted: module pointer is null." << std::endl;
-		return;
-	}
+// O0 has nothing to take away
+static bool adaptiveFor(const OptimizationOptions& options) {
+	return options.adaptive && options.level != llvm::OptimizationLevel::O0;
+}
 
-	llvm::LoopAnalysisManager LAM;
-	llvm::FunctionAnalysisManager FAM;
-	llvm::CGSCCAnalysisManager CGAM;
-	llvm::ModuleAnalysisManager MAM;
+OptimizationPasses::OptimizationPasses(const OptimizationOptions& options)
+	: profileGenerateDir(options.profileGenerateDir), profileUseFile(options.profileUseFile), report(options.report), adaptive(adaptiveFor(options)), targetMachine(options.targetMachine) {
 
 	std::cerr << "Initializing pass managers..." << std::endl;
 
-	llvm::PassBuilder PB;
+	// Profile guided optimization: the pipeline either instruments the program or reads its profile
+	// for branch weights, inlining and block layout
+	std::optional<llvm::PGOOptions> pgoOptions;
+	if (!profileGenerateDir.empty()) {
+		// %m merges the counts of every run of the same binary into one file
+		std::string rawProfile = (std::filesystem::path(profileGenerateDir) / "default_%m.profraw").string();
+		pgoOptions = llvm::PGOOptions(rawProfile, "", "", "", llvm::vfs::getRealFileSystem(), llvm::PGOOptions::IRInstr);
+		std::cout << "Instrumenting for profiles in " << profileGenerateDir << std::endl;
+	}
+	else if (!profileUseFile.empty()) {
+		std::string profile = profileUseFile;
+		if (std::filesystem::path(profileUseFile).extension() != ".profdata") {
+			profile = LLVMOptimizer::mergeProfiles(profileUseFile);
+		}
+		pgoOptions = llvm::PGOOptions(profile, "", "", "", llvm::vfs::getRealFileSystem(), llvm::PGOOptions::IRUse);
+		std::cout << "Optimizing with profile " << profile << std::endl;
+	}
+
+	// Only --opt-report and --adaptive-opt hook into the passes; without them the pipeline runs uninstrumented
+	if (report) {
+		report->registerCallbacks(PIC);
+	}
+	if (adaptive) {
+		AdaptiveOptimization::registerCallbacks(PIC);
+	}
+
+	PB = std::make_unique<llvm::PassBuilder>(targetMachine, llvm::PipelineTuningOptions(), pgoOptions, report || adaptive ? &PIC : nullptr);
+	if (adaptive && !profileUseFile.empty()) {
+		AdaptiveOptimization::registerProfilePolicy(*PB);
+	}
+
+	// log() calls are merged once the values they print are as simplified as they get; O0 keeps one call per log()
+	PB->registerOptimizerLastEPCallback([](llvm::ModulePassManager& MPM, llvm::OptimizationLevel level) {
+		if (level != llvm::OptimizationLevel::O0) {
+			MPM.addPass(llvm::createModuleToFunctionPassAdaptor(LogCoalescingPass()));
+		}
+	});
+	PB->registerPipelineParsingCallback([](llvm::StringRef name, llvm::FunctionPassManager& FPM, llvm::ArrayRef<llvm::PassBuilder::PipelineElement>) {
+		if (name == "ssl-log-coalesce") {
+			FPM.addPass(LogCoalescingPass());
+			return true;
+		}
+		return false;
+	});
 
 	std::cout << "Initializing pass builder..." << std::endl;
 
 	// Register all the basic analyses with the managers.
-	PB.registerModuleAnalyses(MAM);
-	PB.registerCGSCCAnalyses(CGAM);
-	PB.registerFunctionAnalyses(FAM);
-	PB.registerLoopAnalyses(LAM);
-	PB.crossRegisterProxies(LAM, FAM, CGAM, MAM);
+	PB->registerModuleAnalyses(MAM);
+	PB->registerCGSCCAnalyses(CGAM);
+	PB->registerFunctionAnalyses(FAM);
+	PB->registerLoopAnalyses(LAM);
+	PB->crossRegisterProxies(LAM, FAM, CGAM, MAM);
 
 	std::cout << "Registering analyses..." << std::endl;
+}
+
+bool OptimizationPasses::builtFor(const OptimizationOptions& options) const {
+	return options.profileGenerateDir == profileGenerateDir && options.profileUseFile == profileUseFile
+		&& options.report == report && adaptiveFor(options) == adaptive && options.targetMachine == targetMachine;
+}
 
-	llvm::ModulePassManager MPM = PB.buildPerModuleDefaultPipeline(llvm::OptimizationLevel::O3);
+void OptimizationPasses::clear() {
+	// The results are keyed by the address of the IR they are about, which the next module may reuse
+	LAM.clear();
+	FAM.clear();
+	CGAM.clear();
+	MAM.clear();
+}
 
-	std::cout << "Building default pipeline..." << std::endl;
+void LLVMOptimizer::optimize(llvm::Module* module, const OptimizationOptions& options, OptimizationPasses* passes) {
+
+	if (!module) {
+		std::cerr << "Optimization aborted: module pointer is null." << std::endl;
+		return;
+	}
+
+	const std::string& profileGenerateDir = options.profileGenerateDir;
+	const std::string& profileUseFile = options.profileUseFile;
+	if (!profileGenerateDir.empty() && !profileUseFile.empty()) {
+		throw std::runtime_error("--profile-generate and --profile-use cannot be combined.");
+	}
+	if (!options.passes.empty() && (options.ltoPreLink || options.thinLTOPreLink || !profileGenerateDir.empty() || !profileUseFile.empty())) {
+		throw std::runtime_error("--passes replaces the whole pipeline and cannot be combined with --lto-prelink, --thin-lto or profiles.");
+	}
+	if (options.ltoPreLink && options.thinLTOPreLink) {
+		throw std::runtime_error("--lto-prelink and --thin-lto cannot be combined.");
+	}
+	if (options.adaptive && !options.passes.empty()) {
+		throw std::runtime_error("--adaptive-opt tiers the default pipelines and cannot be combined with --passes.");
+	}
+	// The cost model would plan with a data layout the module does not have
+	if (options.targetMachine && module->getTargetTriple() != options.targetMachine->getTargetTriple().str()) {
+		throw std::runtime_error("The module is not set up for the optimizer's target machine; call GenerateOBJ::setTarget first.");
+	}
+	bool adaptive = adaptiveFor(options);
+
+	// Without a session's passes, or with ones built for other options, they only live for this module
+	std::optional<OptimizationPasses> ownPasses;
+	if (!passes || !passes->builtFor(options)) {
+		passes = &ownPasses.emplace(options);
+	}
+	llvm::PassBuilder& PB = *passes->PB;
+
+	// O0 only runs the passes the code needs to be correct (always_inline, PGO instrumentation); the
+	// LTO pre-link pipeline leaves inlining and the loop optimizations to the link step, the ThinLTO
+	// one inlines within the module and leaves the rest to the backends that run after imports
+	llvm::ModulePassManager MPM;
+	if (!options.passes.empty()) {
+		if (llvm::Error error = PB.parsePassPipeline(MPM, options.passes)) {
+			throw std::runtime_error("Invalid pass pipeline '" + options.passes + "': " + llvm::toString(std::move(error)));
+		}
+		std::cout << "Building pipeline " << options.passes << std::endl;
+	}
+	else if (options.level == llvm::OptimizationLevel::O0) {
+		MPM = PB.buildO0DefaultPipeline(options.level, options.ltoPreLink || options.thinLTOPreLink);
+		std::cout << "Building O0 pipeline..." << std::endl;
+	}
+	else if (options.thinLTOPreLink) {
+		MPM = PB.buildThinLTOPreLinkDefaultPipeline(options.level);
+		std::cout << "Building ThinLTO pre-link pipeline..." << std::endl;
+	}
+	else if (options.part == OptimizationOptions::PipelinePart::Simplification && !options.ltoPreLink) {
+		MPM = PB.buildModuleSimplificationPipeline(options.level, llvm::ThinOrFullLTOPhase::None);
+		std::cout << "Building module simplification pipeline..." << std::endl;
+	}
+	else if (options.part == OptimizationOptions::PipelinePart::Optimization && !options.ltoPreLink) {
+		MPM = PB.buildModuleOptimizationPipeline(options.level, llvm::ThinOrFullLTOPhase::None);
+		std::cout << "Building module optimization pipeline..." << std::endl;
+	}
+	else if (options.ltoPreLink) {
+		MPM = PB.buildLTOPreLinkDefaultPipeline(options.level);
+		std::cout << "Building LTO pre-link pipeline..." << std::endl;
+	}
+	else {
+		MPM = PB.buildPerModuleDefaultPipeline(options.level);
+		std::cout << "Building default pipeline..." << std::endl;
+	}
 
 	if (llvm::verifyModule(*module, &llvm::errs())) {
 		throw std::runtime_error("Module verification failed, cannot optimize.");
 	}
 
+	if (adaptive) {
+		AdaptiveOptimization::classifyModule(*module);
+	}
+
+	// Remarks go through the module's context, which only builds them for the passes its handler asks for
+	if (options.remarks) {
+		options.remarks->attach(module->getContext());
+	}
+
 	// Optimize the IR!
-	MPM.run(*module, MAM);
+	auto start = std::chrono::steady_clock::now();
+	MPM.run(*module, passes->MAM);
+	passes->clear();
+	auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+	std::cout << "Optimization complete in " << elapsed.count() << " ms." << std::endl;
+}
+
+std::optional<llvm::OptimizationLevel> LLVMOptimizer::parseLevel(const std::string& flag) {
+	if (flag == "-O0") return llvm::OptimizationLevel::O0;
+	if (flag == "-O1") return llvm::OptimizationLevel::O1;
+	if (flag == "-O2") return llvm::OptimizationLevel::O2;
+	if (flag == "-O3") return llvm::OptimizationLevel::O3;
+	if (flag == "-Os") return llvm::OptimizationLevel::Os;
+	if (flag == "-Oz") return llvm::OptimizationLevel::Oz;
+	return std::nullopt;
+}
+
+std::string LLVMOptimizer::mergeProfiles(const std::string& rawProfiles) {
+	std::filesystem::path path = std::filesystem::path(rawProfiles).lexically_normal();
+	if (!path.has_filename()) {
+		path = path.parent_path(); // "profiles/"
+	}
+	std::vector<std::filesystem::path> inputs;
+
+	if (std::filesystem::is_directory(path)) {
+		for (const auto& entry : std::filesystem::directory_iterator(path)) {
+			if (entry.path().extension() == ".profraw") {
+				inputs.push_back(entry.path());
+			}
+		}
+	}
+	else {
+		inputs.push_back(path);
+	}
+	// Build output goes to genObjectFile, not into the profile directory: "profiles" becomes genObjectFile/profiles.profdata
+	std::filesystem::path merged = std::filesystem::path("genObjectFile") / path.filename();
+	merged.replace_extension(".profdata");
+
+	if (inputs.empty()) {
+		throw std::runtime_error("No .profraw files found in " + rawProfiles);
+	}
+
+	// Same as llvm-profdata merge: counts of every input are added together
+	llvm::InstrProfWriter writer;
+	for (const auto& input : inputs) {
+		auto readerOrError = llvm::InstrProfReader::create(input.string(), *llvm::vfs::getRealFileSystem());
+		if (!readerOrError) {
+			throw std::runtime_error("Could not read profile " + input.string() + ": " + llvm::toString(readerOrError.takeError()));
+		}
+		std::unique_ptr<llvm::InstrProfReader> reader = std::move(*readerOrError);
+
+		if (llvm::Error error = writer.mergeProfileKind(reader->getProfileKind())) {
+			throw std::runtime_error("Could not merge profile " + input.string() + ": " + llvm::toString(std::move(error)));
+		}
+		for (llvm::NamedInstrProfRecord& record : *reader) {
+			writer.addRecord(std::move(record), 1, [&input](llvm::Error error) {
+				std::cerr << "Warning while merging " << input.string() << ": " << llvm::toString(std::move(error)) << std::endl;
+			});
+		}
+		if (reader->hasError()) {
+			throw std::runtime_error("Could not read profile " + input.string() + ": " + llvm::toString(reader->getError()));
+		}
+	}
+
+	std::error_code EC;
+	std::filesystem::create_directories(merged.parent_path(), EC);
+	llvm::raw_fd_ostream output(merged.string(), EC, llvm::sys::fs::OF_None);
+	if (EC) {
+		throw std::runtime_error("Could not open " + merged.string() + " for writing the merged profile: " + EC.message());
+	}
+	if (llvm::Error error = writer.write(output)) {
+		throw std::runtime_error("Could not write merged profile " + merged.string() + ": " + llvm::toString(std::move(error)));
+	}
 
-	std::cout << "Optimization complete." << std::endl;
-}
\ No newline at end of file
+	std::cout << "Merged " << inputs.size() << " raw profile(s) into " << merged.string() << std::endl;
+	return merged.string();
+}
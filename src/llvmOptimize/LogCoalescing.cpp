@@ -0,0 +1,295 @@
+#include <charconv>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/Module.h"
+
+#include "llvmOptimize/LogCoalescing.h"
+
+namespace {
+
+// The runtime functions log() calls, one per type of value
+const char* const logFunctions[] = { "ssl_log_i32", "ssl_log_i64", "ssl_log_f32", "ssl_log_f64", "ssl_log_bool", "ssl_log_str" };
+
+llvm::CallInst* logCall(llvm::Instruction& instruction) {
+	auto* call = llvm::dyn_cast<llvm::CallInst>(&instruction);
+	const llvm::Function* callee = call ? call->getCalledFunction() : nullptr;
+	if (!callee || call->arg_size() != 1) {
+		return nullptr;
+	}
+	for (const char* name : logFunctions) {
+		if (callee->getName() == name) {
+			return call;
+		}
+	}
+	return nullptr;
+}
+
+bool logsStr(const llvm::CallInst& call) {
+	return call.getCalledFunction()->getName() == "ssl_log_str";
+}
+
+// The stack slot LLVMCodeGen passes a str to ssl_log_str in, if the slot is only ever stored to and logged
+llvm::AllocaInst* logSlot(llvm::Value* argument) {
+	auto* slot = llvm::dyn_cast<llvm::AllocaInst>(argument);
+	if (!slot) {
+		return nullptr;
+	}
+	std::vector<llvm::Value*> pointers = { slot };
+	while (!pointers.empty()) {
+		llvm::Value* pointer = pointers.back();
+		pointers.pop_back();
+		for (llvm::User* user : pointer->users()) {
+			if (auto* store = llvm::dyn_cast<llvm::StoreInst>(user)) {
+				if (store->getValueOperand() == pointer) {
+					return nullptr;
+				}
+			}
+			else if (auto* gep = llvm::dyn_cast<llvm::GetElementPtrInst>(user)) {
+				pointers.push_back(gep);
+			}
+			else if (llvm::isa<llvm::LifetimeIntrinsic>(user)) {
+				continue;
+			}
+			else if (auto* call = llvm::dyn_cast<llvm::CallInst>(user); !call || !logCall(*call) || !logsStr(*call)) {
+				return nullptr;
+			}
+		}
+	}
+	return slot;
+}
+
+// The text of a str literal, when the stores right before call put a constant into its slot
+bool constantString(llvm::CallInst* call, llvm::AllocaInst* slot, std::string& text) {
+	const llvm::DataLayout& layout = call->getModule()->getDataLayout();
+	llvm::Constant* data = nullptr;
+	llvm::ConstantInt* length = nullptr;
+	for (llvm::Instruction* instruction = call->getPrevNode(); instruction && !(data && length); instruction = instruction->getPrevNode()) {
+		if (auto* store = llvm::dyn_cast<llvm::StoreInst>(instruction)) {
+			llvm::APInt offset(layout.getIndexTypeSizeInBits(store->getPointerOperandType()), 0);
+			if (store->getPointerOperand()->stripAndAccumulateConstantOffsets(layout, offset, true) != slot) {
+				continue;
+			}
+			// Either the whole {data, length} pair at once, as LLVMCodeGen stores it, or field by field once SROA split it
+			llvm::Value* value = store->getValueOperand();
+			if (auto* string = llvm::dyn_cast<llvm::ConstantStruct>(value); string && offset == 0) {
+				data = data ? data : string->getAggregateElement(0u);
+				length = length ? length : llvm::dyn_cast<llvm::ConstantInt>(string->getAggregateElement(1u));
+				break;
+			}
+			// Any other store into the slot, or a field that isn't constant, means it doesn't hold the literal
+			if (offset == 0 && value->getType()->isPointerTy() && !data) {
+				data = llvm::dyn_cast<llvm::Constant>(value);
+				if (!data) {
+					return false;
+				}
+			}
+			else if (offset == 8 && value->getType()->isIntegerTy(64) && !length) {
+				length = llvm::dyn_cast<llvm::ConstantInt>(value);
+				if (!length) {
+					return false;
+				}
+			}
+			else {
+				return false;
+			}
+			continue;
+		}
+		if (instruction->mayWriteToMemory() && !llvm::isa<llvm::LifetimeIntrinsic>(instruction) && !logCall(*instruction)) {
+			return false;
+		}
+	}
+	// A negative length is a str built at run time with its bytes inline, never a literal
+	if (!data || !length || length->isNegative()) {
+		return false;
+	}
+	std::uint64_t size = length->getZExtValue();
+	if (size == 0) {
+		text.clear();
+		return true;
+	}
+	llvm::APInt offset(layout.getIndexTypeSizeInBits(data->getType()), 0);
+	auto* global = llvm::dyn_cast<llvm::GlobalVariable>(data->stripAndAccumulateConstantOffsets(layout, offset, true));
+	if (!global || !global->isConstant() || !global->hasDefinitiveInitializer()) {
+		return false;
+	}
+	auto* bytes = llvm::dyn_cast<llvm::ConstantDataSequential>(global->getInitializer());
+	if (!bytes || !bytes->getElementType()->isIntegerTy(8) || offset.isNegative() || offset.getZExtValue() + size > bytes->getNumElements()) {
+		return false;
+	}
+	text = bytes->getRawDataValues().substr(offset.getZExtValue(), size).str();
+	return true;
+}
+
+// Formatted exactly as the runtime would: ints in decimal, flts and dbls with 6 decimals
+std::string formatConstant(llvm::Constant* value) {
+	char buffer[330];
+	char* end = buffer;
+	if (auto* integer = llvm::dyn_cast<llvm::ConstantInt>(value)) {
+		if (integer->getType()->isIntegerTy(1)) {
+			return integer->isZero() ? "false" : "true";
+		}
+		end = std::to_chars(buffer, buffer + sizeof(buffer), integer->getSExtValue()).ptr;
+	}
+	else if (auto* real = llvm::dyn_cast<llvm::ConstantFP>(value)) {
+		double number = real->getType()->isFloatTy() ? static_cast<double>(real->getValueAPF().convertToFloat()) : real->getValueAPF().convertToDouble();
+		end = std::to_chars(buffer, buffer + sizeof(buffer), number, std::chars_format::fixed, 6).ptr;
+	}
+	return std::string(buffer, end);
+}
+
+// A log() call whose output is known at compile time, and the slot of the str literal it logs
+struct ConstantLog {
+	llvm::CallInst* call;
+	llvm::AllocaInst* slot;
+	std::string text;
+};
+
+bool constantLog(llvm::CallInst* call, ConstantLog& log) {
+	llvm::Value* value = call->getArgOperand(0);
+	log = { call, nullptr, "" };
+	if (logsStr(*call)) {
+		log.slot = logSlot(value);
+		return log.slot && constantString(call, log.slot, log.text);
+	}
+	if (llvm::isa<llvm::ConstantInt>(value) || llvm::isa<llvm::ConstantFP>(value)) {
+		log.text = formatConstant(llvm::cast<llvm::Constant>(value));
+		return true;
+	}
+	return false;
+}
+
+// Replaces run with one ssl_log_str call of a constant str holding all of its lines, where the last call was.
+// Returns the calls removed; the slots of the str literals in run are added to foldedSlots
+unsigned coalesce(std::vector<ConstantLog>& run, std::vector<llvm::AllocaInst*>& foldedSlots) {
+	// A lone str literal is printed this way already
+	if (run.empty() || (run.size() == 1 && run.front().slot)) {
+		run.clear();
+		return 0;
+	}
+
+	// ssl_log_str ends the last line
+	std::string text;
+	for (const ConstantLog& log : run) {
+		text += log.text;
+		text += '\n';
+		if (log.slot) {
+			foldedSlots.push_back(log.slot);
+		}
+	}
+	text.pop_back();
+
+	llvm::CallInst* last = run.back().call;
+	llvm::Module* module = last->getModule();
+	llvm::LLVMContext& context = module->getContext();
+	llvm::Type* lengthType = llvm::Type::getInt64Ty(context);
+
+	llvm::Constant* bytes = llvm::ConstantDataArray::getString(context, text, false);
+	auto* data = new llvm::GlobalVariable(*module, bytes->getType(), true, llvm::GlobalValue::PrivateLinkage, bytes, "logtext");
+	data->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
+	data->setAlignment(llvm::MaybeAlign(1));
+	llvm::StructType* stringType = llvm::StructType::get(context, { data->getType(), lengthType });
+	llvm::Constant* value = llvm::ConstantStruct::get(stringType, { data, llvm::ConstantInt::get(lengthType, text.size()) });
+	auto* string = new llvm::GlobalVariable(*module, stringType, true, llvm::GlobalValue::PrivateLinkage, value, "logstr");
+	string->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
+
+	llvm::FunctionCallee logStr = module->getOrInsertFunction("ssl_log_str", llvm::FunctionType::get(llvm::Type::getVoidTy(context), { string->getType() }, false));
+	llvm::CallInst* merged = llvm::CallInst::Create(logStr, { string }, "", last);
+	merged->setDebugLoc(last->getDebugLoc());
+
+	unsigned removed = run.size();
+	for (ConstantLog& log : run) {
+		log.call->eraseFromParent();
+	}
+	run.clear();
+
+	return removed;
+}
+
+// Removes the slots of folded str literals that are now only stored to
+void eraseFoldedSlots(const std::vector<llvm::AllocaInst*>& foldedSlots) {
+	llvm::SmallPtrSet<llvm::AllocaInst*, 8> erased;
+	for (llvm::AllocaInst* slot : foldedSlots) {
+		if (erased.count(slot)) {
+			continue;
+		}
+		std::vector<llvm::Instruction*> users;
+		std::vector<llvm::Instruction*> pointers = { slot };
+		bool onlyStored = true;
+		for (std::size_t i = 0; i < pointers.size() && onlyStored; ++i) {
+			for (llvm::User* user : pointers[i]->users()) {
+				auto* instruction = llvm::cast<llvm::Instruction>(user);
+				if (llvm::isa<llvm::GetElementPtrInst>(instruction)) {
+					pointers.push_back(instruction);
+				}
+				else if (llvm::isa<llvm::StoreInst>(instruction) || llvm::isa<llvm::LifetimeIntrinsic>(instruction)) {
+					users.push_back(instruction);
+				}
+				else {
+					onlyStored = false;
+				}
+			}
+		}
+		if (!onlyStored) {
+			continue;
+		}
+		for (llvm::Instruction* user : users) {
+			user->eraseFromParent();
+		}
+		for (auto pointer = pointers.rbegin(); pointer != pointers.rend(); ++pointer) {
+			(*pointer)->eraseFromParent();
+		}
+		erased.insert(slot);
+	}
+}
+
+// Whether instruction may print, so the lines logged before it can't wait for the merged call
+bool mayPrint(const llvm::Instruction& instruction) {
+	if (!llvm::isa<llvm::CallBase>(instruction) || llvm::isa<llvm::LifetimeIntrinsic>(instruction)) {
+		return false;
+	}
+	return instruction.mayWriteToMemory() || instruction.mayHaveSideEffects();
+}
+
+}
+
+llvm::PreservedAnalyses LogCoalescingPass::run(llvm::Function& function, llvm::FunctionAnalysisManager&) {
+	unsigned removed = 0, merged = 0;
+	std::vector<llvm::AllocaInst*> foldedSlots;
+	for (llvm::BasicBlock& block : function) {
+		std::vector<ConstantLog> run;
+		auto finish = [&] {
+			if (unsigned count = coalesce(run, foldedSlots)) {
+				removed += count;
+				++merged;
+			}
+		};
+		for (llvm::Instruction& instruction : llvm::make_early_inc_range(block)) {
+			llvm::CallInst* call = logCall(instruction);
+			ConstantLog log;
+			if (call && constantLog(call, log)) {
+				run.push_back(log);
+			}
+			// A value only known at run time is printed by its own call, in order
+			else if (call || mayPrint(instruction)) {
+				finish();
+			}
+		}
+		finish();
+	}
+	if (merged == 0) {
+		return llvm::PreservedAnalyses::all();
+	}
+	// Only now, as a slot may be stored to further down a block that was being walked
+	eraseFoldedSlots(foldedSlots);
+	std::cout << "Coalesced " << removed << " log calls into " << merged << " in " << function.getName().str() << std::endl;
+	llvm::PreservedAnalyses preserved;
+	preserved.preserveSet<llvm::CFGAnalyses>();
+	return preserved;
+}
@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <tuple>
+
+#include "llvm/IR/DiagnosticHandler.h"
+#include "llvm/IR/Function.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "llvmOptimize/OptimizationRemarks.h"
+
+namespace {
+
+// Takes every optimization remark of its context; other diagnostics are still printed the default way
+class RemarkHandler : public llvm::DiagnosticHandler {
+public:
+	explicit RemarkHandler(OptimizationRemarks& remarks) : remarks(remarks) {}
+
+	bool handleDiagnostics(const llvm::DiagnosticInfo& info) override {
+		const auto* remark = llvm::dyn_cast<llvm::DiagnosticInfoOptimizationBase>(&info);
+		if (!remark) {
+			return false;
+		}
+		if (OptimizationRemarks::isCollected(remark->getPassName())) {
+			remarks.add(*remark);
+		}
+		return true;
+	}
+
+	// Passes only build a remark when it is enabled, so these decide which passes pay for them
+	bool isAnalysisRemarkEnabled(llvm::StringRef pass) const override { return OptimizationRemarks::isCollected(pass); }
+	bool isMissedOptRemarkEnabled(llvm::StringRef pass) const override { return OptimizationRemarks::isCollected(pass); }
+	bool isPassedOptRemarkEnabled(llvm::StringRef pass) const override { return OptimizationRemarks::isCollected(pass); }
+	bool isAnyRemarkEnabled() const override { return true; }
+
+private:
+	OptimizationRemarks& remarks;
+};
+
+// A YAML single-quoted scalar, in which only the quote itself needs escaping
+std::string quoted(const std::string& text) {
+	std::string result = "'";
+	for (char c : text) {
+		result += c;
+		if (c == '\'') {
+			result += '\'';
+		}
+	}
+	return result + "'";
+}
+
+}
+
+bool OptimizationRemarks::isCollected(llvm::StringRef pass) {
+	// The loop vectorizer reports why a loop with vectorize(enable) metadata was not vectorized without a pass name
+	return pass.empty() || pass == "loop-vectorize" || pass == "slp-vectorizer" || pass == "inline" || pass == "licm" || pass == "gvn";
+}
+
+void OptimizationRemarks::attach(llvm::LLVMContext& context) {
+	context.setDiagnosticHandler(std::make_unique<RemarkHandler>(*this));
+}
+
+void OptimizationRemarks::add(const llvm::DiagnosticInfoOptimizationBase& remark) {
+	Remark entry;
+	entry.kind = remark.isPassed() ? "Passed" : remark.isMissed() ? "Missed" : "Analysis";
+	entry.pass = remark.getPassName().empty() ? "loop-vectorize" : remark.getPassName().str();
+	entry.name = remark.getRemarkName().str();
+	entry.function = remark.getFunction().getName().str();
+	const llvm::DiagnosticLocation& location = remark.getLocation();
+	if (location.isValid()) {
+		entry.file = location.getRelativePath().str();
+		entry.line = location.getLine();
+		entry.column = location.getColumn();
+	}
+	entry.message = remark.getMsg();
+
+	std::lock_guard<std::mutex> guard(lock);
+	remarks.push_back(std::move(entry));
+}
+
+bool OptimizationRemarks::writeYAML(const std::string& path) const {
+	std::error_code EC;
+	llvm::raw_fd_ostream output(path, EC, llvm::sys::fs::OF_Text);
+	if (EC) {
+		std::cerr << "Could not open " << path << " for the optimization remarks: " << EC.message() << std::endl;
+		return false;
+	}
+
+	std::lock_guard<std::mutex> guard(lock);
+	for (const Remark& remark : remarks) {
+		output << "--- !" << remark.kind << "\n";
+		output << "Pass:            " << quoted(remark.pass) << "\n";
+		output << "Name:            " << quoted(remark.name) << "\n";
+		if (!remark.file.empty()) {
+			output << "DebugLoc:        { File: " << quoted(remark.file) << ", Line: " << remark.line << ", Column: " << remark.column << " }\n";
+		}
+		output << "Function:        " << quoted(remark.function) << "\n";
+		output << "Args:\n";
+		output << "  - String:          " << quoted(remark.message) << "\n";
+		output << "...\n";
+	}
+
+	std::cout << remarks.size() << " optimization remarks were written to " << path << std::endl;
+	return true;
+}
+
+std::string OptimizationRemarks::explain() const {
+	std::lock_guard<std::mutex> guard(lock);
+
+	// A loop or a call is often reported once per pass run or per inlined copy; each remark is listed once, with a count.
+	// Within a function, remarks are ordered by line, and on a line what was missed comes before why and what was done
+	using Key = std::tuple<std::string, std::string, unsigned, unsigned, int, std::string, std::string>;
+	std::map<Key, unsigned> unique;
+	unsigned passed = 0, missed = 0, analysis = 0;
+	for (const Remark& remark : remarks) {
+		(remark.kind == "Passed" ? passed : remark.kind == "Missed" ? missed : analysis)++;
+		// The array and str helpers the code generator adds are not SSL source anyone can change
+		if (llvm::StringRef(remark.function).starts_with("ssl.")) {
+			continue;
+		}
+		int rank = remark.kind == "Missed" ? 0 : remark.kind == "Analysis" ? 1 : 2;
+		++unique[{ remark.function, remark.file, remark.line, remark.column, rank, remark.pass, remark.message }];
+	}
+
+	std::ostringstream out;
+	out << "Optimization remarks: " << missed << " missed, " << analysis << " analysis, " << passed << " passed" << std::endl;
+	std::string lastFunction;
+	for (const auto& [key, count] : unique) {
+		const auto& [function, file, line, column, rank, pass, message] = key;
+		// The top level statements of a program are compiled into main
+		std::string where = function == "main" ? "top level" : "function " + function;
+		if (where != lastFunction) {
+			out << "In " << where << ":" << std::endl;
+			lastFunction = where;
+		}
+		out << "  ";
+		// Line 0 is code with no statement of its own, such as freeing arrays at the end of a function
+		if (!file.empty() && line != 0) {
+			out << file << ":" << line << ":" << column << ": ";
+		}
+		out << (rank == 0 ? "MISSED" : rank == 1 ? "why" : "done") << " [" << pass << "] " << message;
+		if (count > 1) {
+			out << " (x" << count << ")";
+		}
+		out << std::endl;
+	}
+	if (!remarks.empty() && std::all_of(remarks.begin(), remarks.end(), [](const Remark& remark) { return remark.file.empty(); })) {
+		out << "No remark has a source line; compile with -g to get them" << std::endl;
+	}
+	return out.str();
+}
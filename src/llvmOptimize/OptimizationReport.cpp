@@ -0,0 +1,227 @@
+#include <algorithm>
+#include <iostream>
+
+#include "llvm/Analysis/LazyCallGraph.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/IR/PassManager.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "llvmOptimize/OptimizationReport.h"
+
+void OptimizationReport::beginFile(const std::string& file) {
+	std::lock_guard<std::mutex> guard(lock);
+	currentFile = file;
+	files.push_back(file);
+}
+
+void OptimizationReport::registerCallbacks(llvm::PassInstrumentationCallbacks& callbacks) {
+	callbacks.registerBeforeNonSkippedPassCallback([this](llvm::StringRef pass, llvm::Any ir) {
+		beforePass(pass, ir);
+	});
+	callbacks.registerAfterPassCallback([this](llvm::StringRef pass, llvm::Any ir, const llvm::PreservedAnalyses& preserved) {
+		afterPass(pass, &ir, !preserved.areAllPreserved());
+	});
+	// The IR unit is gone or no longer valid, e.g. a deleted loop or an SCC that was split
+	callbacks.registerAfterPassInvalidatedCallback([this](llvm::StringRef pass, const llvm::PreservedAnalyses&) {
+		afterPass(pass, nullptr, true);
+	});
+}
+
+void OptimizationReport::beforePass(llvm::StringRef pass, const llvm::Any& ir) {
+	RunningPass run;
+	if (!isContainer(pass)) {
+		if (const auto* module = llvm::any_cast<const llvm::Module*>(&ir)) {
+			run.module = *module;
+			run.unit = "(module)";
+		}
+		else if (const auto* function = llvm::any_cast<const llvm::Function*>(&ir)) {
+			run.measuredFunctions.push_back(*function);
+			run.unit = (*function)->getName().str();
+		}
+		else if (const auto* loop = llvm::any_cast<const llvm::Loop*>(&ir)) {
+			// Loop passes are measured on the whole function, which is still there if they delete the loop
+			const llvm::Function* function = (*loop)->getHeader()->getParent();
+			run.measuredFunctions.push_back(function);
+			run.unit = function->getName().str();
+		}
+		else if (const auto* scc = llvm::any_cast<const llvm::LazyCallGraph::SCC*>(&ir)) {
+			run.scc = true;
+			for (const llvm::LazyCallGraph::Node& node : **scc) {
+				const llvm::Function& function = node.getFunction();
+				run.measuredFunctions.push_back(&function);
+				run.unit += (run.unit.empty() ? "" : ", ") + function.getName().str();
+			}
+		}
+
+		if (run.module) {
+			run.before = measure(*run.module);
+			run.measured = true;
+		}
+		else if (!run.unit.empty()) {
+			for (const llvm::Function* function : run.measuredFunctions) {
+				Size size = measure(*function);
+				run.before.instructions += size.instructions;
+				run.before.blocks += size.blocks;
+			}
+			run.measured = true;
+		}
+	}
+	// Started last so measuring is not counted as part of the pass
+	std::lock_guard<std::mutex> guard(lock);
+	run.start = std::chrono::steady_clock::now();
+	running[std::this_thread::get_id()].push_back(std::move(run));
+}
+
+void OptimizationReport::afterPass(llvm::StringRef pass, const llvm::Any* ir, bool changed) {
+	auto end = std::chrono::steady_clock::now();
+	RunningPass run;
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		std::vector<RunningPass>& stack = running[std::this_thread::get_id()];
+		if (stack.empty()) {
+			return;
+		}
+		run = std::move(stack.back());
+		stack.pop_back();
+	}
+	if (!run.measured) {
+		return;
+	}
+	double milliseconds = std::chrono::duration<double, std::milli>(end - run.start).count();
+
+	// The functions of an invalidated SCC may have been deleted, so its size afterwards is unknown
+	bool sized = !(run.scc && !ir);
+	Size after;
+	if (run.module) {
+		after = measure(*run.module);
+	}
+	else if (run.scc) {
+		// The SCC after the pass, which may have lost or gained functions
+		if (const auto* scc = sized ? llvm::any_cast<const llvm::LazyCallGraph::SCC*>(ir) : nullptr) {
+			for (const llvm::LazyCallGraph::Node& node : **scc) {
+				Size size = measure(node.getFunction());
+				after.instructions += size.instructions;
+				after.blocks += size.blocks;
+			}
+		}
+	}
+	else {
+		for (const llvm::Function* function : run.measuredFunctions) {
+			Size size = measure(*function);
+			after.instructions += size.instructions;
+			after.blocks += size.blocks;
+		}
+	}
+
+	std::lock_guard<std::mutex> guard(lock);
+	PassStats& stats = passes[pass.str()];
+	++stats.runs;
+	stats.milliseconds += milliseconds;
+	if (changed) {
+		++stats.changedRuns;
+	}
+	if (sized) {
+		stats.instructionsBefore += run.before.instructions;
+		stats.instructionsAfter += after.instructions;
+		stats.blocksBefore += run.before.blocks;
+		stats.blocksAfter += after.blocks;
+	}
+
+	FunctionStats& unit = functions[{ currentFile, run.unit }];
+	++unit.passRuns;
+	unit.milliseconds += milliseconds;
+}
+
+bool OptimizationReport::isContainer(llvm::StringRef pass) {
+	return pass.contains("PassManager") || pass.contains("PassAdaptor") || pass.contains("Wrapper")
+		|| pass.contains("DevirtSCCRepeatedPass") || pass.contains("RequireAnalysisPass") || pass.contains("InvalidateAnalysisPass");
+}
+
+OptimizationReport::Size OptimizationReport::measure(const llvm::Module& module) {
+	Size size;
+	for (const llvm::Function& function : module) {
+		Size functionSize = measure(function);
+		size.instructions += functionSize.instructions;
+		size.blocks += functionSize.blocks;
+	}
+	return size;
+}
+
+OptimizationReport::Size OptimizationReport::measure(const llvm::Function& function) {
+	Size size;
+	size.instructions = function.getInstructionCount();
+	size.blocks = function.size();
+	return size;
+}
+
+bool OptimizationReport::write(const std::string& path) const {
+	std::error_code EC;
+	llvm::raw_fd_ostream output(path, EC, llvm::sys::fs::OF_Text);
+	if (EC) {
+		std::cerr << "Could not open " << path << " for the optimization report: " << EC.message() << std::endl;
+		return false;
+	}
+
+	// Slowest first, which is what the report is read for
+	std::vector<std::pair<std::string, PassStats>> passList(passes.begin(), passes.end());
+	std::stable_sort(passList.begin(), passList.end(), [](const auto& a, const auto& b) {
+		return a.second.milliseconds > b.second.milliseconds;
+	});
+	std::vector<std::pair<std::pair<std::string, std::string>, FunctionStats>> functionList(functions.begin(), functions.end());
+	std::stable_sort(functionList.begin(), functionList.end(), [](const auto& a, const auto& b) {
+		return a.second.milliseconds > b.second.milliseconds;
+	});
+
+	double total = 0;
+	for (const auto& entry : passList) {
+		total += entry.second.milliseconds;
+	}
+
+	llvm::json::OStream json(output, 2);
+	json.object([&] {
+		json.attributeArray("files", [&] {
+			for (const std::string& file : files) {
+				json.value(file);
+			}
+		});
+		json.attribute("totalMs", total);
+		json.attributeArray("passes", [&] {
+			for (const auto& [name, stats] : passList) {
+				json.object([&] {
+					json.attribute("name", name);
+					json.attribute("runs", static_cast<int64_t>(stats.runs));
+					json.attribute("changedRuns", static_cast<int64_t>(stats.changedRuns));
+					json.attribute("ms", stats.milliseconds);
+					json.attribute("instructionsBefore", static_cast<int64_t>(stats.instructionsBefore));
+					json.attribute("instructionsAfter", static_cast<int64_t>(stats.instructionsAfter));
+					json.attribute("blocksBefore", static_cast<int64_t>(stats.blocksBefore));
+					json.attribute("blocksAfter", static_cast<int64_t>(stats.blocksAfter));
+				});
+			}
+		});
+		// Passes that ran but preserved everything every time: candidates to drop from a custom --passes pipeline
+		json.attributeArray("unchangedPasses", [&] {
+			for (const auto& [name, stats] : passList) {
+				if (stats.changedRuns == 0) {
+					json.value(name);
+				}
+			}
+		});
+		json.attributeArray("functions", [&] {
+			for (const auto& [key, stats] : functionList) {
+				json.object([&] {
+					json.attribute("file", key.first);
+					json.attribute("name", key.second);
+					json.attribute("passRuns", static_cast<int64_t>(stats.passRuns));
+					json.attribute("ms", stats.milliseconds);
+				});
+			}
+		});
+	});
+	output << "\n";
+
+	std::cout << "Optimization report was written to " << path << std::endl;
+	return true;
+}
@@ -4,6 +4,8 @@
 #include <memory>
 #include <filesystem>
 #include <fstream>
+#include <algorithm>
+#include <thread>
 
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/Support/raw_ostream.h"
@@ -15,10 +17,37 @@
 #include "../include/semanticAnalyzer/SemanticAnalyzer.h"
 #include "../include/llvmGen/LLVMCodeGen.h"
 #include "llvmOptimize/LLVMOptimizer.h" 
-#include "generateMachineCode/genObjFile.h"
+#include "llvmOptimize/OptimizationRemarks.h"
+#include "llvmOptimize/OptimizationReport.h"
+#include "generateMachineCode/CodeGenSession.h"
+#include "generateMachineCode/Linker.h"
+#include "generateMachineCode/ParallelCodeGen.h"
+#include "generateMachineCode/ThinLTO.h"
 
 
-static void runTestForFile(const std::string& filePath) {
+// The code generator's effort for each pipeline level, as clang pairs them
+static llvm::CodeGenOptLevel codeGenLevel(const llvm::OptimizationLevel& level) {
+    if (level == llvm::OptimizationLevel::O0) {
+        return llvm::CodeGenOptLevel::None;
+    }
+    if (level == llvm::OptimizationLevel::O1) {
+        return llvm::CodeGenOptLevel::Less;
+    }
+    if (level == llvm::OptimizationLevel::O3) {
+        return llvm::CodeGenOptLevel::Aggressive;
+    }
+    return llvm::CodeGenOptLevel::Default;
+}
+
+// Links the program of sourceFile with lld; without LLD (SSL_HAVE_LLD unset) main rejects --link before this runs
+static void linkProgram(const std::vector<std::string>& objectFiles, const std::string& sourceFile, const LinkOptions& link) {
+#ifdef SSL_HAVE_LLD
+    Linker::link(objectFiles, Linker::outputFilename(sourceFile, link.shared), link);
+#endif
+}
+
+// link is null unless --link or --shared asked for the program to be linked
+static void runTestForFile(CodeGenSession& session, const std::string& filePath, bool debugInfo, bool instrumentFunctions, bool escapeReport, const OptimizationOptions& optimization, unsigned jobs, const LinkOptions* link) {
     std::ifstream testFile(filePath);
     if (!testFile) {
         std::cerr << "Failed to open test file: " << filePath << std::endl;
@@ -46,8 +75,17 @@ static void runTestForFile(const std::string& filePath) {
         std::cout << "Semantic analysis successful\n";
         LLVMCodeGen llvmCodeGen;
         std::cout << "LLVMCodeGen object created successfully\n";
+        if (debugInfo) {
+            llvmCodeGen.enableDebugInfo(filePath);
+        }
+        if (instrumentFunctions) {
+            llvmCodeGen.enableFunctionInstrumentation();
+        }
         program->accept(&llvmCodeGen);
         std::cout << "Visited program for llvm codegen successfully\n";
+        if (escapeReport) {
+            std::cerr << llvmCodeGen.getEscapeAnalysis().report();
+        }
         
         llvm::Module* module = llvmCodeGen.getModule();
         if (module) {
@@ -64,10 +102,24 @@ static void runTestForFile(const std::string& filePath) {
                 module->print(dest, nullptr);
                 std::cout << "LLVM IR was written to " << unoptimizedFilename << std::endl;
                 std::string unoptimizedObjFilename = "genObjectFile/unoptimized_" + testPath.filename().replace_extension(".o").string();
-                GenerateOBJ::generateObjectFile(module, unoptimizedObjFilename);
+                session.generateObjectFile(module, unoptimizedObjFilename);
             }
 
-            LLVMOptimizer::optimize(module);
+            if (optimization.report) {
+                optimization.report->beginFile(filePath);
+            }
+            if (jobs > 1 && !optimization.ltoPreLink) {
+                std::string optimizedObjFileName = "genObjectFile/optimized_" + testPath.filename().replace_extension(".o").string();
+                auto objects = ParallelCodeGen::generateObjectFiles(module, optimization, jobs, optimizedFilename, optimizedObjFileName, codeGenLevel(optimization.level), session.getTarget());
+                if (link) {
+                    linkProgram(objects, filePath, *link);
+                }
+                else {
+                    std::cout << "Link all " << objects.size() << " object files of " << filePath << std::endl;
+                }
+                return;
+            }
+            session.optimize(module, optimization, codeGenLevel(optimization.level));
             
             {
                 std::error_code EC;
@@ -81,7 +133,15 @@ static void runTestForFile(const std::string& filePath) {
                 module->print(dest, nullptr);
                 std::cout << "LLVM IR was written to " << optimizedFilename << std::endl;
                 std::string optimizedObjFileName = "genObjectFile/optimized_" + testPath.filename().replace_extension(".o").string();
-                GenerateOBJ::generateObjectFile(module, optimizedObjFileName);
+                if (optimization.ltoPreLink) {
+                    session.generateBitcodeFile(module, optimizedObjFileName); // the linker optimizes and compiles it
+                }
+                else {
+                    session.generateObjectFile(module, optimizedObjFileName, codeGenLevel(optimization.level));
+                    if (link) {
+                        linkProgram({ optimizedObjFileName }, filePath, *link);
+                    }
+                }
             }
             //assume you have another compiler installed like clang to generate the executable
         }
@@ -97,7 +157,105 @@ static void runTestForFile(const std::string& filePath) {
 }
 
 
-int main() {
+// --thin-lto: the files are one program. The first one has main and the top-level code, the others only
+// define functions, and every file may call the functions of all the others. Each file is compiled to
+// bitcode with a module summary, then ThinLTO imports functions across files and emits an object per file.
+static void runThinLTO(CodeGenSession& session, const std::vector<std::string>& filePaths, bool debugInfo, bool instrumentFunctions, bool escapeReport, const OptimizationOptions& optimization, unsigned jobs, const std::string& cacheDir, const LinkOptions* link) {
+    try {
+        // Every file is parsed before any is checked, so each one is compiled against the functions of all
+        std::vector<std::string> contents;
+        std::vector<std::unique_ptr<Program>> programs;
+        for (std::size_t i = 0; i < filePaths.size(); ++i) {
+            std::ifstream sourceFile(filePaths[i]);
+            if (!sourceFile) {
+                std::cerr << "Failed to open test file: " << filePaths[i] << std::endl;
+                return;
+            }
+            contents.emplace_back((std::istreambuf_iterator<char>(sourceFile)), std::istreambuf_iterator<char>());
+            Lexer lexer(contents.back().c_str());
+            Parser parser(lexer);
+            programs.push_back(parser.parseProgram());
+            const Program& program = *programs.back();
+            if (i > 0 && (!program.declarations.empty() || !program.statements.empty() || !program.expressions.empty())) {
+                throw std::runtime_error(filePaths[i] + ": only the first file of a --thin-lto program may have globals and top-level code.");
+            }
+        }
+
+        std::vector<std::string> bitcodeFiles;
+        std::vector<std::string> objectFiles;
+        for (std::size_t i = 0; i < programs.size(); ++i) {
+            std::vector<const FunctionDefinition*> externalFunctions;
+            for (std::size_t other = 0; other < programs.size(); ++other) {
+                for (const auto& func : programs[other]->functions) {
+                    const FunctionDefinition* funcDef = func->getDefinition();
+                    if (other != i && funcDef) {
+                        externalFunctions.push_back(funcDef);
+                    }
+                }
+            }
+
+            SymbolTable symbolTable;
+            SemanticAnalyzer semanticAnalyzer(symbolTable);
+            for (const FunctionDefinition* funcDef : externalFunctions) {
+                semanticAnalyzer.declareExternalFunction(funcDef);
+            }
+            semanticAnalyzer.visit(programs[i].get());
+            std::cout << "Semantic analysis of " << filePaths[i] << " successful\n";
+
+            LLVMCodeGen llvmCodeGen;
+            if (debugInfo) {
+                llvmCodeGen.enableDebugInfo(filePaths[i]);
+            }
+            if (instrumentFunctions) {
+                llvmCodeGen.enableFunctionInstrumentation();
+            }
+            for (const FunctionDefinition* funcDef : externalFunctions) {
+                llvmCodeGen.declareExternalFunction(funcDef);
+            }
+            if (i > 0) {
+                llvmCodeGen.setLibraryModule();
+            }
+            programs[i]->accept(&llvmCodeGen);
+            if (escapeReport) {
+                std::cerr << llvmCodeGen.getEscapeAnalysis().report();
+            }
+            llvm::Module* module = llvmCodeGen.getModule();
+
+            std::filesystem::path sourcePath = filePaths[i];
+            std::string unoptimizedFilename = "llvmGenerated/unoptimized_" + sourcePath.filename().replace_extension(".ll").string();
+            std::error_code EC;
+            llvm::raw_fd_ostream dest(unoptimizedFilename, EC);
+            if (EC) {
+                std::cerr << "Could not open file: " << EC.message() << ", for writing the LLVM IR to " << unoptimizedFilename << std::endl;
+                return;
+            }
+            module->print(dest, nullptr);
+            std::cout << "LLVM IR was written to " << unoptimizedFilename << std::endl;
+
+            if (optimization.report) {
+                optimization.report->beginFile(filePaths[i]);
+            }
+            OptimizationOptions preLink = optimization;
+            preLink.thinLTOPreLink = true;
+            session.optimize(module, preLink, codeGenLevel(optimization.level));
+
+            std::string objectFilename = "genObjectFile/optimized_" + sourcePath.filename().replace_extension(".o").string();
+            session.generateBitcodeFile(module, objectFilename, true);
+            bitcodeFiles.push_back(std::filesystem::path(objectFilename).replace_extension(".bc").string());
+            objectFiles.push_back(objectFilename);
+        }
+
+        ThinLTO::link(bitcodeFiles, objectFiles, optimization.level, codeGenLevel(optimization.level), session.getTarget(), jobs, cacheDir, link && link->shared);
+        if (link) {
+            linkProgram(objectFiles, filePaths[0], *link);
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "\033[31mTest Failed\033[0m" << " with error: " << e.what() << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
     // Adjusted for testing entire files rather than line-by-line
 
     std::vector<std::string> testFiles = {
@@ -105,8 +263,193 @@ int main() {
 		"tests/program_testing/practical_program.ssl"
     };
 
-    for (const auto& filePath : testFiles) {
-        runTestForFile(filePath); // Adjusted function call
+    // Flags; any other argument is a source file, and the files given replace the default test programs
+    //   -g                             DWARF line tables and variables
+    //   --instrument-functions         time every SSL function at run time
+    //   --escape-report                list what escape analysis kept on the stack, and why the rest stays
+    //   --profile-generate=<dir>       instrument for profile guided optimization
+    //   --profile-use=<file or dir>    optimize with a recorded profile
+    //   -O0 -O1 -O2 -O3 -Os -Oz        optimization level, -O3 by default
+    //   --passes=<pipeline>            run a textual pass pipeline instead of the level's
+    //   --lto-prelink                  write bitcode for a link time optimizing link
+    //   --opt-report=<file.json>       time and effect of every pass, over all files
+    //   --jobs=<n>                     compile each file in n partitions (0: one per core)
+    //   --thin-lto                     compile the files as one program with ThinLTO
+    //   --thin-lto-cache=<dir>         where ThinLTO caches backend results
+    //   --remarks=<file.yaml>          optimization remarks as YAML (turns on -g)
+    //   --explain-opt                  print the remarks by SSL function and line (turns on -g)
+    //   --adaptive-opt                 optimize functions by tier: full, cleanups only, or none
+    //   --march=<cpu>, --mattr=<+f,-f> build for a CPU (native: this machine's) and its features
+    //   --reloc=static|pic             relocation model, pic by default
+    //   --code-model=<model>           small, medium, large or kernel
+    //   --link                         link each program with lld into genExecutable/<name>
+    //   --shared                       link genExecutable/lib<name>.so instead
+    //   --runtime=<file>               the runtime archive to link, libSSLRuntime.a by default
+    bool debugInfo = false;
+    bool instrumentFunctions = false;
+    bool escapeReport = false;
+    OptimizationOptions optimization;
+    OptimizationReport optimizationReport;
+    std::string optimizationReportFile;
+    OptimizationRemarks optimizationRemarks;
+    std::string remarksFile;
+    bool explainOptimization = false;
+    unsigned jobs = 0; // Until --jobs is given
+    bool thinLTO = false;
+    std::string thinLTOCache = "genObjectFile/thinlto-cache";
+    CodeGenTarget target;
+    bool linkPrograms = false;
+    LinkOptions linkOptions;
+    std::vector<std::string> sourceFiles;
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument == "-g") {
+            debugInfo = true;
+        }
+        else if (argument == "--instrument-functions") {
+            instrumentFunctions = true;
+        }
+        else if (argument == "--escape-report") {
+            escapeReport = true;
+        }
+        else if (argument.rfind("--profile-generate=", 0) == 0) {
+            optimization.profileGenerateDir = argument.substr(std::string("--profile-generate=").size());
+        }
+        else if (argument.rfind("--profile-use=", 0) == 0) {
+            optimization.profileUseFile = argument.substr(std::string("--profile-use=").size());
+        }
+        else if (argument.rfind("-O", 0) == 0) {
+            auto level = LLVMOptimizer::parseLevel(argument);
+            if (!level) {
+                std::cerr << "Unknown optimization level " << argument << ", expected -O0, -O1, -O2, -O3, -Os or -Oz" << std::endl;
+                return 1;
+            }
+            optimization.level = *level;
+        }
+        else if (argument.rfind("--passes=", 0) == 0) {
+            optimization.passes = argument.substr(std::string("--passes=").size());
+        }
+        else if (argument == "--adaptive-opt") {
+            optimization.adaptive = true;
+        }
+        else if (argument == "--lto-prelink") {
+            optimization.ltoPreLink = true;
+        }
+        else if (argument.rfind("--jobs=", 0) == 0) {
+            std::string count = argument.substr(std::string("--jobs=").size());
+            if (count.empty() || count.size() > 4 || count.find_first_not_of("0123456789") != std::string::npos) {
+                std::cerr << "Expected a number of jobs in " << argument << std::endl;
+                return 1;
+            }
+            jobs = static_cast<unsigned>(std::stoul(count));
+            if (jobs == 0) {
+                jobs = std::max(1u, std::thread::hardware_concurrency());
+            }
+        }
+        else if (argument == "--thin-lto") {
+            thinLTO = true;
+        }
+        else if (argument.rfind("--thin-lto-cache=", 0) == 0) {
+            thinLTOCache = argument.substr(std::string("--thin-lto-cache=").size());
+        }
+        else if (argument.rfind("--opt-report=", 0) == 0) {
+            optimizationReportFile = argument.substr(std::string("--opt-report=").size());
+            optimization.report = &optimizationReport;
+        }
+        else if (argument.rfind("--remarks=", 0) == 0) {
+            remarksFile = argument.substr(std::string("--remarks=").size());
+            optimization.remarks = &optimizationRemarks;
+        }
+        else if (argument == "--explain-opt") {
+            explainOptimization = true;
+            optimization.remarks = &optimizationRemarks;
+        }
+        else if (argument.rfind("--march=", 0) == 0) {
+            target.cpu = argument.substr(std::string("--march=").size());
+        }
+        else if (argument.rfind("--mattr=", 0) == 0) {
+            target.features = argument.substr(std::string("--mattr=").size());
+        }
+        else if (argument.rfind("--reloc=", 0) == 0) {
+            auto model = GenerateOBJ::parseRelocationModel(argument.substr(std::string("--reloc=").size()));
+            if (!model) {
+                std::cerr << "Unknown relocation model " << argument << ", expected --reloc=static or --reloc=pic" << std::endl;
+                return 1;
+            }
+            target.relocationModel = *model;
+        }
+        else if (argument.rfind("--code-model=", 0) == 0) {
+            auto model = GenerateOBJ::parseCodeModel(argument.substr(std::string("--code-model=").size()));
+            if (!model) {
+                std::cerr << "Unknown code model " << argument << ", expected small, medium, large or kernel" << std::endl;
+                return 1;
+            }
+            target.codeModel = *model;
+        }
+        else if (argument == "--link") {
+            linkPrograms = true;
+        }
+        else if (argument == "--shared") {
+            linkPrograms = true;
+            linkOptions.shared = true;
+        }
+        else if (argument.rfind("--runtime=", 0) == 0) {
+            linkOptions.runtimeLibrary = argument.substr(std::string("--runtime=").size());
+        }
+        else {
+            sourceFiles.push_back(argv[i]);
+        }
+    }
+    if (!sourceFiles.empty()) {
+        testFiles = sourceFiles;
+    }
+#ifndef SSL_HAVE_LLD
+    if (linkPrograms) {
+        std::cerr << "--link and --shared need a compiler built with LLD, which CMake did not find; link the object files with clang" << std::endl;
+        return 1;
+    }
+#endif
+    // Bitcode is linked by a link time optimizing linker, not by --link
+    if (linkPrograms && optimization.ltoPreLink) {
+        std::cerr << "--link and --shared link machine code and cannot be combined with --lto-prelink" << std::endl;
+        return 1;
+    }
+    // Instrumented objects call the __llvm_profile_* functions of clang's profile runtime, which --link doesn't add
+    if (linkPrograms && !optimization.profileGenerateDir.empty()) {
+        std::cerr << "--link and --shared cannot link a --profile-generate build; link it with clang -fprofile-generate" << std::endl;
+        return 1;
+    }
+    linkOptions.pie = target.relocationModel == llvm::Reloc::PIC_;
+    // A remark's source line comes from the debug location of the instruction it is about
+    if (optimization.remarks) {
+        debugInfo = true;
+    }
+
+    // Set up once for every file of the run
+    CodeGenSession session(target);
+    if (!session.targetMachine(codeGenLevel(optimization.level))) {
+        return 1;
+    }
+    if (target.cpu != "generic") {
+        std::cout << "Building for CPU " << target.cpuName() << std::endl;
+    }
+    if (thinLTO) {
+        runThinLTO(session, testFiles, debugInfo, instrumentFunctions, escapeReport, optimization, jobs ? jobs : std::max(1u, std::thread::hardware_concurrency()), thinLTOCache, linkPrograms ? &linkOptions : nullptr);
+    }
+    else {
+        for (const auto& filePath : testFiles) {
+            runTestForFile(session, filePath, debugInfo, instrumentFunctions, escapeReport, optimization, jobs, linkPrograms ? &linkOptions : nullptr); // Adjusted function call
+        }
+    }
+
+    if (optimization.report && !optimizationReport.write(optimizationReportFile)) {
+        return 1;
+    }
+    if (explainOptimization) {
+        std::cerr << optimizationRemarks.explain();
+    }
+    if (!remarksFile.empty() && !optimizationRemarks.writeYAML(remarksFile)) {
+        return 1;
     }
 
     return 0;
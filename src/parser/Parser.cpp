@@ -33,9 +33,21 @@ const Token& Parser::peekToken() const {
     return nextToken;
 }
 
+bool Parser::isNumericTypeKeyword(const Token& token) {
+    return token.is_one_of(Token::Kind::Int, Token::Kind::I8, Token::Kind::I16, Token::Kind::I64, Token::Kind::Float, Token::Kind::Double);
+}
+
+bool Parser::isVectorTypeKeyword(const Token& token) {
+    return token.is_one_of(Token::Kind::Vec4f, Token::Kind::Vec8f, Token::Kind::Vec4i, Token::Kind::Vec8i);
+}
+
+SourceLocation Parser::currentLocation() const {
+    return { currentToken.line(), currentToken.column() };
+}
+
 //Declaration parsing
 std::unique_ptr<Declaration> Parser::parseDeclaration() {
-    if (currentToken.is(Token::Kind::Int)) {
+    if (currentToken.is_one_of(Token::Kind::Int, Token::Kind::I8, Token::Kind::I16, Token::Kind::I64)) {
         std::cout << "Parsing int declaration of either array or not\n";
         // Check if the next token after the identifier is a left square bracket
         if (peekToken().is(Token::Kind::Array)) {
@@ -47,27 +59,37 @@ std::unique_ptr<Declaration> Parser::parseDeclaration() {
             return parseIntDeclaration();
         }
     }
-    else if (currentToken.is(Token::Kind::Float)) {
+    else if (currentToken.is_one_of(Token::Kind::Float, Token::Kind::Double)) {
+        if (peekToken().is(Token::Kind::Array)) {
+            return parseArrayDeclaration();
+        }
         return parseFloatDeclaration();
     }
     else if (currentToken.is(Token::Kind::String)) {
         return parseStringDeclaration();
     }
+    else if (isVectorTypeKeyword(currentToken)) {
+        return parseVectorDeclaration();
+    }
 
     else if (currentToken.is(Token::Kind::Bool)) {
         return parseBoolDeclaration(); 
     }
     else {
-       throw std::runtime_error("Expected declaration type of either int, flt, or str.");
+       throw std::runtime_error("Expected declaration type of either int, i8, i16, i64, flt, dbl, str or bool.");
     }
 }
  
 std::unique_ptr<Expression> Parser::parseExpression() {
+    SourceLocation start = currentLocation();
     std::unique_ptr<Expression> leftExp;
     if (currentToken.is(Token::Kind::End)) {
         throw std::runtime_error("Unexpected end of file. Expected expression.");
     }
-    else if (currentToken.is_one_of(Token::Kind::Int, Token::Kind::Float, Token::Kind::String, Token::Kind::Bool)) {
+    else if ((isNumericTypeKeyword(currentToken) || isVectorTypeKeyword(currentToken) || currentToken.is(Token::Kind::Identifier)) && peekToken().is(Token::Kind::LeftParen)) {
+        leftExp = parseBinary(); // conversion such as i64(x) or built-in such as hsum(v), possibly followed by an operator
+    }
+    else if (isNumericTypeKeyword(currentToken) || currentToken.is_one_of(Token::Kind::String, Token::Kind::Bool)) {
         throw std::runtime_error("Forbidden keyword for expressions! Should not be able to parse as expression! Please use \"int\", \"flt\", \"str\", \"bool\" for declarations.");
     }
     else if (currentToken.is(Token::Kind::Return)) {
@@ -77,8 +99,8 @@ std::unique_ptr<Expression> Parser::parseExpression() {
     else if (currentToken.is_one_of(Token::Kind::While, Token::Kind::For)) {
         throw std::runtime_error("Forbidden keyword for expressions! Please use \"loop\" for while and for.");
     }
-    else if (currentToken.is_one_of(Token::Kind::Function, Token::Kind::Call)) {
-        throw std::runtime_error("No function definitions or calls allowed in expressions. Only reserved for statements.");
+    else if (currentToken.is(Token::Kind::Function)) {
+        throw std::runtime_error("No function definitions allowed in expressions. Only reserved for statements.");
     }
     else if (currentToken.is(Token::Kind::Comment)) {
         advance();
@@ -120,7 +142,7 @@ std::unique_ptr<Expression> Parser::parseExpression() {
             }
         }
    }
-   return leftExp;
+   return located(std::move(leftExp), start);
 }
 
 //Statement parsing
@@ -128,6 +150,13 @@ std::unique_ptr<Statement> Parser::parseStatement() {
     if (currentToken.is(Token::Kind::Loop)) {
         return parseLoopStatement();
     }
+    else if (currentToken.is(Token::Kind::At)) {
+        auto annotations = parseAnnotations();
+        if (!currentToken.is(Token::Kind::Loop)) {
+            throw std::runtime_error("Loop annotations must be followed by 'loop'");
+        }
+        return parseLoopStatement(std::move(annotations));
+    }
     else if (currentToken.is(Token::Kind::Log)) {
         return parsePrintStatement();
     }
@@ -137,6 +166,19 @@ std::unique_ptr<Statement> Parser::parseStatement() {
     else if (currentToken.is(Token::Kind::Return)) {
         return parseReturnStatement();
     }
+    else if (currentToken.is(Token::Kind::Arena)) {
+        return parseArenaBlock();
+    }
+    else if (currentToken.is(Token::Kind::Call)) {
+        auto expr = parseCallExpression();
+        consume(Token::Kind::Semicolon, "Expected ';' after function call.");
+        return std::make_unique<ExpressionStatement>(std::move(expr));
+    }
+    else if (currentToken.is(Token::Kind::Identifier) && peekToken().is(Token::Kind::LeftParen)) {
+        auto expr = parseBuiltinCall(); // store(values, i, v);
+        consume(Token::Kind::Semicolon, "Expected ';' after built-in call.");
+        return std::make_unique<ExpressionStatement>(std::move(expr));
+    }
     else {
         if (currentToken.is_one_of(Token::Kind::For, Token::Kind::While)) {
            throw std::runtime_error("Forbidden keyword for loop statements. Please use \"loop\" for while and for.");
@@ -165,7 +207,14 @@ std::unique_ptr<Statement> Parser::parseStatement() {
 }
 
 std::unique_ptr<Function> Parser::parseFunction(){
-    if (currentToken.is(Token::Kind::Function)) {
+    if (currentToken.is(Token::Kind::At)) {
+        auto annotations = parseAnnotations();
+        if (!currentToken.is(Token::Kind::Function)) {
+            throw std::runtime_error("Function annotations must be followed by 'function'");
+        }
+        return parseFunctionDefinition(std::move(annotations));
+    }
+    else if (currentToken.is(Token::Kind::Function)) {
         return parseFunctionDefinition();
     }
     else if (currentToken.is(Token::Kind::Call)){
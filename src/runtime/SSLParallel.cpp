@@ -0,0 +1,260 @@
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "runtime/SSLRuntime.h"
+
+namespace {
+
+    // Half-open range of loop iterations. 64-bit so splitting never overflows.
+    struct Range {
+        std::int64_t begin;
+        std::int64_t end;
+    };
+
+    // Each worker pushes and pops work at the back of its own deque; idle
+    // workers steal from the front, where the largest ranges sit.
+    struct alignas(64) WorkerQueue {
+        std::mutex lock;
+        std::deque<Range> ranges;
+        std::atomic<std::size_t> size{ 0 };
+
+        void push(Range range) {
+            std::lock_guard<std::mutex> guard(lock);
+            ranges.push_back(range);
+            size.store(ranges.size(), std::memory_order_relaxed);
+        }
+
+        bool pop(Range& range) {
+            std::lock_guard<std::mutex> guard(lock);
+            if (ranges.empty()) {
+                return false;
+            }
+            range = ranges.back();
+            ranges.pop_back();
+            size.store(ranges.size(), std::memory_order_relaxed);
+            return true;
+        }
+
+        bool steal(Range& range) {
+            std::lock_guard<std::mutex> guard(lock);
+            if (ranges.empty()) {
+                return false;
+            }
+            range = ranges.front();
+            ranges.pop_front();
+            size.store(ranges.size(), std::memory_order_relaxed);
+            return true;
+        }
+
+        bool empty() const {
+            return size.load(std::memory_order_relaxed) == 0;
+        }
+    };
+
+    struct Job {
+        ssl_parallel_body body;
+        void* context;
+        std::int64_t grain; // smallest range worth handing to the body on its own
+        std::atomic<std::int64_t> remaining; // iterations not yet executed
+    };
+
+    // Worker index of the calling thread, -1 outside of the pool.
+    thread_local std::int32_t currentWorker = -1;
+
+    class ThreadPool {
+    public:
+        explicit ThreadPool(std::int32_t workers) {
+            for (std::int32_t i = 0; i < workers; ++i) {
+                queues.push_back(std::make_unique<WorkerQueue>());
+            }
+            // Worker 0 is whichever thread calls ssl_parallel_for
+            for (std::int32_t i = 1; i < workers; ++i) {
+                threads.emplace_back([this, i] { workerMain(i); });
+            }
+        }
+
+        ~ThreadPool() {
+            {
+                std::lock_guard<std::mutex> guard(wakeLock);
+                stopping = true;
+            }
+            wake.notify_all();
+            for (auto& thread : threads) {
+                thread.join();
+            }
+        }
+
+        std::int32_t workerCount() const {
+            return static_cast<std::int32_t>(queues.size());
+        }
+
+        void run(std::int32_t begin, std::int32_t end, ssl_parallel_body body, void* context) {
+            std::int64_t total = static_cast<std::int64_t>(end) - begin;
+            if (total <= 0) {
+                return;
+            }
+            // Nested loops, a single worker or a single iteration are not worth waking the pool for
+            if (currentWorker >= 0 || workerCount() == 1 || total == 1) {
+                body(begin, end, context, std::max(currentWorker, 0));
+                return;
+            }
+
+            std::lock_guard<std::mutex> jobGuard(jobLock);
+            Job job;
+            job.body = body;
+            job.context = context;
+            job.grain = std::max<std::int64_t>(1, total / (static_cast<std::int64_t>(workerCount()) * 64));
+            job.remaining.store(total, std::memory_order_relaxed);
+
+            queues[0]->push({ begin, end });
+            {
+                std::lock_guard<std::mutex> guard(wakeLock);
+                currentJob = &job;
+                ++generation;
+            }
+            wake.notify_all();
+
+            currentWorker = 0;
+            participate(0, job);
+            currentWorker = -1;
+
+            // Late wakers must not pick the job up, and the ones already in it must leave before it goes away
+            {
+                std::lock_guard<std::mutex> guard(wakeLock);
+                currentJob = nullptr;
+            }
+            while (activeWorkers.load(std::memory_order_acquire) != 0) {
+                std::this_thread::yield();
+            }
+        }
+
+    private:
+        void workerMain(std::int32_t worker) {
+            currentWorker = worker;
+            std::uint64_t seenGeneration = 0;
+            while (true) {
+                Job* job = nullptr;
+                {
+                    std::unique_lock<std::mutex> guard(wakeLock);
+                    wake.wait(guard, [&] { return stopping || generation != seenGeneration; });
+                    if (stopping) {
+                        return;
+                    }
+                    seenGeneration = generation;
+                    job = currentJob;
+                    if (!job) {
+                        continue;
+                    }
+                    activeWorkers.fetch_add(1, std::memory_order_relaxed);
+                }
+                participate(worker, *job);
+                activeWorkers.fetch_sub(1, std::memory_order_release);
+            }
+        }
+
+        void participate(std::int32_t worker, Job& job) {
+            Range range;
+            while (job.remaining.load(std::memory_order_acquire) > 0) {
+                if (findWork(worker, range)) {
+                    runRange(worker, job, range);
+                }
+                else {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+        bool findWork(std::int32_t worker, Range& range) {
+            if (queues[worker]->pop(range)) {
+                return true;
+            }
+            std::int32_t workers = workerCount();
+            for (std::int32_t i = 1; i < workers; ++i) {
+                if (queues[(worker + i) % workers]->steal(range)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Lazy binary splitting: while our deque is empty nobody can steal from
+        // us, so give away the upper half; otherwise keep running grain-sized
+        // chunks. Ranges only get split as far as idle workers need them.
+        void runRange(std::int32_t worker, Job& job, Range range) {
+            while (range.end - range.begin > job.grain) {
+                if (queues[worker]->empty()) {
+                    std::int64_t middle = range.begin + (range.end - range.begin) / 2;
+                    queues[worker]->push({ middle, range.end });
+                    range.end = middle;
+                }
+                else {
+                    execute(worker, job, { range.begin, range.begin + job.grain });
+                    range.begin += job.grain;
+                }
+            }
+            execute(worker, job, range);
+        }
+
+        void execute(std::int32_t worker, Job& job, Range range) {
+            job.body(static_cast<std::int32_t>(range.begin), static_cast<std::int32_t>(range.end), job.context, worker);
+            job.remaining.fetch_sub(range.end - range.begin, std::memory_order_acq_rel);
+        }
+
+        std::vector<std::unique_ptr<WorkerQueue>> queues;
+        std::vector<std::thread> threads;
+
+        std::mutex jobLock; // one parallel loop at a time
+        std::mutex wakeLock;
+        std::condition_variable wake;
+        Job* currentJob = nullptr;
+        std::uint64_t generation = 0;
+        bool stopping = false;
+        std::atomic<std::int32_t> activeWorkers{ 0 };
+    };
+
+    std::int32_t defaultWorkerCount() {
+        std::int32_t count = static_cast<std::int32_t>(std::thread::hardware_concurrency());
+        if (const char* requested = std::getenv("SSL_NUM_THREADS")) {
+            count = std::atoi(requested);
+        }
+        return std::clamp<std::int32_t>(count, 1, sslParallelMaxWorkers);
+    }
+
+    std::mutex poolLock;
+    std::unique_ptr<ThreadPool> poolInstance;
+
+    ThreadPool& pool() {
+        std::lock_guard<std::mutex> guard(poolLock);
+        if (!poolInstance) {
+            poolInstance = std::make_unique<ThreadPool>(defaultWorkerCount());
+        }
+        return *poolInstance;
+    }
+
+} // namespace
+
+extern "C" {
+
+void ssl_parallel_for(std::int32_t begin, std::int32_t end, ssl_parallel_body body, void* context) {
+    pool().run(begin, end, body, context);
+}
+
+std::int32_t ssl_parallel_worker_count() {
+    return pool().workerCount();
+}
+
+void ssl_parallel_set_worker_count(std::int32_t count) {
+    std::lock_guard<std::mutex> guard(poolLock);
+    poolInstance.reset();
+    poolInstance = std::make_unique<ThreadPool>(std::clamp<std::int32_t>(count, 1, sslParallelMaxWorkers));
+}
+
+}
@@ -0,0 +1,254 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "runtime/SSLRuntime.h"
+
+namespace {
+
+    // The time stamp counter where there is one; it is a single unserialized
+    // instruction, cheap enough to read twice per call.
+    inline std::uint64_t readCycles() {
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+
+    struct Totals {
+        std::uint64_t calls = 0;
+        std::uint64_t inclusive = 0;
+        std::uint64_t exclusive = 0;
+    };
+
+    // Only the owning thread writes the counters, but the report may read them from another thread while
+    // the owner is still running (a pool worker at exit), so they are relaxed atomics. A load and a store
+    // instead of fetch_add keep the update as cheap as a plain increment.
+    struct FunctionStats {
+        std::atomic<std::uint64_t> calls{ 0 };
+        std::atomic<std::uint64_t> inclusive{ 0 };
+        std::atomic<std::uint64_t> exclusive{ 0 };
+        std::uint32_t active = 0; // Frames of this function on the stack, so recursion is not counted twice
+
+        static void add(std::atomic<std::uint64_t>& counter, std::uint64_t amount) {
+            counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+        }
+
+        Totals totals() const {
+            return { calls.load(std::memory_order_relaxed), inclusive.load(std::memory_order_relaxed), exclusive.load(std::memory_order_relaxed) };
+        }
+    };
+
+    struct Frame {
+        std::int32_t id;
+        std::uint64_t start;
+        std::uint64_t children; // Inclusive cycles of the calls made from this frame
+    };
+
+    struct ThreadProfile;
+
+    // Shared by all threads. Deliberately never destroyed: pool workers may
+    // still retire their tables after the report has been written at exit.
+    struct Registry {
+        std::mutex lock;
+        std::vector<const char*> names; // Indexed by site id
+        std::vector<ThreadProfile*> live;
+        std::vector<Totals> retired; // Totals of threads that have exited
+    };
+
+    void writeReport();
+
+    Registry& registry() {
+        static Registry* instance = [] {
+            Registry* created = new Registry();
+            std::atexit(writeReport);
+            return created;
+        }();
+        return *instance;
+    }
+
+    void addStats(std::vector<Totals>& totals, const std::vector<FunctionStats>& stats) {
+        if (totals.size() < stats.size()) {
+            totals.resize(stats.size());
+        }
+        for (std::size_t id = 0; id < stats.size(); ++id) {
+            Totals counted = stats[id].totals();
+            totals[id].calls += counted.calls;
+            totals[id].inclusive += counted.inclusive;
+            totals[id].exclusive += counted.exclusive;
+        }
+    }
+
+    struct ThreadProfile {
+        std::vector<FunctionStats> stats; // Indexed by site id; replaced only under the registry lock
+        std::vector<Frame> stack;
+
+        // Makes room for site id. The report reads stats under the lock, so the table is swapped under it too
+        void grow(std::size_t size) {
+            std::vector<FunctionStats> grown(size);
+            for (std::size_t id = 0; id < stats.size(); ++id) {
+                Totals counted = stats[id].totals();
+                grown[id].calls.store(counted.calls, std::memory_order_relaxed);
+                grown[id].inclusive.store(counted.inclusive, std::memory_order_relaxed);
+                grown[id].exclusive.store(counted.exclusive, std::memory_order_relaxed);
+                grown[id].active = stats[id].active;
+            }
+            Registry& shared = registry();
+            std::lock_guard<std::mutex> guard(shared.lock);
+            stats.swap(grown);
+        }
+
+        ThreadProfile() {
+            Registry& shared = registry();
+            std::lock_guard<std::mutex> guard(shared.lock);
+            shared.live.push_back(this);
+        }
+
+        ~ThreadProfile() {
+            Registry& shared = registry();
+            std::lock_guard<std::mutex> guard(shared.lock);
+            addStats(shared.retired, stats);
+            shared.live.erase(std::find(shared.live.begin(), shared.live.end(), this));
+        }
+    };
+
+    thread_local ThreadProfile threadProfile;
+
+    std::int32_t registerSite(ssl_profile_site* site) {
+        Registry& shared = registry();
+        std::lock_guard<std::mutex> guard(shared.lock);
+        // Another thread may have registered the site while we waited
+        std::int32_t id = site->id.load(std::memory_order_acquire);
+        if (id < 0) {
+            id = static_cast<std::int32_t>(shared.names.size());
+            shared.names.push_back(site->name);
+            site->id.store(id, std::memory_order_release);
+        }
+        return id;
+    }
+
+    struct ReportEntry {
+        const char* name;
+        Totals stats;
+    };
+
+    void writeJsonString(std::FILE* output, const char* text) {
+        std::fputc('"', output);
+        for (const char* c = text; *c; ++c) {
+            if (*c == '"' || *c == '\\') {
+                std::fputc('\\', output);
+            }
+            std::fputc(*c, output);
+        }
+        std::fputc('"', output);
+    }
+
+    void writeReport() {
+        Registry& shared = registry();
+        std::vector<ReportEntry> entries;
+        {
+            std::lock_guard<std::mutex> guard(shared.lock);
+            std::vector<Totals> totals = shared.retired;
+            for (const ThreadProfile* profile : shared.live) {
+                addStats(totals, profile->stats);
+            }
+            totals.resize(shared.names.size());
+            for (std::size_t id = 0; id < totals.size(); ++id) {
+                entries.push_back({ shared.names[id], totals[id] });
+            }
+        }
+        std::sort(entries.begin(), entries.end(), [](const ReportEntry& a, const ReportEntry& b) {
+            return a.stats.exclusive > b.stats.exclusive;
+        });
+
+        std::uint64_t totalExclusive = 0;
+        for (const ReportEntry& entry : entries) {
+            totalExclusive += entry.stats.exclusive;
+        }
+
+        std::fprintf(stderr, "\nSSL function profile (cycles, sorted by exclusive time)\n");
+        std::fprintf(stderr, "%-32s %14s %20s %20s %8s\n", "function", "calls", "inclusive", "exclusive", "excl %");
+        for (const ReportEntry& entry : entries) {
+            double share = totalExclusive ? 100.0 * static_cast<double>(entry.stats.exclusive) / static_cast<double>(totalExclusive) : 0.0;
+            std::fprintf(stderr, "%-32s %14llu %20llu %20llu %7.2f%%\n", entry.name,
+                static_cast<unsigned long long>(entry.stats.calls),
+                static_cast<unsigned long long>(entry.stats.inclusive),
+                static_cast<unsigned long long>(entry.stats.exclusive), share);
+        }
+
+        const char* path = std::getenv("SSL_PROFILE_JSON");
+        if (!path || !*path) {
+            path = "ssl_profile.json";
+        }
+        std::FILE* output = std::fopen(path, "w");
+        if (!output) {
+            std::fprintf(stderr, "Could not open %s for the JSON profile report\n", path);
+            return;
+        }
+        std::fprintf(output, "{\n  \"unit\": \"cycles\",\n  \"functions\": [");
+        for (std::size_t i = 0; i < entries.size(); ++i) {
+            std::fprintf(output, "%s\n    { \"name\": ", i ? "," : "");
+            writeJsonString(output, entries[i].name);
+            std::fprintf(output, ", \"calls\": %llu, \"inclusive\": %llu, \"exclusive\": %llu }",
+                static_cast<unsigned long long>(entries[i].stats.calls),
+                static_cast<unsigned long long>(entries[i].stats.inclusive),
+                static_cast<unsigned long long>(entries[i].stats.exclusive));
+        }
+        std::fprintf(output, "\n  ]\n}\n");
+        std::fclose(output);
+    }
+
+} // namespace
+
+extern "C" {
+
+void ssl_profile_enter(ssl_profile_site* site) {
+    std::int32_t id = site->id.load(std::memory_order_acquire);
+    if (id < 0) {
+        id = registerSite(site);
+    }
+
+    ThreadProfile& profile = threadProfile;
+    if (static_cast<std::size_t>(id) >= profile.stats.size()) {
+        profile.grow(static_cast<std::size_t>(id) + 1);
+    }
+    FunctionStats& stats = profile.stats[static_cast<std::size_t>(id)];
+    FunctionStats::add(stats.calls, 1);
+    ++stats.active;
+    profile.stack.push_back({ id, readCycles(), 0 });
+}
+
+void ssl_profile_exit() {
+    std::uint64_t now = readCycles();
+    ThreadProfile& profile = threadProfile;
+    if (profile.stack.empty()) {
+        return;
+    }
+    Frame frame = profile.stack.back();
+    profile.stack.pop_back();
+
+    std::uint64_t elapsed = now - frame.start;
+    FunctionStats& stats = profile.stats[static_cast<std::size_t>(frame.id)];
+    FunctionStats::add(stats.exclusive, elapsed - std::min(elapsed, frame.children));
+    if (--stats.active == 0) {
+        FunctionStats::add(stats.inclusive, elapsed);
+    }
+    if (!profile.stack.empty()) {
+        profile.stack.back().children += elapsed;
+    }
+}
+
+}
@@ -0,0 +1,347 @@
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "runtime/SSLRuntime.h"
+
+namespace {
+
+    constexpr std::size_t logBufferSize = 64 * 1024;
+
+    // Per-thread output buffer. It is written out once it fills up, when
+    // ssl_flush() is called, and when the owning thread exits (for the main
+    // thread that is program exit).
+    struct LogBuffer {
+        char data[logBufferSize];
+        std::size_t used = 0;
+
+        ~LogBuffer() {
+            flush();
+        }
+
+        void flush() {
+            if (used == 0) {
+                return;
+            }
+            std::fwrite(data, 1, used, stdout);
+            std::fflush(stdout);
+            used = 0;
+        }
+
+        // Makes sure at least `count` bytes can be appended without overflowing.
+        void reserve(std::size_t count) {
+            if (used + count > logBufferSize) {
+                flush();
+            }
+        }
+
+        void append(const char* text, std::size_t length) {
+            reserve(length);
+            if (length > logBufferSize) {
+                // Too large to ever fit, bypass the buffer entirely.
+                std::fwrite(text, 1, length, stdout);
+                return;
+            }
+            std::memcpy(data + used, text, length);
+            used += length;
+        }
+    };
+
+    thread_local LogBuffer logBuffer;
+
+    bool isInline(const ssl_string& value) {
+        return value.length < 0;
+    }
+
+    std::int64_t lengthOf(const ssl_string& value) {
+        return isInline(value) ? static_cast<std::int64_t>((static_cast<std::uint64_t>(value.length) >> 56) & 0x7f) : value.length;
+    }
+
+    const char* bytesOf(const ssl_string& value) {
+        return isInline(value) ? reinterpret_cast<const char*>(&value) : value.data;
+    }
+
+    constexpr std::size_t arenaChunkSize = 64 * 1024;
+    constexpr std::size_t maxCachedChunks = 64; // Up to 4 MB of released chunks kept per thread
+    constexpr std::size_t arenaAlignment = 16;
+    constexpr std::size_t cacheLineSize = 64;
+    constexpr std::size_t staggerThreshold = 256;
+
+    // Header of a block of memory a Region allocates from; the bytes follow it.
+    struct alignas(arenaAlignment) Chunk {
+        Chunk* next;
+        std::size_t size;
+
+        char* bytes() {
+            return reinterpret_cast<char*>(this + 1);
+        }
+    };
+
+    Chunk* newChunk(std::size_t size) {
+        Chunk* chunk = static_cast<Chunk*>(std::malloc(sizeof(Chunk) + size));
+        if (!chunk) {
+            std::fputs("SSL runtime: out of memory for an arena\n", stderr);
+            std::abort();
+        }
+        chunk->size = size;
+        return chunk;
+    }
+
+    // Standard-size chunks given back by arenas that ended, so the next arena
+    // on the thread starts without calling malloc.
+    struct ChunkCache {
+        Chunk* chunks = nullptr;
+        std::size_t count = 0;
+
+        ~ChunkCache() {
+            while (chunks) {
+                Chunk* next = chunks->next;
+                std::free(chunks);
+                chunks = next;
+            }
+        }
+
+        Chunk* take(std::size_t size) {
+            if (size > arenaChunkSize || !chunks) {
+                return newChunk(std::max(arenaChunkSize, size));
+            }
+            Chunk* chunk = chunks;
+            chunks = chunk->next;
+            --count;
+            return chunk;
+        }
+
+        void give(Chunk* chunk) {
+            if (chunk->size != arenaChunkSize || count == maxCachedChunks) {
+                std::free(chunk);
+                return;
+            }
+            chunk->next = chunks;
+            chunks = chunk;
+            ++count;
+        }
+    };
+
+    thread_local ChunkCache chunkCache;
+
+    // Bump allocator over a list of chunks. The newest allocation can grow in
+    // place while nothing has been allocated after it.
+    struct Region {
+        char* top = nullptr;
+        char* end = nullptr;
+        Chunk* chunks = nullptr;
+
+        std::size_t available() const {
+            return static_cast<std::size_t>(end - top);
+        }
+
+        bool isNewest(const char* data, std::size_t size) const {
+            return data + size == top;
+        }
+
+        char* allocate(std::size_t size, std::size_t alignment = 1) {
+            std::size_t padding = static_cast<std::size_t>(-reinterpret_cast<std::uintptr_t>(top)) & (alignment - 1);
+            if (!top || available() < padding + size) {
+                // Twice the request, so a value that keeps growing is copied O(log n) times
+                Chunk* chunk = chunkCache.take(size > arenaChunkSize / 2 ? 2 * size : size);
+                chunk->next = chunks;
+                chunks = chunk;
+                top = chunk->bytes();
+                end = top + chunk->size;
+                padding = 0;
+            }
+            char* result = top + padding;
+            top = result + size;
+            return result;
+        }
+
+        // Extends the newest allocation in place if the chunk has room, otherwise moves it
+        char* resize(char* data, std::size_t oldSize, std::size_t newSize) {
+            if (data && isNewest(data, oldSize) && available() >= newSize - oldSize) {
+                top = data + newSize;
+                return data;
+            }
+            // Buffers that double side by side end up at the same offset within a page and evict
+            // each other from the L1 cache, so larger ones get a cache line of space in front
+            std::size_t gap = newSize >= staggerThreshold ? cacheLineSize : 0;
+            char* moved = allocate(gap + newSize, arenaAlignment) + gap;
+            if (oldSize) {
+                std::memcpy(moved, data, oldSize);
+            }
+            return moved;
+        }
+
+        void release() {
+            while (chunks) {
+                Chunk* next = chunks->next;
+                chunkCache.give(chunks);
+                chunks = next;
+            }
+            top = end = nullptr;
+        }
+    };
+
+    // Strings built outside any arena block that may leave the function that
+    // built them; those that can't are given a function's arena by LLVMCodeGen.
+    // This region is never released: a string may outlive the thread that built
+    // it, e.g. when a parallel loop stores it in a global.
+    thread_local Region stringArena;
+
+    void concatInto(Region& region, const ssl_string* left, const ssl_string* right, ssl_string* result) {
+        std::size_t leftLength = static_cast<std::size_t>(lengthOf(*left));
+        std::size_t rightLength = static_cast<std::size_t>(lengthOf(*right));
+        std::size_t length = leftLength + rightLength;
+
+        if (length <= static_cast<std::size_t>(sslStringInlineCapacity)) {
+            char bytes[sizeof(ssl_string)] = {};
+            std::memcpy(bytes, bytesOf(*left), leftLength);
+            std::memcpy(bytes + leftLength, bytesOf(*right), rightLength);
+            bytes[sizeof(ssl_string) - 1] = static_cast<char>(0x80 | length);
+            std::memcpy(result, bytes, sizeof(ssl_string));
+            return;
+        }
+
+        // Strings never change once built, so the bytes past the end of the newest one are free to extend it
+        if (!isInline(*left) && region.isNewest(left->data, leftLength) && region.available() >= rightLength) {
+            std::memcpy(region.top, bytesOf(*right), rightLength);
+            region.top += rightLength;
+            *result = { left->data, static_cast<std::int64_t>(length) };
+            return;
+        }
+
+        char* data = region.allocate(length);
+        std::memcpy(data, bytesOf(*left), leftLength);
+        std::memcpy(data + leftLength, bytesOf(*right), rightLength);
+        *result = { data, static_cast<std::int64_t>(length) };
+    }
+
+    // Largest fixed-notation float (FLT_MAX with 6 decimals) plus sign and newline.
+    constexpr std::size_t maxFormattedFloat = 48;
+    // Same for DBL_MAX, which has 309 integer digits.
+    constexpr std::size_t maxFormattedDouble = 320;
+    constexpr std::size_t maxFormattedInt = 16;
+    constexpr std::size_t maxFormattedInt64 = 24;
+
+} // namespace
+
+struct ssl_arena {
+    Region region;
+    ssl_arena* next = nullptr; // In the thread's list of arenas to reuse
+};
+
+namespace {
+
+    // Arena blocks nest, so the handles are reused last in, first out
+    thread_local ssl_arena* freeArenas = nullptr;
+
+} // namespace
+
+extern "C" {
+
+void ssl_log_i32(std::int32_t value) {
+    logBuffer.reserve(maxFormattedInt);
+    char* begin = logBuffer.data + logBuffer.used;
+    char* end = std::to_chars(begin, begin + maxFormattedInt - 1, value).ptr;
+    *end++ = '\n';
+    logBuffer.used += static_cast<std::size_t>(end - begin);
+}
+
+void ssl_log_i64(std::int64_t value) {
+    logBuffer.reserve(maxFormattedInt64);
+    char* begin = logBuffer.data + logBuffer.used;
+    char* end = std::to_chars(begin, begin + maxFormattedInt64 - 1, value).ptr;
+    *end++ = '\n';
+    logBuffer.used += static_cast<std::size_t>(end - begin);
+}
+
+void ssl_log_f32(float value) {
+    // Matches the "%f" formatting the printf lowering used to produce.
+    logBuffer.reserve(maxFormattedFloat);
+    char* begin = logBuffer.data + logBuffer.used;
+    char* end = std::to_chars(begin, begin + maxFormattedFloat - 1, static_cast<double>(value), std::chars_format::fixed, 6).ptr;
+    *end++ = '\n';
+    logBuffer.used += static_cast<std::size_t>(end - begin);
+}
+
+void ssl_log_f64(double value) {
+    logBuffer.reserve(maxFormattedDouble);
+    char* begin = logBuffer.data + logBuffer.used;
+    char* end = std::to_chars(begin, begin + maxFormattedDouble - 1, value, std::chars_format::fixed, 6).ptr;
+    *end++ = '\n';
+    logBuffer.used += static_cast<std::size_t>(end - begin);
+}
+
+void ssl_log_bool(bool value) {
+    if (value) {
+        logBuffer.append("true\n", 5);
+    }
+    else {
+        logBuffer.append("false\n", 6);
+    }
+}
+
+void ssl_log_str(const ssl_string* value) {
+    logBuffer.append(bytesOf(*value), static_cast<std::size_t>(lengthOf(*value)));
+    logBuffer.append("\n", 1);
+}
+
+bool ssl_str_equals(const ssl_string* left, const ssl_string* right) {
+    std::int64_t length = lengthOf(*left);
+    return length == lengthOf(*right) && std::memcmp(bytesOf(*left), bytesOf(*right), static_cast<std::size_t>(length)) == 0;
+}
+
+void ssl_str_concat(const ssl_string* left, const ssl_string* right, ssl_string* result) {
+    concatInto(stringArena, left, right, result);
+}
+
+void ssl_str_concat_in(ssl_arena* arena, const ssl_string* left, const ssl_string* right, ssl_string* result) {
+    concatInto(arena->region, left, right, result);
+}
+
+void ssl_str_concat_local(char* buffer, std::int64_t capacity, ssl_arena* arena, const ssl_string* left, const ssl_string* right, ssl_string* result) {
+    std::int64_t leftLength = lengthOf(*left);
+    std::int64_t rightLength = lengthOf(*right);
+    std::int64_t length = leftLength + rightLength;
+    if (length <= sslStringInlineCapacity || length > capacity) {
+        concatInto(arena ? arena->region : stringArena, left, right, result);
+        return;
+    }
+
+    // The buffer only ever holds the str's current value, from its start: s = s + t finds left in
+    // place already, and for s = t + s moving right up first keeps its bytes from being overwritten.
+    std::memmove(buffer + leftLength, bytesOf(*right), static_cast<std::size_t>(rightLength));
+    if (bytesOf(*left) != buffer) {
+        std::memmove(buffer, bytesOf(*left), static_cast<std::size_t>(leftLength));
+    }
+    *result = { buffer, length };
+}
+
+ssl_arena* ssl_arena_enter() {
+    ssl_arena* arena = freeArenas;
+    if (arena) {
+        freeArenas = arena->next;
+    }
+    else {
+        arena = new ssl_arena();
+    }
+    return arena;
+}
+
+void ssl_arena_exit(ssl_arena* arena) {
+    arena->region.release();
+    arena->next = freeArenas;
+    freeArenas = arena;
+}
+
+void* ssl_arena_resize(ssl_arena* arena, void* data, std::int64_t oldSize, std::int64_t newSize) {
+    return arena->region.resize(static_cast<char*>(data), static_cast<std::size_t>(oldSize), static_cast<std::size_t>(newSize));
+}
+
+void ssl_flush() {
+    logBuffer.flush();
+}
+
+}
@@ -0,0 +1,457 @@
+#include "../../include/semanticAnalyzer/EscapeAnalysis.h"
+#include "../../include/ast/ASTNodes.h"
+
+#include <limits>
+
+namespace {
+
+    bool isStringLiteral(const Expression& expr) {
+        const std::string name = expr.getName();
+        return name.size() >= 2 && name.front() == '"' && name.back() == '"';
+    }
+
+    std::uint64_t literalLength(const Expression& expr) {
+        return expr.getName().size() - 2;
+    }
+
+    // Iterations of range(start, end) step `step` when all three are integer literals
+    std::optional<std::uint64_t> tripCount(const ForLoopStatement* stmt) {
+        auto start = stmt->start->getIntegerConstant();
+        auto end = stmt->end->getIntegerConstant();
+        auto step = stmt->step ? stmt->step->getIntegerConstant() : std::optional<std::int64_t>(1);
+        if (!start || !end || !step || *step == 0) {
+            return std::nullopt;
+        }
+        if (*step > 0) {
+            return *end > *start ? static_cast<std::uint64_t>((*end - *start + *step - 1) / *step) : 0;
+        }
+        return *start > *end ? static_cast<std::uint64_t>((*start - *end - *step - 1) / -*step) : 0;
+    }
+
+    std::uint64_t elementBytes(const std::string& elementType) {
+        unsigned bits = integerTypeBits(elementType);
+        if (bits != 0) {
+            return bits / 8;
+        }
+        return elementType == "double" ? 8 : 4;
+    }
+
+} // namespace
+
+void EscapeAnalysis::visit(const Program* program) {
+    allocations.clear();
+    concatTargets.clear();
+    // Top-level declarations are globals, which are never moved
+    for (const auto& func : program->functions) {
+        func->accept(this);
+    }
+}
+
+void EscapeAnalysis::visit(const FunctionDefinition* funcDef) {
+    functionName = funcDef->name;
+    candidates.clear();
+    functionConcats.clear();
+    scopes.assign(1, {});
+    loopTrips.clear();
+    parallelScope = 0;
+    pendingConcat = -1;
+    readOnly = false;
+    useReason = "used as a value";
+
+    // A str parameter is a copy of the caller's value; what the function concatenates onto it is its own
+    for (const auto& parameter : funcDef->parameters) {
+        if (normalizeType(parameter.type) == "string") {
+            addCandidate(funcDef, parameter.name, "str", 0, funcDef->location.line);
+            candidates.back().bounded = false;
+            candidates.back().unboundedReason = "a parameter has no known length";
+        }
+        else {
+            declareLocal(parameter.name);
+        }
+    }
+    for (const auto& stmt : funcDef->body) {
+        stmt->accept(this);
+    }
+    finishFunction();
+}
+
+void EscapeAnalysis::visit(const FunctionCall* call) {}
+
+void EscapeAnalysis::visit(const IntDeclaration* decl) {
+    declareLocal(decl->name);
+}
+
+void EscapeAnalysis::visit(const FloatDeclaration* decl) {
+    declareLocal(decl->name);
+}
+
+void EscapeAnalysis::visit(const StringDeclaration* decl) {
+    addCandidate(decl, decl->name, "str", decl->value.size(), decl->location.line);
+}
+
+void EscapeAnalysis::visit(const BoolDeclaration* decl) {
+    declareLocal(decl->name);
+}
+
+void EscapeAnalysis::visit(const ArrayDeclaration* decl) {
+    addCandidate(decl, decl->name, "array", decl->elements.size(), decl->location.line);
+    candidates.back().elementBytes = elementBytes(decl->elementType);
+}
+
+void EscapeAnalysis::visit(const VectorDeclaration* decl) {
+    declareLocal(decl->name);
+}
+
+void EscapeAnalysis::visit(const AssignmentExpression* expr) {
+    visitAssignment(expr->name, expr->expression.get());
+}
+
+void EscapeAnalysis::visit(const AssignmentStatement* stmt) {
+    visitAssignment(stmt->name, stmt->expression.get());
+}
+
+void EscapeAnalysis::visit(const PrimaryExpression* expr) {
+    bool captured = false;
+    int index = lookup(expr->name, &captured);
+    if (index < 0) {
+        return; // a literal, a global or a local that is not tracked
+    }
+    if (captured) {
+        markEscape(static_cast<std::size_t>(index), "captured by a parallel loop");
+    }
+    else if (!readOnly) {
+        markEscape(static_cast<std::size_t>(index), useReason);
+    }
+}
+
+void EscapeAnalysis::visit(const BinaryExpression* expr) {
+    int target = pendingConcat;
+    pendingConcat = -1;
+    if (target >= 0 && expr->op == "+") {
+        // The result is written to the target's buffer, so only the bytes added to it count
+        std::size_t index = static_cast<std::size_t>(target);
+        int selfOperands = 0;
+        std::uint64_t added = 0;
+        bool known = true;
+        for (const Expression* operand : { expr->left.get(), expr->right.get() }) {
+            if (lookup(operand->getName()) == target) {
+                ++selfOperands;
+            }
+            else if (isStringLiteral(*operand)) {
+                added += literalLength(*operand);
+            }
+            else {
+                known = false;
+            }
+        }
+        candidates[index].written = true;
+        functionConcats.emplace_back(expr, index);
+        if (selfOperands == 2) {
+            grow(index, std::nullopt, "it is concatenated with itself");
+        }
+        else if (!known) {
+            grow(index, std::nullopt, "it is built from a str of unknown length");
+        }
+        else {
+            grow(index, added, "");
+        }
+    }
+    // Every binary operator produces a new value: + copies the bytes of its operands
+    visitRead(expr->left.get());
+    visitRead(expr->right.get());
+}
+
+void EscapeAnalysis::visit(const UnaryExpression* expr) {
+    visitRead(expr->expr.get());
+}
+
+void EscapeAnalysis::visit(const MethodCall* expr) {
+    visitRead(expr->object.get());
+    int index = lookup(expr->object->getName());
+    if (index >= 0 && expr->name == "add") {
+        candidates[static_cast<std::size_t>(index)].written = true;
+        grow(static_cast<std::size_t>(index), 1, "");
+    }
+    for (const auto& argument : expr->arguments) {
+        visitRead(argument.get());
+    }
+}
+
+void EscapeAnalysis::visit(const CallExpression* expr) {
+    // Nothing is known about what the callee keeps
+    for (const auto& argument : expr->arguments) {
+        visitValue(argument.get(), "passed to '" + expr->name + "'");
+    }
+}
+
+void EscapeAnalysis::visit(const ConversionExpression* expr) {
+    visitRead(expr->expr.get());
+}
+
+void EscapeAnalysis::visit(const VectorExpression* expr) {
+    for (const auto& argument : expr->arguments) {
+        visitRead(argument.get());
+    }
+}
+
+void EscapeAnalysis::visit(const BuiltinCall* expr) {
+    // len() and the array built-ins read their arguments and return new values
+    for (const auto& argument : expr->arguments) {
+        visitRead(argument.get());
+    }
+}
+
+void EscapeAnalysis::visit(const PrintStatement* stmt) {
+    visitRead(stmt->expr.get());
+}
+
+void EscapeAnalysis::visit(const WhileLoopStatement* stmt) {
+    visitRead(stmt->condition.get());
+    loopTrips.push_back(std::nullopt);
+    stmt->body->accept(this);
+    loopTrips.pop_back();
+}
+
+void EscapeAnalysis::visit(const ForLoopStatement* stmt) {
+    visitRead(stmt->start.get());
+    visitRead(stmt->end.get());
+    if (stmt->step) {
+        visitRead(stmt->step.get());
+    }
+
+    std::size_t enclosingParallelScope = parallelScope;
+    scopes.emplace_back();
+    if (stmt->parallel) {
+        parallelScope = scopes.size() - 1;
+    }
+    if (!stmt->iteratorName.empty()) {
+        declareLocal(stmt->iteratorName);
+    }
+    loopTrips.push_back(tripCount(stmt));
+    stmt->body->accept(this);
+    loopTrips.pop_back();
+    scopes.pop_back();
+    parallelScope = enclosingParallelScope;
+}
+
+void EscapeAnalysis::visit(const IfStatement* stmt) {
+    // Both branches are counted, as if both ran
+    visitRead(stmt->condition.get());
+    stmt->thenBody->accept(this);
+    if (stmt->elseBody) {
+        stmt->elseBody->accept(this);
+    }
+}
+
+void EscapeAnalysis::visit(const ReturnStatement* stmt) {
+    if (stmt->expression) {
+        visitValue(stmt->expression.get(), "returned");
+    }
+}
+
+void EscapeAnalysis::visit(const BlockStatement* stmt) {
+    scopes.emplace_back();
+    for (const auto& decl : stmt->declarations) {
+        decl->accept(this);
+    }
+    for (const auto& statement : stmt->statements) {
+        statement->accept(this);
+    }
+    scopes.pop_back();
+}
+
+void EscapeAnalysis::visit(const ExpressionStatement* stmt) {
+    visitRead(stmt->expression.get());
+}
+
+void EscapeAnalysis::visit(const ArenaStatement* stmt) {
+    scopes.emplace_back();
+    for (const auto& decl : stmt->declarations) {
+        decl->accept(this);
+    }
+    stmt->body->accept(this);
+    scopes.pop_back();
+}
+
+const EscapeAnalysis::Allocation* EscapeAnalysis::find(const ASTNode* declaration, const std::string& name) const {
+    for (const auto& allocation : allocations) {
+        if (allocation.declaration == declaration && allocation.name == name) {
+            return &allocation;
+        }
+    }
+    return nullptr;
+}
+
+const EscapeAnalysis::Allocation* EscapeAnalysis::concatTarget(const BinaryExpression* concat) const {
+    auto it = concatTargets.find(concat);
+    if (it == concatTargets.end() || !allocations[it->second].onStack) {
+        return nullptr;
+    }
+    return &allocations[it->second];
+}
+
+const std::vector<EscapeAnalysis::Allocation>& EscapeAnalysis::getAllocations() const {
+    return allocations;
+}
+
+std::string EscapeAnalysis::report() const {
+    std::string result;
+    for (const auto& allocation : allocations) {
+        result += "escape: " + allocation.function + ":" + std::to_string(allocation.line) + ": " + allocation.kind + " '" + allocation.name + "' ";
+        if (!allocation.onStack) {
+            result += "not moved: " + allocation.reason + "\n";
+        }
+        else if (!allocation.bound) {
+            result += "on the stack (" + std::to_string(allocation.stackBytes) + " byte buffer, longer results go to a string arena: " + allocation.reason + ")\n";
+        }
+        else if (allocation.kind == "array") {
+            result += "on the stack (up to " + std::to_string(*allocation.bound) + " elements, " + std::to_string(allocation.stackBytes) + " bytes)\n";
+        }
+        else {
+            result += "on the stack (up to " + std::to_string(allocation.stackBytes) + " bytes)\n";
+        }
+    }
+    return result;
+}
+
+void EscapeAnalysis::addCandidate(const ASTNode* declaration, const std::string& name, const std::string& kind, std::uint64_t size, unsigned line) {
+    Candidate candidate;
+    candidate.allocation.function = functionName;
+    candidate.allocation.name = name;
+    candidate.allocation.kind = kind;
+    candidate.allocation.line = line;
+    candidate.allocation.declaration = declaration;
+    candidate.loopDepth = loopTrips.size();
+    candidate.size = size;
+    candidates.push_back(std::move(candidate));
+    scopes.back()[name] = static_cast<int>(candidates.size() - 1);
+}
+
+void EscapeAnalysis::declareLocal(const std::string& name) {
+    scopes.back()[name] = -1;
+}
+
+int EscapeAnalysis::lookup(const std::string& name, bool* captured) const {
+    for (std::size_t i = scopes.size(); i > 0; --i) {
+        auto it = scopes[i - 1].find(name);
+        if (it != scopes[i - 1].end()) {
+            if (captured) {
+                *captured = parallelScope != 0 && i - 1 < parallelScope;
+            }
+            return it->second;
+        }
+    }
+    return -1;
+}
+
+void EscapeAnalysis::grow(std::size_t index, std::optional<std::uint64_t> amount, const std::string& why) {
+    Candidate& candidate = candidates[index];
+    if (!candidate.bounded) {
+        return;
+    }
+    if (!amount) {
+        candidate.bounded = false;
+        candidate.unboundedReason = why;
+        return;
+    }
+    // Loops inside the declaration's scope repeat the growth; the ones around it re-create the value
+    std::uint64_t total = *amount;
+    for (std::size_t depth = candidate.loopDepth; depth < loopTrips.size(); ++depth) {
+        if (!loopTrips[depth]) {
+            candidate.bounded = false;
+            candidate.unboundedReason = "it grows in a loop without a constant trip count";
+            return;
+        }
+        if (*loopTrips[depth] != 0 && total > std::numeric_limits<std::uint64_t>::max() / 2 / *loopTrips[depth]) {
+            candidate.bounded = false;
+            candidate.unboundedReason = "it grows too much";
+            return;
+        }
+        total *= *loopTrips[depth];
+    }
+    if (total > std::numeric_limits<std::uint64_t>::max() / 2 - candidate.size) {
+        candidate.bounded = false;
+        candidate.unboundedReason = "it grows too much";
+        return;
+    }
+    candidate.size += total;
+}
+
+void EscapeAnalysis::markEscape(std::size_t index, const std::string& why) {
+    Candidate& candidate = candidates[index];
+    if (!candidate.escapes) {
+        candidate.escapes = true;
+        candidate.escapeReason = why;
+    }
+}
+
+void EscapeAnalysis::visitRead(const Expression* expr) {
+    bool enclosingReadOnly = readOnly;
+    readOnly = true;
+    expr->accept(this);
+    readOnly = enclosingReadOnly;
+}
+
+void EscapeAnalysis::visitValue(const Expression* expr, const std::string& why) {
+    bool enclosingReadOnly = readOnly;
+    std::string enclosingReason = useReason;
+    readOnly = false;
+    useReason = why;
+    expr->accept(this);
+    readOnly = enclosingReadOnly;
+    useReason = enclosingReason;
+}
+
+void EscapeAnalysis::visitAssignment(const std::string& name, const Expression* value) {
+    int target = lookup(name);
+    if (target >= 0 && candidates[static_cast<std::size_t>(target)].allocation.kind == "str") {
+        std::size_t index = static_cast<std::size_t>(target);
+        if (value->getName() == "binary") {
+            pendingConcat = target; // a str only takes the result of +
+        }
+        else if (isStringLiteral(*value)) {
+            grow(index, literalLength(*value), "");
+        }
+        else {
+            grow(index, std::nullopt, "it is assigned a str of unknown length");
+        }
+    }
+    // The stored value is a copy of whatever value names, which then lives on in `name`
+    visitValue(value, "stored in '" + name + "'");
+    pendingConcat = -1;
+}
+
+void EscapeAnalysis::finishFunction() {
+    for (std::size_t i = 0; i < candidates.size(); ++i) {
+        Candidate& candidate = candidates[i];
+        if (!candidate.written) {
+            continue; // nothing would be allocated for it
+        }
+        Allocation allocation = candidate.allocation;
+        std::uint64_t bytes = candidate.size * candidate.elementBytes;
+        if (candidate.escapes) {
+            allocation.reason = "it is " + candidate.escapeReason;
+        }
+        else if (candidate.bounded && bytes <= maxStackBytes) {
+            allocation.onStack = true;
+            allocation.bound = candidate.size;
+            allocation.stackBytes = bytes;
+        }
+        else if (allocation.kind == "str") {
+            // A small buffer still takes the common short strings off the heap
+            allocation.onStack = true;
+            allocation.stackBytes = unboundedStringBytes;
+            allocation.reason = candidate.bounded ? "it may need " + std::to_string(bytes) + " bytes" : candidate.unboundedReason;
+        }
+        else {
+            allocation.reason = candidate.bounded ? "it may need " + std::to_string(bytes) + " bytes" : candidate.unboundedReason;
+        }
+
+        allocations.push_back(allocation);
+        for (const auto& [concat, index] : functionConcats) {
+            if (index == i) {
+                concatTargets[concat] = allocations.size() - 1;
+            }
+        }
+    }
+}
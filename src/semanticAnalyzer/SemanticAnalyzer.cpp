@@ -2,30 +2,38 @@
 #include "../../include/symbolTable/SymbolTable.h"
 #include "../../include/ast/ASTNodes.h"
 
+#include <algorithm>
+#include <charconv>
+
 SemanticAnalyzer::SemanticAnalyzer(SymbolTable& symbolTable) : symbolTable(symbolTable) {}
 
 //Implementation of the visit methods
 
 void SemanticAnalyzer::visit(const IntDeclaration* decl) {
     if (symbolTable.isDeclared(decl->name)) {
-       throw std::runtime_error("int '" + decl->name + "' is already declared in this scope.");
+       throw std::runtime_error(decl->type + " '" + decl->name + "' is already declared in this scope.");
+    }
+    std::int64_t value = 0;
+    auto [end, error] = std::from_chars(decl->number.data(), decl->number.data() + decl->number.size(), value);
+    if (error != std::errc() || end != decl->number.data() + decl->number.size() || !integerFitsType(value, decl->type)) {
+        throw std::runtime_error("Value " + decl->number + " of '" + decl->name + "' does not fit in " + decl->type + ".");
     }
-    symbolTable.addVariable(decl->name, "int");
+    symbolTable.addVariable(decl->name, decl->type);
     
 }
 
 void SemanticAnalyzer::visit(const FloatDeclaration* decl) {
     if (symbolTable.isDeclared(decl->name)) {
-       throw std::runtime_error("flt '" + decl->name + "' is already declared in this scope.");
+       throw std::runtime_error(decl->type + " '" + decl->name + "' is already declared in this scope.");
     }
-    symbolTable.addVariable(decl->name, "float");
+    symbolTable.addVariable(decl->name, decl->type);
 }
 
 void SemanticAnalyzer::visit(const StringDeclaration* decl) {
     if (symbolTable.isDeclared(decl->name)) {
        throw std::runtime_error("str '" + decl->name + "' is already declared in this scope.");
     }
-    symbolTable.addVariable(decl->name, "string");
+    symbolTable.addVariable(decl->name, "string", "", arenaDepth);
 }
 
 void SemanticAnalyzer::visit(const BoolDeclaration* decl) {
@@ -40,22 +48,44 @@ void SemanticAnalyzer::visit(const ArrayDeclaration* decl) {
         throw std::runtime_error("Array '" + decl->name + "' is already declared in this scope.");
     }
 
-    // Assume all arrays are of integer type for simplicity
+    // Arrays hold one of the integer types; literals must fit in it
     for (const auto& element : decl->elements) {
         auto elemType = element->getType(symbolTable);
-        if (elemType != "int") {
-            throw std::runtime_error("Type mismatch in array initializer for '" + decl->name + "', expected 'int', found '" + elemType + "'.");
+        if (!isAssignableTo(*element, elemType, decl->elementType)) {
+            throw std::runtime_error("Type mismatch in array initializer for '" + decl->name + "', expected '" + decl->elementType + "', found '" + elemType + "'.");
         }
     }
 
     // Add the array to the symbol table
-    symbolTable.addVariable(decl->name, "array");
+    symbolTable.addVariable(decl->name, "array", decl->elementType, arenaDepth);
+}
+
+void SemanticAnalyzer::visit(const VectorDeclaration* decl) {
+    if (symbolTable.isDeclared(decl->name)) {
+        throw std::runtime_error(decl->type + " '" + decl->name + "' is already declared in this scope.");
+    }
+    unsigned lanes = vectorLanes(decl->type);
+    if (decl->elements.size() != 1 && decl->elements.size() != lanes) {
+        throw std::runtime_error(decl->type + " '" + decl->name + "' needs one value or " + std::to_string(lanes) + " values, found " + std::to_string(decl->elements.size()) + ".");
+    }
+    auto elementType = vectorElementType(decl->type);
+    for (const auto& element : decl->elements) {
+        auto type = element->getType(symbolTable);
+        if (!isAssignableTo(*element, type, elementType)) {
+            throw std::runtime_error("Type mismatch in vector initializer for '" + decl->name + "', expected '" + elementType + "', found '" + type + "'.");
+        }
+    }
+    symbolTable.addVariable(decl->name, decl->type);
 }
 
 void SemanticAnalyzer::visit(const AssignmentExpression* expr) {
     if (!insideFunction) {
         throw std::runtime_error("Assignment expressions must be inside a function definition.");
     }
+    if (isLoopVariable(expr->name)) {
+        throw std::runtime_error("Loop variable '" + expr->name + "' cannot be assigned inside its loop.");
+    }
+    checkParallelWrite(expr->name, expr->expression.get());
     auto varInfo = symbolTable.getSymbolInfo(expr->name);
     
     if (!varInfo.has_value()) {
@@ -63,10 +93,12 @@ void SemanticAnalyzer::visit(const AssignmentExpression* expr) {
        throw std::runtime_error("Variable " + expr->name + " not declared in assignment expression");
     }
     auto exprType = expr->expression->getType(symbolTable);
-    if (varInfo->type != exprType) {
+    if (!isAssignableTo(*expr->expression, exprType, varInfo->type)) {
        //std::cout << "Variable type: " << varInfo->type << " Expression type: " << exprType << "\n";
-       throw std::runtime_error("Type mismatch in assignment to " + expr->name);
+       throw std::runtime_error("Type mismatch in assignment to " + expr->name + ": expected " + varInfo->type + ", found " + exprType + ".");
     }
+    checkArenaEscape(expr->name, *varInfo, expr->expression.get());
+    expr->expression->accept(this);
 }
 
  void SemanticAnalyzer::visit(const BinaryExpression* expr) {
@@ -79,25 +111,23 @@ void SemanticAnalyzer::visit(const AssignmentExpression* expr) {
     std::cout << "We are visiting the binary expression\n";
     std::cout << "Binary expressions: Left type: " << leftType << " Right type: " << rightType << "\n";
 
-    if ((leftType != "int" || rightType != "int") || (leftType != "float" || rightType != "float")) {
-       throw std::runtime_error("Binary expressions only supports on integers and floats.");
-    }
+    expr->getType(symbolTable); // rejects mismatched operands and operators the operand types do not support
  }
 
 void SemanticAnalyzer::visit(const PrimaryExpression* expr) {
    
     auto type= expr->getType(symbolTable);
         
-        if (!(type == "int" || type == "float" || type == "string" || type == "bool")) {
-           throw std::runtime_error("Primary expressions support integers, floats, strings, and booleans.");
+        if (!(isNumericType(type) || isVectorType(type) || type == "string" || type == "bool")) {
+           throw std::runtime_error("Primary expressions support integers, floats, vectors, strings, and booleans.");
         }
 }
 
 void SemanticAnalyzer::visit(const UnaryExpression* expr) {
 
     auto exprType = expr->expr->getType(symbolTable);
-    if (exprType != "int" || exprType != "float") {
-       throw std::runtime_error("Unary operations only supports integers and floats.");
+    if (expr->op == "not" ? exprType != "bool" && !isMaskType(exprType) : !isNumericType(exprType) && !isVectorType(exprType)) {
+       throw std::runtime_error("Unary operations only supports integers, floats and vectors, or booleans and masks for 'not'.");
     }
 
 }
@@ -114,14 +144,17 @@ void SemanticAnalyzer::visit(const MethodCall* expr) {
             throw std::runtime_error("Method '" + expr->name + "' is not supported by '" + objectInfo->type + "'.");
         }
     }
+    if (parallelLoop && (expr->name == "add" || expr->name == "remove")) {
+        throw std::runtime_error("Array '" + expr->object->getName() + "' cannot be modified inside a parallel loop.");
+    }
 
     if (expr->name == "add") {
         if (expr->arguments.size() != 1) {
             throw std::runtime_error("Method 'add' expects one argument.");
         }
         auto argType = expr->arguments[0]->getType(symbolTable);
-        if (argType != "int") {
-            throw std::runtime_error("Invalid argument type for 'add', expected 'int', found '" + argType + "'.");
+        if (!isAssignableTo(*expr->arguments[0], argType, objectInfo->elementType)) {
+            throw std::runtime_error("Invalid argument type for 'add', expected '" + objectInfo->elementType + "', found '" + argType + "'.");
         }
     }
     else if (expr->name == "remove") {
@@ -131,29 +164,125 @@ void SemanticAnalyzer::visit(const MethodCall* expr) {
     }
 }
 
+void SemanticAnalyzer::visit(const CallExpression* expr) {
+    if (!insideFunction) {
+        throw std::runtime_error("Function calls in expressions must be inside a function definition.");
+    }
+    auto funcInfo = symbolTable.getFunctionInfo(expr->name);
+    if (!funcInfo) {
+        throw std::runtime_error("Function " + expr->name + " not declared.");
+    }
+    if (expr->arguments.size() != funcInfo->parameterInfo.size()) {
+        throw std::runtime_error("Function '" + expr->name + "' called with incorrect number of arguments. Expected " + std::to_string(funcInfo->parameterInfo.size()) + ", got " + std::to_string(expr->arguments.size()) + ".");
+    }
+    for (std::size_t i = 0; i < expr->arguments.size(); ++i) {
+        auto argType = normalizeType(expr->arguments[i]->getType(symbolTable));
+        auto paramType = normalizeType(funcInfo->parameterInfo[i].type);
+        if (!isAssignableTo(*expr->arguments[i], argType, paramType)) {
+            throw std::runtime_error("Argument " + std::to_string(i + 1) + " of call to '" + expr->name + "' is " + argType + ", expected " + paramType + ".");
+        }
+        // The callee could keep the string in a global, past the end of the arena
+        if (stringArena(*expr->arguments[i]) > 0) {
+            throw std::runtime_error("Argument " + std::to_string(i + 1) + " of call to '" + expr->name + "' is a str allocated in an arena block and cannot be passed to a function.");
+        }
+        expr->arguments[i]->accept(this);
+    }
+
+    // Its result is returned unchanged, so the caller's frame is no longer needed once the call starts
+    expr->tailCall = expr == tailPosition;
+
+    if (expr->name == currentFunction->name && !expr->tailCall && currentFunction->hasAnnotation("tailrec")) {
+        throw std::runtime_error("Recursive call to '" + expr->name + "' is not in tail position, which @tailrec requires.");
+    }
+}
+
+void SemanticAnalyzer::visit(const ConversionExpression* expr) {
+    auto fromType = expr->expr->getType(symbolTable);
+    if (!isNumericType(fromType)) {
+        throw std::runtime_error("Only numbers can be converted to " + expr->targetType + ", found " + fromType + ".");
+    }
+    expr->expr->accept(this);
+}
+
+void SemanticAnalyzer::visit(const VectorExpression* expr) {
+    if (!insideFunction) {
+        throw std::runtime_error("Vector expressions must be inside a function definition.");
+    }
+    unsigned lanes = vectorLanes(expr->type);
+    auto elementType = vectorElementType(expr->type);
+    if (expr->arguments.size() == 1) {
+        auto type = expr->arguments[0]->getType(symbolTable);
+        // One value is splatted across the lanes; a vector of the same width is converted lane by lane
+        bool converts = isVectorType(type) && vectorLanes(type) == lanes;
+        if (!converts && type != elementType && !isAssignableTo(*expr->arguments[0], type, elementType)) {
+            throw std::runtime_error(expr->type + "(...) expects a " + sourceTypeName(elementType) + " or a vector of " + std::to_string(lanes) + " lanes, found " + type + ".");
+        }
+    }
+    else if (expr->arguments.size() == lanes) {
+        for (const auto& argument : expr->arguments) {
+            auto type = argument->getType(symbolTable);
+            if (!isAssignableTo(*argument, type, elementType)) {
+                throw std::runtime_error("Lane values of " + expr->type + " must be " + sourceTypeName(elementType) + ", found " + type + ".");
+            }
+        }
+    }
+    else {
+        throw std::runtime_error(expr->type + "(...) expects one value or " + std::to_string(lanes) + " lane values, got " + std::to_string(expr->arguments.size()) + ".");
+    }
+    for (const auto& argument : expr->arguments) {
+        argument->accept(this);
+    }
+}
+
+void SemanticAnalyzer::visit(const BuiltinCall* expr) {
+    if (!insideFunction) {
+        throw std::runtime_error("Built-in calls must be inside a function definition.");
+    }
+    expr->getType(symbolTable); // rejects unknown built-ins and arguments of the wrong type or count
+    if (parallelLoop && expr->name == "store") {
+        throw std::runtime_error("Array '" + expr->arguments[0]->getName() + "' cannot be stored to inside a parallel loop.");
+    }
+    // extractelement with a constant index past the last lane is poison, not a run-time error
+    if (expr->name == "lane") {
+        auto index = expr->arguments[1]->getIntegerConstant();
+        unsigned lanes = vectorLanes(expr->arguments[0]->getType(symbolTable));
+        if (index.has_value() && (*index < 0 || *index >= static_cast<std::int64_t>(lanes))) {
+            throw std::runtime_error("Lane " + std::to_string(*index) + " is out of range for a vector of " + std::to_string(lanes) + " lanes.");
+        }
+    }
+    for (std::size_t i = expr->takesArray() ? 1 : 0; i < expr->arguments.size(); ++i) {
+        expr->arguments[i]->accept(this);
+    }
+}
+
 void SemanticAnalyzer::visit(const PrintStatement* stmt) {
     if (!insideFunction) {
         throw std::runtime_error("Print statement must be inside a function definition.");
     }
     auto exprType = stmt->expr->getType(symbolTable);
+    checkParallelReads(stmt->expr.get());
 
     std::cout << "We are visiting the print statement" << std::endl;
     //std::cout << "Expression type: " << exprType << std::endl;
 
-    if (exprType != "int" && exprType != "float" && exprType != "string" && exprType != "bool") {
-       throw std::runtime_error("Print statement only supports int, float, string, and bool types");
+    if (!isNumericType(exprType) && exprType != "string" && exprType != "bool") {
+       throw std::runtime_error("Print statement only supports numeric, string, and bool types");
     }
+    stmt->expr->accept(this);
 }
 
 void SemanticAnalyzer::visit(const WhileLoopStatement* stmt) {
     if (!insideFunction) {
        throw std::runtime_error("While loops must be inside a function definition.");
     }
+    checkLoopAnnotations(stmt->annotations);
     symbolTable.enterScope();
     auto conditionType = stmt->condition->getType(symbolTable);
     if (conditionType != "bool") {
        throw std::runtime_error("While condition must be boolean");
     }
+    checkParallelReads(stmt->condition.get());
+    stmt->condition->accept(this);
     
     stmt->body->accept(this);
     symbolTable.leaveScope();
@@ -163,14 +292,65 @@ void SemanticAnalyzer::visit(const ForLoopStatement* stmt) {
     if (!insideFunction) {
         throw std::runtime_error("For loops must be inside a function definition.");
     }
+    checkLoopAnnotations(stmt->annotations);
+    if (stmt->parallel) {
+        checkParallelLoop(stmt);
+    }
     symbolTable.enterScope();
     auto start = stmt->start->getType(symbolTable);
     auto end = stmt->end->getType(symbolTable);
-    if (start != "int" || end != "int") {
+    if (!isIntegerType(start) || !isIntegerType(end)) {
        throw std::runtime_error("\"For loop\" start and end values must be integers.");
     }
+    checkParallelReads(stmt->start.get());
+    checkParallelReads(stmt->end.get());
+    // The iterator counts in the type of the bounds, so range(0, n) with an i64 n counts in i64
+    auto iteratorType = commonOperandType(*stmt->start, start, *stmt->end, end);
+    if (iteratorType.empty()) {
+       throw std::runtime_error("\"For loop\" bounds have different types, " + start + " and " + end + "; convert one explicitly.");
+    }
+    if (stmt->parallel && iteratorType != "int") {
+       throw std::runtime_error("Parallel loops only support int bounds.");
+    }
+
+    // The step decides the loop direction, so it has to be known at compile time
+    if (stmt->step) {
+        auto step = stmt->step->getIntegerConstant();
+        if (!step.has_value() || *step == 0) {
+            throw std::runtime_error("\"For loop\" step must be a non-zero integer literal.");
+        }
+        // The iterator is advanced by the step in its own type, which would truncate a wider step
+        if (!integerFitsType(*step, iteratorType)) {
+            throw std::runtime_error("\"For loop\" step " + std::to_string(*step) + " does not fit in the loop's " + iteratorType + " iterator.");
+        }
+    }
+
+    if (!stmt->iteratorName.empty()) {
+        if (symbolTable.isDeclared(stmt->iteratorName)) {
+            throw std::runtime_error("Loop variable '" + stmt->iteratorName + "' is already declared in this scope.");
+        }
+        symbolTable.addVariable(stmt->iteratorName, iteratorType);
+        loopVariables.push_back(stmt->iteratorName);
+    }
+
+    const ForLoopStatement* enclosingParallelLoop = parallelLoop;
+    int enclosingParallelScopeId = parallelScopeId;
+    int enclosingArenaDepth = arenaDepth;
+    if (stmt->parallel) {
+        parallelLoop = stmt;
+        parallelScopeId = symbolTable.getCurrentScopeId();
+        arenaDepth = 0; // The outlined body allocates from its worker thread's memory, not the arena
+    }
    
     stmt->body->accept(this);
+
+    parallelLoop = enclosingParallelLoop;
+    parallelScopeId = enclosingParallelScopeId;
+    arenaDepth = enclosingArenaDepth;
+
+    if (!stmt->iteratorName.empty()) {
+        loopVariables.pop_back();
+    }
     symbolTable.leaveScope();
 }
 
@@ -179,14 +359,20 @@ void SemanticAnalyzer::visit(const AssignmentStatement* stmt) {
         throw std::runtime_error("Assignment expressions must be inside a function definition.");
     }
     std::cout << "We are visiting the assignment statement\n";
+    if (isLoopVariable(stmt->name)) {
+        throw std::runtime_error("Loop variable '" + stmt->name + "' cannot be assigned inside its loop.");
+    }
+    checkParallelWrite(stmt->name, stmt->expression.get());
     auto varInfo = symbolTable.getSymbolInfo(stmt->name);
     if (!varInfo) {
        throw std::runtime_error("Variable " + stmt->name + " not declared?!?!");
     }
     auto exprType = stmt->expression->getType(symbolTable);
-    if (varInfo->type != exprType) {
-       throw std::runtime_error("Type mismatch for " + stmt->name + " in assignment statement.");
+    if (!isAssignableTo(*stmt->expression, exprType, varInfo->type)) {
+       throw std::runtime_error("Type mismatch for " + stmt->name + " in assignment statement: expected " + varInfo->type + ", found " + exprType + ".");
     }
+    checkArenaEscape(stmt->name, *varInfo, stmt->expression.get());
+    stmt->expression->accept(this);
 }
 
 void SemanticAnalyzer::visit(const IfStatement* stmt) {
@@ -198,6 +384,8 @@ void SemanticAnalyzer::visit(const IfStatement* stmt) {
     if (conditionType != "bool") {
         throw std::runtime_error("If condition must be boolean");
     }
+    checkParallelReads(stmt->condition.get());
+    stmt->condition->accept(this);
 
     // Then body
     symbolTable.enterScope();
@@ -216,29 +404,28 @@ void SemanticAnalyzer::visit(const ReturnStatement* stmt) {
     if (!insideFunction) {
        throw std::runtime_error("Return statement must be inside a function definition.");
     }
+    if (parallelLoop) {
+        throw std::runtime_error("Return statements are not allowed inside a parallel loop.");
+    }
     auto exprType = stmt->expression->getType(symbolTable);
 
-    if (!(exprType == "int" || exprType == "float" || exprType == "string" || exprType == "bool")) {
-       throw std::runtime_error("Return statement only supports int, float, string, and bool types");
+    if (!(isNumericType(exprType) || isVectorType(exprType) || exprType == "string" || exprType == "bool")) {
+       throw std::runtime_error("Return statement only supports numeric, vector, string, and bool types");
     }
 
-    if (currentFunctionReturnType == "str") {
-        currentFunctionReturnType = "string";
-    }
-    else if (currentFunctionReturnType == "flt") {
-		currentFunctionReturnType = "float";
-	}
-    else if (currentFunctionReturnType == "int") {
-		currentFunctionReturnType = "int";
-	}
-    else if (currentFunctionReturnType == "bool") {
-		currentFunctionReturnType = "bool";
-	}
+    currentFunctionReturnType = normalizeType(currentFunctionReturnType);
 
-    if (exprType != currentFunctionReturnType) {
+    if (!isAssignableTo(*stmt->expression, exprType, currentFunctionReturnType)) {
         std::cout << "currentFunctionReturnType: " << currentFunctionReturnType << " exprType: " << exprType << "\n";
        throw std::runtime_error("Return type does not match function return type.");
     }
+    if (stringArena(*stmt->expression) > 0) {
+        throw std::runtime_error("A str allocated in an arena block cannot be returned; the arena is released when the function returns.");
+    }
+
+    tailPosition = stmt->expression.get();
+    stmt->expression->accept(this);
+    tailPosition = nullptr;
 }
 
 void SemanticAnalyzer::visit(const BlockStatement* stmt) {
@@ -246,6 +433,9 @@ void SemanticAnalyzer::visit(const BlockStatement* stmt) {
         throw std::runtime_error("Block statement must be inside a function definition.");
     }
     symbolTable.enterScope();
+    for (const auto& decl : stmt->declarations) {
+        decl->accept(this);
+    }
     
     for (const auto& statement : stmt->statements) {
         statement->accept(this);
@@ -261,22 +451,37 @@ void SemanticAnalyzer::visit(const ExpressionStatement* stmt) {
      stmt->expression->accept(this);
 }
 
+void SemanticAnalyzer::visit(const ArenaStatement* stmt) {
+    if (!insideFunction) {
+        throw std::runtime_error("Arena blocks must be inside a function definition.");
+    }
+    if (parallelLoop) {
+        throw std::runtime_error("Arena blocks are not allowed inside a parallel loop.");
+    }
+    symbolTable.enterScope();
+    ++arenaDepth;
+    for (const auto& decl : stmt->declarations) {
+        decl->accept(this);
+    }
+    stmt->body->accept(this);
+    --arenaDepth;
+    symbolTable.leaveScope();
+}
+
 void SemanticAnalyzer::visit(const FunctionDefinition* funcDef) {
     
-    FunctionInfo info;
-    info.name = funcDef->name;
-    info.parameterInfo = funcDef->parameters;
-    currentFunctionReturnType = funcDef->returnType;
-
-    if (!symbolTable.addFunction(funcDef->name, info)) {
-       throw std::runtime_error("Function " + funcDef->name + " is already declared.");
+    // Signatures are registered up front by visit(Program); a definition visited on its own registers itself
+    if (!symbolTable.getFunctionInfo(funcDef->name)) {
+        declareFunction(funcDef);
     }
+    currentFunctionReturnType = funcDef->returnType;
 
     symbolTable.enterScope();
     insideFunction = true;
+    currentFunction = funcDef;
 
     for (const auto& param : funcDef->parameters) {
-        if (!symbolTable.addVariable(param.name, param.type)) {
+        if (!symbolTable.addVariable(param.name, normalizeType(param.type))) {
            throw std::runtime_error("Parameter " + param.name + " is already declared.");
         }
     }
@@ -287,6 +492,7 @@ void SemanticAnalyzer::visit(const FunctionDefinition* funcDef) {
 
     symbolTable.leaveScope();
     insideFunction = false;
+    currentFunction = nullptr;
 }
 
 void SemanticAnalyzer::visit(const FunctionCall* call) {
@@ -305,6 +511,12 @@ void SemanticAnalyzer::visit(const FunctionCall* call) {
 
 void SemanticAnalyzer::visit(const Program* program) {
     
+    // Every signature is known before any body is checked, so functions can call each other in any order
+    for (const auto& func : program->functions) {
+        if (const FunctionDefinition* funcDef = func->getDefinition()) {
+            declareFunction(funcDef);
+        }
+    }
     for (const auto& decl : program->declarations) {
         decl->accept(this);        
     }
@@ -318,4 +530,202 @@ void SemanticAnalyzer::visit(const Program* program) {
         func->accept(this);
     }
 
-}
\ No newline at end of file
+}
+
+void SemanticAnalyzer::declareExternalFunction(const FunctionDefinition* funcDef) {
+    FunctionInfo info;
+    info.name = funcDef->name;
+    info.returnType = normalizeType(funcDef->returnType);
+    info.parameterInfo = funcDef->parameters;
+
+    if (!symbolTable.addFunction(funcDef->name, info)) {
+       throw std::runtime_error("Function " + funcDef->name + " is already declared in another file.");
+    }
+}
+
+bool SemanticAnalyzer::isLoopVariable(const std::string& name) const {
+    return std::find(loopVariables.begin(), loopVariables.end(), name) != loopVariables.end();
+}
+
+// Loop pragmas: @unroll, @unroll(N), @nounroll, @vectorize, @vectorize(width=N), @interleave(N)
+void SemanticAnalyzer::checkLoopAnnotations(const std::vector<Annotation>& annotations) const {
+    auto parseCount = [](const Annotation& annotation, const std::string& value) {
+        unsigned count = 0;
+        auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), count);
+        if (error != std::errc() || end != value.data() + value.size() || count == 0) {
+            throw std::runtime_error("Annotation @" + annotation.name + " expects a positive integer, got '" + value + "'.");
+        }
+        return count;
+    };
+
+    std::vector<std::string> seen;
+    for (const auto& annotation : annotations) {
+        if (std::find(seen.begin(), seen.end(), annotation.name) != seen.end()) {
+            throw std::runtime_error("Annotation @" + annotation.name + " is given more than once on the same loop.");
+        }
+        seen.push_back(annotation.name);
+
+        if (annotation.name == "unroll" || annotation.name == "interleave") {
+            if (annotation.arguments.size() > 1 || (annotation.name == "interleave" && annotation.arguments.empty())) {
+                throw std::runtime_error("Annotation @" + annotation.name + " takes a single count, e.g. @" + annotation.name + "(4).");
+            }
+            for (const auto& [key, value] : annotation.arguments) {
+                if (!key.empty()) {
+                    throw std::runtime_error("Annotation @" + annotation.name + " does not take named arguments.");
+                }
+                parseCount(annotation, value);
+            }
+        }
+        else if (annotation.name == "nounroll") {
+            if (!annotation.arguments.empty()) {
+                throw std::runtime_error("Annotation @nounroll does not take arguments.");
+            }
+        }
+        else if (annotation.name == "vectorize") {
+            for (const auto& [key, value] : annotation.arguments) {
+                if (key != "width") {
+                    throw std::runtime_error("Annotation @vectorize only accepts 'width', e.g. @vectorize(width=8).");
+                }
+                unsigned width = parseCount(annotation, value);
+                if ((width & (width - 1)) != 0) {
+                    throw std::runtime_error("Vectorize width must be a power of two, got " + value + ".");
+                }
+            }
+        }
+        else {
+            throw std::runtime_error("Unknown loop annotation @" + annotation.name + ".");
+        }
+    }
+
+    bool unroll = std::find(seen.begin(), seen.end(), "unroll") != seen.end();
+    bool noUnroll = std::find(seen.begin(), seen.end(), "nounroll") != seen.end();
+    if (unroll && noUnroll) {
+        throw std::runtime_error("Annotations @unroll and @nounroll cannot be used on the same loop.");
+    }
+}
+
+void SemanticAnalyzer::checkParallelLoop(const ForLoopStatement* stmt) const {
+    if (parallelLoop) {
+        throw std::runtime_error("Parallel loops cannot be nested.");
+    }
+    if (stmt->step) {
+        throw std::runtime_error("Parallel loops only support a step of 1.");
+    }
+
+    std::vector<std::string> reduced;
+    for (const auto& reduction : stmt->reductions) {
+        auto varInfo = symbolTable.getSymbolInfo(reduction.variable);
+        if (!varInfo) {
+            throw std::runtime_error("Reduction variable '" + reduction.variable + "' is not declared.");
+        }
+        if (!isNumericType(varInfo->type)) {
+            throw std::runtime_error("Reduction variable '" + reduction.variable + "' must be an integer or floating-point number.");
+        }
+        if (reduction.variable == stmt->iteratorName || isLoopVariable(reduction.variable)) {
+            throw std::runtime_error("Loop variable '" + reduction.variable + "' cannot be a reduction variable.");
+        }
+        if (std::find(reduced.begin(), reduced.end(), reduction.variable) != reduced.end()) {
+            throw std::runtime_error("Variable '" + reduction.variable + "' is reduced more than once.");
+        }
+        reduced.push_back(reduction.variable);
+    }
+}
+
+// Iterations of a parallel loop run concurrently, so shared variables may only be
+// updated through their reduction, e.g. total = total + i for reduce(+: total).
+// Variables declared in the body are local to an iteration and may be written freely.
+void SemanticAnalyzer::checkParallelWrite(const std::string& name, const Expression* value) const {
+    if (!parallelLoop) {
+        return;
+    }
+    auto symbol = symbolTable.getSymbolInfo(name);
+    if (symbol && symbol->scopeId >= parallelScopeId) {
+        checkParallelReads(value);
+        return;
+    }
+    for (const auto& reduction : parallelLoop->reductions) {
+        if (reduction.variable == name) {
+            if (!value->isUpdateOf(name, reduction.op)) {
+                throw std::runtime_error("Reduction variable '" + name + "' can only be updated as " + name + " = " + name + " " + reduction.op + " <value> inside a parallel loop.");
+            }
+            checkParallelReads(value, name);
+            return;
+        }
+    }
+    throw std::runtime_error("Shared variable '" + name + "' cannot be written inside a parallel loop; declare it with reduce(+: " + name + ").");
+}
+
+// Inside a parallel loop a reduction variable holds only the current worker's partial
+// result, so apart from the one read in its own update it cannot be read there.
+void SemanticAnalyzer::checkParallelReads(const Expression* value, const std::string& updated) const {
+    if (!parallelLoop) {
+        return;
+    }
+    for (const auto& reduction : parallelLoop->reductions) {
+        auto symbol = symbolTable.getSymbolInfo(reduction.variable);
+        if (symbol && symbol->scopeId >= parallelScopeId) {
+            continue; // hidden by a variable the body declares itself
+        }
+        if (value->countReads(reduction.variable) > (reduction.variable == updated ? 1 : 0)) {
+            throw std::runtime_error("Reduction variable '" + reduction.variable + "' cannot be read inside a parallel loop except in its own update; its value is only known after the loop.");
+        }
+    }
+}
+
+// Arena depth of the memory a str value may point into: + allocates in the innermost
+// arena block, a variable holds what was allocated at its own depth, anything else is 0.
+int SemanticAnalyzer::stringArena(const Expression& value) {
+    if (value.getType(symbolTable) != "string") {
+        return 0;
+    }
+    if (value.getName() == "binary") {
+        return arenaDepth;
+    }
+    auto info = symbolTable.getSymbolInfo(value.getName());
+    return info ? info->arenaDepth : 0;
+}
+
+// A str must not outlive the arena it was allocated in, so it may only be stored
+// in variables declared in that arena block or a block nested inside it.
+void SemanticAnalyzer::checkArenaEscape(const std::string& name, const SymbolInfo& target, const Expression* value) {
+    if (target.type == "string" && stringArena(*value) > target.arenaDepth) {
+        throw std::runtime_error("The str assigned to '" + name + "' is allocated in an arena block that ends before '" + name + "' does; declare '" + name + "' inside that block.");
+    }
+}
+
+void SemanticAnalyzer::declareFunction(const FunctionDefinition* funcDef) {
+    checkFunctionAnnotations(funcDef);
+
+    FunctionInfo info;
+    info.name = funcDef->name;
+    info.returnType = normalizeType(funcDef->returnType);
+    info.parameterInfo = funcDef->parameters;
+
+    if (!symbolTable.addFunction(funcDef->name, info)) {
+       throw std::runtime_error("Function " + funcDef->name + " is already declared.");
+    }
+}
+
+// Function annotations: @tailrec, @inline, @noinline, @hot, @cold
+void SemanticAnalyzer::checkFunctionAnnotations(const FunctionDefinition* funcDef) const {
+    static const std::vector<std::string> known = { "tailrec", "inline", "noinline", "hot", "cold" };
+    std::vector<std::string> seen;
+    for (const auto& annotation : funcDef->annotations) {
+        if (std::find(known.begin(), known.end(), annotation.name) == known.end()) {
+            throw std::runtime_error("Unknown function annotation @" + annotation.name + " on '" + funcDef->name + "'.");
+        }
+        if (!annotation.arguments.empty()) {
+            throw std::runtime_error("@" + annotation.name + " does not take arguments.");
+        }
+        if (std::find(seen.begin(), seen.end(), annotation.name) != seen.end()) {
+            throw std::runtime_error("Duplicate @" + annotation.name + " on '" + funcDef->name + "'.");
+        }
+        seen.push_back(annotation.name);
+    }
+    if (funcDef->hasAnnotation("inline") && funcDef->hasAnnotation("noinline")) {
+        throw std::runtime_error("'" + funcDef->name + "' cannot be both @inline and @noinline.");
+    }
+    if (funcDef->hasAnnotation("hot") && funcDef->hasAnnotation("cold")) {
+        throw std::runtime_error("'" + funcDef->name + "' cannot be both @hot and @cold.");
+    }
+}
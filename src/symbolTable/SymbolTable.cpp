@@ -15,7 +15,7 @@ void SymbolTable::leaveScope() {
     }
 }
 
-bool SymbolTable::addVariable(const std::string& name, const std::string& type) {
+bool SymbolTable::addVariable(const std::string& name, const std::string& type, const std::string& elementType, int arenaDepth) {
     //std::cout << "Adding a variable with name: " << name << " and type: " << type << "\n";
     
     if (scopes.empty()) {
@@ -28,7 +28,7 @@ bool SymbolTable::addVariable(const std::string& name, const std::string& type)
         return false; 
     }
 
-    SymbolInfo info = {type, currentScopeId};
+    SymbolInfo info = {type, currentScopeId, elementType, arenaDepth};
     currentScope[name] = info;
     //std::cout << "printing info: " << "type: " + info.type << " scopeId: " << info.scopeId << "\n";
     return true;
@@ -49,6 +49,10 @@ bool SymbolTable::isDeclared(const std::string& name) {
     return false;
 }
 
+int SymbolTable::getCurrentScopeId() const {
+    return currentScopeId;
+}
+
 std::optional<SymbolInfo> SymbolTable::getSymbolInfo(const std::string& name) {
     auto tempScopes = scopes;
     while (!tempScopes.empty()) {
@@ -0,0 +1,156 @@
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "generateMachineCode/ParallelCodeGen.h"
+
+// End-to-end checks: SSLang (SSL_COMPILER) compiles a test program in a scratch directory,
+// the C++ compiler (SSL_LINKER) links its object files with the runtime (SSL_RUNTIME_LIBRARY)
+// and the program has to print what a plain single-threaded build prints.
+
+namespace fs = std::filesystem;
+
+void report(bool passed, const std::string& test, const std::string& failure = "") {
+    if (passed) {
+        std::cout << "\033[32mTest Passed\033[0m" << " " << test << std::endl;
+    }
+    else {
+        std::cerr << "\033[31mTest Failed\033[0m" << " " << test << " with error: " << failure << std::endl;
+    }
+}
+
+std::string readFile(const fs::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+// A fresh directory with the llvmGenerated and genObjectFile folders SSLang writes into
+fs::path scratchDirectory(const std::string& name) {
+    fs::path directory = fs::temp_directory_path() / ("sslang_build_tests_" + name);
+    fs::remove_all(directory);
+    fs::create_directories(directory / "llvmGenerated");
+    fs::create_directories(directory / "genObjectFile");
+    return directory;
+}
+
+// Runs command in directory with its output in log
+bool run(const std::string& command, const fs::path& directory, std::string& failure, const std::string& log = "command.log") {
+    std::string inDirectory = "cd \"" + directory.string() + "\" && " + command + " > " + log + " 2>&1";
+    if (std::system(inDirectory.c_str()) != 0) {
+        failure = "'" + command + "' failed:\n" + readFile(directory / log);
+        return false;
+    }
+    return true;
+}
+
+// Compiles sources with flags, links every optimized object file SSLang wrote and returns what the program printed
+bool buildAndRun(const std::vector<std::string>& sources, const std::string& flags, const fs::path& directory, std::string& output, std::string& failure) {
+    std::string compile = std::string("\"") + SSL_COMPILER + "\" " + flags;
+    for (const auto& source : sources) {
+        compile += " \"" + fs::absolute(source).string() + "\"";
+    }
+    if (!run(compile, directory, failure)) {
+        return false;
+    }
+
+    std::string link = std::string("\"") + SSL_LINKER + "\"";
+    for (const auto& entry : fs::directory_iterator(directory / "genObjectFile")) {
+        std::string name = entry.path().filename().string();
+        if (name.rfind("optimized_", 0) == 0 && entry.path().extension() == ".o") {
+            link += " \"genObjectFile/" + name + "\"";
+        }
+    }
+    link += std::string(" \"") + SSL_RUNTIME_LIBRARY + "\" -pthread -o program";
+    if (!run(link, directory, failure) || !run("./program", directory, failure, "output.txt")) {
+        return false;
+    }
+    output = readFile(directory / "output.txt");
+    return true;
+}
+
+void checkPartitionFilenames() {
+    std::string failure;
+    std::string object = ParallelCodeGen::partitionFilename("genObjectFile/optimized_x.o", 2);
+    std::string ir = ParallelCodeGen::partitionFilename("llvmGenerated/optimized_x.ll", 0);
+    std::string dotted = ParallelCodeGen::partitionFilename("out.d/prog.v2.o", 11);
+    if (object != "genObjectFile/optimized_x.2.o") {
+        failure = "object partition 2 is " + object;
+    }
+    else if (ir != "llvmGenerated/optimized_x.0.ll") {
+        failure = "IR partition 0 is " + ir;
+    }
+    else if (dotted != "out.d/prog.v2.11.o") {
+        failure = "partition 11 of out.d/prog.v2.o is " + dotted;
+    }
+    else if (ParallelCodeGen::partitionFilename("genObjectFile/optimized_x.o", 2) != object) {
+        failure = "the same partition got two names";
+    }
+    report(failure.empty(), "partitionFilename", failure);
+}
+
+// --jobs=1 compiles the module in one piece; --jobs=3 splits it, and two --jobs=3 builds have to split it the same way
+void checkParallelCodeGen(const std::string& source) {
+    const std::string expected = "sum\n328350\n9\n545\n";
+    std::string serialOutput;
+    std::string failure;
+    fs::path serial = scratchDirectory("serial");
+    if (!buildAndRun({ source }, "--jobs=1", serial, serialOutput, failure) || serialOutput != expected) {
+        report(false, "--jobs=1", failure.empty() ? "printed \"" + serialOutput + "\"" : failure);
+        return;
+    }
+    report(true, "--jobs=1");
+
+    std::vector<std::string> partitionIR[2];
+    for (int build = 0; build < 2; ++build) {
+        std::string output;
+        fs::path directory = scratchDirectory("parallel" + std::to_string(build));
+        if (!buildAndRun({ source }, "--jobs=3", directory, output, failure)) {
+            report(false, "--jobs=3", failure);
+            return;
+        }
+        if (output != serialOutput) {
+            report(false, "--jobs=3", "printed \"" + output + "\" instead of \"" + serialOutput + "\"");
+            return;
+        }
+        std::string stem = "llvmGenerated/optimized_" + fs::path(source).stem().string() + ".ll";
+        for (unsigned i = 0; fs::exists(directory / ParallelCodeGen::partitionFilename(stem, i)); ++i) {
+            partitionIR[build].push_back(readFile(directory / ParallelCodeGen::partitionFilename(stem, i)));
+        }
+    }
+    report(true, "--jobs=3");
+
+    if (partitionIR[0].size() != 3) {
+        failure = std::to_string(partitionIR[0].size()) + " partitions instead of 3";
+    }
+    else if (partitionIR[0] != partitionIR[1]) {
+        failure = "two builds split the module differently";
+    }
+    report(failure.empty(), "--jobs=3 partitions are deterministic", failure);
+}
+
+// --thin-lto builds the two files as one program, with each file's helpers inlined into the other; a
+// rebuild takes both backends from the cache and has to link and print the same
+void checkThinLTO(const std::string& mainSource, const std::string& helperSource) {
+    const std::string expected = "332833500\n";
+    fs::path directory = scratchDirectory("thinlto");
+    for (const char* build : { "--thin-lto", "--thin-lto rebuild" }) {
+        std::string output;
+        std::string failure;
+        if (!buildAndRun({ mainSource, helperSource }, "--thin-lto", directory, output, failure)) {
+            report(false, build, failure);
+            return;
+        }
+        report(output == expected, build, "printed \"" + output + "\" instead of \"" + expected + "\"");
+    }
+}
+
+int main() {
+    checkPartitionFilenames();
+    checkParallelCodeGen("../../tests/build_testing/test_partitions.ssl");
+    checkThinLTO("../../tests/build_testing/test_thinlto_main.ssl", "../../tests/build_testing/test_thinlto_helpers.ssl");
+
+    return 0;
+}
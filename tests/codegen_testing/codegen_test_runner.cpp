@@ -0,0 +1,1107 @@
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <tuple>
+
+#include "generateMachineCode/CodeGenSession.h"
+#include "generateMachineCode/Linker.h"
+#include "generateMachineCode/genObjFile.h"
+#include "lexer/Lexer.h"
+#include "parser/Parser.h"
+#include "symbolTable/SymbolTable.h"
+#include "semanticAnalyzer/SemanticAnalyzer.h"
+#include "llvmGen/LLVMCodeGen.h"
+#include "llvmOptimize/AdaptiveOptimization.h"
+#include "llvmOptimize/LLVMOptimizer.h"
+#include "llvmOptimize/LogCoalescing.h"
+#include "llvmOptimize/OptimizationRemarks.h"
+#include "llvmOptimize/OptimizationReport.h"
+
+#include "llvm/Analysis/AssumptionCache.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/TargetLibraryInfo.h"
+#include "llvm/ExecutionEngine/GenericValue.h"
+#include "llvm/ExecutionEngine/Interpreter.h"
+#include "llvm/IR/CFG.h"
+#include "llvm/IR/DIBuilder.h"
+#include "llvm/IR/DiagnosticInfo.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Operator.h"
+#include "llvm/Passes/PassBuilder.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/TargetParser/Host.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+
+// Runs the IR verifier on function; on invalid IR, failure says why
+bool verifyOrFail(llvm::Function& function, std::string& failure) {
+    std::string errors;
+    llvm::raw_string_ostream errorStream(errors);
+    if (llvm::verifyFunction(function, &errorStream)) {
+        failure = "invalid IR: " + errorStream.str();
+        return false;
+    }
+    return true;
+}
+
+// Every loop has to be a canonical counted loop: a phi induction variable, an exit test
+// on that phi against a loop-invariant limit (so the test cannot overflow) and a trip
+// count ScalarEvolution can compute. Only the
+// runtime's log helpers may be declared willreturn; ssl_parallel_for runs the body.
+bool checkCountedLoops(llvm::Function& function, std::string& failure) {
+    llvm::DominatorTree dominatorTree(function);
+    llvm::LoopInfo loopInfo(dominatorTree);
+    llvm::TargetLibraryInfoImpl libraryInfoImpl(llvm::Triple(function.getParent()->getTargetTriple()));
+    llvm::TargetLibraryInfo libraryInfo(libraryInfoImpl);
+    llvm::AssumptionCache assumptionCache(function);
+    llvm::ScalarEvolution scalarEvolution(function, libraryInfo, assumptionCache, dominatorTree, loopInfo);
+
+    for (llvm::Loop* loop : loopInfo.getLoopsInPreorder()) {
+        std::string header = loop->getHeader()->getName().str();
+
+        llvm::PHINode* inductionVar = loop->getInductionVariable(scalarEvolution);
+        if (!inductionVar) {
+            failure = "no induction variable for loop at " + header;
+            return false;
+        }
+
+        llvm::ICmpInst* exitTest = loop->getLatchCmpInst();
+        if (!exitTest || exitTest->getOperand(0) != inductionVar || !loop->isLoopInvariant(exitTest->getOperand(1))) {
+            failure = "exit test does not compare the induction variable with a loop-invariant limit for loop at " + header;
+            return false;
+        }
+
+        if (llvm::isa<llvm::SCEVCouldNotCompute>(scalarEvolution.getBackedgeTakenCount(loop))) {
+            failure = "trip count is not computable for loop at " + header;
+            return false;
+        }
+    }
+
+    for (llvm::Instruction& instruction : llvm::instructions(function)) {
+        auto* call = llvm::dyn_cast<llvm::CallInst>(&instruction);
+        if (!call || !call->getCalledFunction() || !call->getCalledFunction()->isDeclaration()) {
+            continue;
+        }
+        llvm::Function* callee = call->getCalledFunction();
+        bool leaf = callee->getName().str().rfind("ssl_log_", 0) == 0;
+        if (callee->getName().str().rfind("ssl_", 0) == 0 && leaf != (callee->hasFnAttribute(llvm::Attribute::WillReturn) && callee->doesNotThrow())) {
+            failure = callee->getName().str() + (leaf ? " is not nounwind willreturn" : " must not be willreturn");
+            return false;
+        }
+    }
+    return true;
+}
+
+// Every loop written with pragmas has to carry them as llvm.loop metadata on its latch:
+// each hint its annotations ask for, with the count or width they give.
+bool checkLoopPragmas(llvm::Function& function, std::string& failure) {
+    // Hint name -> its value, or -1 for a hint that has none
+    const std::map<std::string, std::map<std::string, int64_t>> expectedHints = {
+        { "unrolled", { { "llvm.loop.unroll.count", 8 } } },
+        { "vectorized", { { "llvm.loop.vectorize.enable", 1 }, { "llvm.loop.vectorize.width", 8 }, { "llvm.loop.interleave.count", 4 } } },
+        { "notUnrolled", { { "llvm.loop.unroll.disable", -1 } } },
+        { "whileUnrolled", { { "llvm.loop.unroll.enable", -1 } } },
+    };
+    auto expected = expectedHints.find(function.getName().str());
+    if (expected == expectedHints.end()) {
+        return true;
+    }
+
+    llvm::DominatorTree dominatorTree(function);
+    llvm::LoopInfo loopInfo(dominatorTree);
+    if (loopInfo.getLoopsInPreorder().size() != 1) {
+        failure = std::to_string(loopInfo.getLoopsInPreorder().size()) + " loops instead of 1";
+        return false;
+    }
+    llvm::Loop* loop = loopInfo.getLoopsInPreorder().front();
+    llvm::MDNode* loopID = loop->getLoopID();
+    if (!loopID || loopID->getNumOperands() < 2) {
+        failure = "no llvm.loop hints for loop at " + loop->getHeader()->getName().str();
+        return false;
+    }
+
+    std::map<std::string, int64_t> hints;
+    for (unsigned i = 1; i < loopID->getNumOperands(); ++i) {
+        auto* hint = llvm::dyn_cast<llvm::MDNode>(loopID->getOperand(i));
+        auto* name = hint && hint->getNumOperands() > 0 ? llvm::dyn_cast<llvm::MDString>(hint->getOperand(0)) : nullptr;
+        if (!name) {
+            continue;
+        }
+        int64_t value = -1;
+        if (hint->getNumOperands() > 1) {
+            if (auto* constant = llvm::mdconst::dyn_extract<llvm::ConstantInt>(hint->getOperand(1))) {
+                value = constant->getZExtValue();
+            }
+        }
+        hints[name->getString().str()] = value;
+    }
+    for (const auto& [name, value] : expected->second) {
+        auto hint = hints.find(name);
+        if (hint == hints.end()) {
+            failure = "no " + name + " hint";
+            return false;
+        }
+        if (hint->second != value) {
+            failure = name + " is " + std::to_string(hint->second) + " instead of " + std::to_string(value);
+            return false;
+        }
+    }
+    return true;
+}
+
+// A call whose result is returned directly has to be musttail, with the callee's calling convention.
+bool checkTailCalls(llvm::Function& function, std::string& failure) {
+    for (llvm::BasicBlock& block : function) {
+        auto* ret = llvm::dyn_cast<llvm::ReturnInst>(block.getTerminator());
+        if (!ret || !ret->getReturnValue()) {
+            continue;
+        }
+        auto* call = llvm::dyn_cast<llvm::CallInst>(ret->getReturnValue());
+        if (!call || !call->getCalledFunction() || call->getCalledFunction()->isDeclaration()) {
+            continue;
+        }
+        if (!call->isMustTailCall() || call->getNextNode() != ret) {
+            failure = "call to " + call->getCalledFunction()->getName().str() + " in tail position is not musttail";
+            return false;
+        }
+        if (call->getCallingConv() != call->getCalledFunction()->getCallingConv()) {
+            failure = "musttail call to " + call->getCalledFunction()->getName().str() + " does not use the callee's calling convention";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Functions in test_function_attributes.ssl are named after their annotation, e.g. coldReport is @cold.
+// Every call has to reach a definition, whatever order the functions were written in.
+bool checkFunctionAttributes(llvm::Function& function, std::string& failure) {
+    const std::vector<std::pair<std::string, std::vector<llvm::Attribute::AttrKind>>> expected = {
+        { "inline", { llvm::Attribute::AlwaysInline } },
+        { "noinline", { llvm::Attribute::NoInline } },
+        { "hot", { llvm::Attribute::Hot } },
+        { "cold", { llvm::Attribute::Cold, llvm::Attribute::MinSize } },
+    };
+    std::string name = function.getName().str();
+    for (const auto& [prefix, attributes] : expected) {
+        if (name.rfind(prefix, 0) != 0) {
+            continue;
+        }
+        for (llvm::Attribute::AttrKind attribute : attributes) {
+            if (!function.hasFnAttribute(attribute)) {
+                failure = "missing " + llvm::Attribute::getNameFromAttrKind(attribute).str() + " attribute";
+                return false;
+            }
+        }
+    }
+
+    for (llvm::Instruction& instruction : llvm::instructions(function)) {
+        auto* call = llvm::dyn_cast<llvm::CallInst>(&instruction);
+        if (!call || !call->getCalledFunction()) {
+            continue;
+        }
+        // SSL functions are tailcc; runtime and libc declarations use the C convention
+        llvm::Function* callee = call->getCalledFunction();
+        if (callee->isDeclaration() && callee->getCallingConv() == llvm::CallingConv::Tail) {
+            failure = "call to " + callee->getName().str() + " never got its definition";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Functions in test_numeric_types.ssl are named after the type they compute in, e.g. i16Scale.
+// Their return value and every arithmetic instruction have to be of exactly that type.
+bool checkNumericTypes(llvm::Function& function, std::string& failure) {
+    if (!verifyOrFail(function, failure)) {
+        return false;
+    }
+
+    llvm::LLVMContext& context = function.getContext();
+    const std::vector<std::pair<std::string, llvm::Type*>> expected = {
+        { "i8", llvm::Type::getInt8Ty(context) },
+        { "i16", llvm::Type::getInt16Ty(context) },
+        { "i64", llvm::Type::getInt64Ty(context) },
+        { "dbl", llvm::Type::getDoubleTy(context) },
+    };
+    std::string name = function.getName().str();
+    for (const auto& [prefix, type] : expected) {
+        if (name.rfind(prefix, 0) != 0) {
+            continue;
+        }
+        if (function.getReturnType() != type) {
+            failure = "returns the wrong type";
+            return false;
+        }
+        for (llvm::Instruction& instruction : llvm::instructions(function)) {
+            if (llvm::isa<llvm::BinaryOperator>(instruction) && instruction.getType() != type) {
+                failure = "arithmetic at the wrong width: " + std::string(instruction.getOpcodeName());
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool checkVectorCode(llvm::Function& function, std::string& failure) {
+    if (!verifyOrFail(function, failure)) {
+        return false;
+    }
+
+    // simd* functions must compute on LLVM vector types rather than lane by lane
+    if (function.getName().str().rfind("simd", 0) == 0) {
+        for (llvm::Instruction& instruction : llvm::instructions(function)) {
+            for (llvm::Value* operand : instruction.operands()) {
+                if (operand->getType()->isVectorTy()) {
+                    return true;
+                }
+            }
+            if (instruction.getType()->isVectorTy()) {
+                return true;
+            }
+        }
+        failure = "no vector instructions";
+        return false;
+    }
+    return true;
+}
+
+bool checkDebugInfo(llvm::Function& function, std::string& failure) {
+    if (!verifyOrFail(function, failure)) {
+        return false;
+    }
+
+    // Compiler generated helpers such as ssl.array.free have no source to point at
+    if (function.getName().str().rfind("ssl.", 0) == 0) {
+        return true;
+    }
+    llvm::DISubprogram* subprogram = function.getSubprogram();
+    if (!subprogram) {
+        failure = "no debug subprogram";
+        return false;
+    }
+
+    // Statements below the function header must show up as their own lines
+    for (llvm::Instruction& instruction : llvm::instructions(function)) {
+        const llvm::DebugLoc& location = instruction.getDebugLoc();
+        if (location && location.getLine() > subprogram->getLine()) {
+            return true;
+        }
+    }
+    failure = "no instruction carries a statement's line";
+    return false;
+}
+
+bool isProfileCall(const llvm::Instruction& instruction, const char* hook) {
+    const auto* call = llvm::dyn_cast<llvm::CallInst>(&instruction);
+    return call && call->getCalledFunction() && call->getCalledFunction()->getName() == hook;
+}
+
+bool checkFunctionInstrumentation(llvm::Function& function, std::string& failure) {
+    if (!verifyOrFail(function, failure)) {
+        return false;
+    }
+
+    // main, the array helpers and outlined parallel loop bodies are not SSL functions of their own
+    std::string name = function.getName().str();
+    bool instrumented = name != "main" && name.rfind("ssl.", 0) != 0 && name.find(".parallel") == std::string::npos;
+
+    int enters = 0;
+    for (llvm::BasicBlock& block : function) {
+        for (llvm::Instruction& instruction : block) {
+            enters += isProfileCall(instruction, "ssl_profile_enter");
+        }
+        if (!instrumented || !llvm::isa<llvm::ReturnInst>(block.getTerminator())) {
+            continue;
+        }
+        // The exit hook comes before the ret, or before the musttail call the ret returns
+        llvm::Instruction* last = block.getTerminator()->getPrevNode();
+        if (last && llvm::isa<llvm::CallInst>(last) && llvm::cast<llvm::CallInst>(last)->isMustTailCall()) {
+            last = last->getPrevNode();
+        }
+        while (last && !llvm::isa<llvm::CallInst>(last)) {
+            last = last->getPrevNode();
+        }
+        if (!last || !isProfileCall(*last, "ssl_profile_exit")) {
+            failure = "a return without ssl_profile_exit";
+            return false;
+        }
+    }
+    if (enters != (instrumented ? 1 : 0)) {
+        failure = "expected " + std::to_string(instrumented ? 1 : 0) + " ssl_profile_enter calls, found " + std::to_string(enters);
+        return false;
+    }
+    return true;
+}
+
+// Strings are SSLString values: concatenation and equality go through the runtime,
+// and nothing rescans the bytes for a terminator to find a length. In measure*
+// functions len() has to be a read of the length field, without any call but the trap
+// for a length that doesn't fit an int.
+bool checkStringCode(llvm::Function& function, std::string& failure) {
+    if (!verifyOrFail(function, failure)) {
+        return false;
+    }
+
+    std::string name = function.getName().str();
+    if (name == "main" || name.rfind("ssl.", 0) == 0) {
+        return true;
+    }
+    bool usesStrings = false;
+    for (llvm::Instruction& instruction : llvm::instructions(function)) {
+        if (const auto* call = llvm::dyn_cast<llvm::CallInst>(&instruction)) {
+            llvm::Function* callee = call->getCalledFunction();
+            if (callee && callee->getName() == "strlen") {
+                failure = "the length of a string is computed with strlen";
+                return false;
+            }
+            if (callee && callee->getName().starts_with("ssl_str_")) {
+                usesStrings = true;
+            }
+        }
+        auto* structType = llvm::dyn_cast<llvm::StructType>(instruction.getType());
+        if (structType && structType->hasName() && structType->getName() == "SSLString") {
+            usesStrings = true;
+        }
+    }
+    if (!usesStrings) {
+        failure = "no SSLString values or string runtime calls";
+        return false;
+    }
+
+    if (name.rfind("measure", 0) == 0) {
+        bool readsLength = false;
+        bool trapsOnLongStrings = false;
+        for (llvm::Instruction& instruction : llvm::instructions(function)) {
+            // The only call allowed is the trap of a str too long for an int
+            auto* call = llvm::dyn_cast<llvm::CallInst>(&instruction);
+            if (call && call->getIntrinsicID() == llvm::Intrinsic::trap) {
+                if (!call->getParent()->getName().starts_with("lenTooLong")) {
+                    failure = "a trap outside the length check";
+                    return false;
+                }
+                trapsOnLongStrings = true;
+            }
+            else if (call) {
+                failure = "len() calls " + (call->getCalledFunction() ? call->getCalledFunction()->getName().str() : std::string("a function pointer")) + " instead of reading the length field";
+                return false;
+            }
+            auto* extract = llvm::dyn_cast<llvm::ExtractValueInst>(&instruction);
+            auto* structType = extract ? llvm::dyn_cast<llvm::StructType>(extract->getAggregateOperand()->getType()) : nullptr;
+            if (structType && structType->hasName() && structType->getName() == "SSLString" && extract->getIndices() == llvm::ArrayRef<unsigned>{ 1 }) {
+                readsLength = true;
+            }
+        }
+        if (!readsLength) {
+            failure = "len() does not read the length field of the str";
+            return false;
+        }
+        if (!trapsOnLongStrings) {
+            failure = "len() truncates the 64-bit length to an int without checking it";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool isCallTo(const llvm::Instruction& instruction, llvm::StringRef name) {
+    const auto* call = llvm::dyn_cast<llvm::CallInst>(&instruction);
+    return call && call->getCalledFunction() && call->getCalledFunction()->getName() == name;
+}
+
+// Follows every path through the function counting the open arenas: each block must be
+// reached with the same count, every ret with none open, and code inside an arena must
+// allocate from it rather than from the heap or the thread's string memory.
+bool checkArenaBlocks(llvm::Function& function, std::string& failure) {
+    if (!verifyOrFail(function, failure)) {
+        return false;
+    }
+
+    std::map<llvm::BasicBlock*, int> depthAt = { { &function.getEntryBlock(), 0 } };
+    std::vector<llvm::BasicBlock*> worklist = { &function.getEntryBlock() };
+    while (!worklist.empty()) {
+        llvm::BasicBlock* block = worklist.back();
+        worklist.pop_back();
+        int depth = depthAt[block];
+        for (llvm::Instruction& instruction : *block) {
+            if (isCallTo(instruction, "ssl_arena_enter")) {
+                ++depth;
+            }
+            else if (isCallTo(instruction, "ssl_arena_exit") && --depth < 0) {
+                failure = "an arena is exited more often than entered";
+                return false;
+            }
+            else if (depth > 0 && (isCallTo(instruction, "ssl_str_concat") || isCallTo(instruction, "ssl.array.grow"))) {
+                failure = "code inside an arena block allocates outside the arena";
+                return false;
+            }
+        }
+        if (llvm::isa<llvm::ReturnInst>(block->getTerminator()) && depth != 0) {
+            failure = "a return leaves " + std::to_string(depth) + " arena(s) open";
+            return false;
+        }
+        for (llvm::BasicBlock* successor : llvm::successors(block)) {
+            auto [known, inserted] = depthAt.try_emplace(successor, depth);
+            if (inserted) {
+                worklist.push_back(successor);
+            }
+            else if (known->second != depth) {
+                failure = "block " + successor->getName().str() + " is reached with different arenas open";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Functions named stack* keep their arrays and strs in the stack frame, so nothing they
+// build grows an array or goes to an arena. In the escapes* and unbounded* functions a
+// value leaves the function or has no size limit, and no buffer in the frame may hold it.
+// A str that outgrows its buffer goes to an arena the function releases, never to the
+// thread's string arena, so ssl_str_concat_local is always passed an arena.
+bool checkEscapeAnalysis(llvm::Function& function, std::string& failure) {
+    if (!verifyOrFail(function, failure)) {
+        return false;
+    }
+
+    std::string name = function.getName().str();
+    bool onStack = name.rfind("stack", 0) == 0;
+    if (name.find('.') != std::string::npos || (!onStack && name.rfind("escapes", 0) != 0 && name.rfind("unbounded", 0) != 0)) { // outlined parallel bodies too
+        return true;
+    }
+    int stackConcats = 0;
+    int allocations = 0;
+    for (llvm::Instruction& instruction : llvm::instructions(function)) {
+        if (isCallTo(instruction, "ssl_str_concat_local")) {
+            ++stackConcats;
+            if (llvm::isa<llvm::ConstantPointerNull>(llvm::cast<llvm::CallInst>(instruction).getArgOperand(2))) {
+                failure = "a str that outgrows its stack buffer goes to the thread's string arena, which is never released";
+                return false;
+            }
+        }
+        else if (isCallTo(instruction, "ssl_str_concat") || isCallTo(instruction, "ssl_str_concat_in")
+            || isCallTo(instruction, "ssl_arena_resize") || isCallTo(instruction, "ssl.array.grow")) {
+            ++allocations;
+        }
+    }
+    if (onStack && allocations != 0) {
+        failure = std::to_string(allocations) + " allocation(s) outside the stack frame";
+        return false;
+    }
+    if (!onStack && (stackConcats != 0 || allocations == 0)) {
+        failure = "a value that leaves the function or grows without limit is kept in the stack frame";
+        return false;
+    }
+    return true;
+}
+
+// Runs the log coalescing pass on the unoptimized function: in constant* functions every
+// log() has to end up in a single ssl_log_str call of a constant str holding exactly the
+// lines the runtime would have printed, while in split* functions a value or a call
+// between the literals keeps them in calls of their own.
+bool checkLogCoalescing(llvm::Function& function, std::string& failure) {
+    llvm::FunctionAnalysisManager analysisManager;
+    LogCoalescingPass().run(function, analysisManager);
+
+    if (!verifyOrFail(function, failure)) {
+        return false;
+    }
+
+    std::string name = function.getName().str();
+    std::vector<llvm::CallInst*> logCalls;
+    for (llvm::Instruction& instruction : llvm::instructions(function)) {
+        auto* call = llvm::dyn_cast<llvm::CallInst>(&instruction);
+        if (call && call->getCalledFunction() && call->getCalledFunction()->getName().starts_with("ssl_log_")) {
+            logCalls.push_back(call);
+        }
+    }
+    if (name.rfind("constant", 0) == 0) {
+        if (logCalls.size() != 1 || !isCallTo(*logCalls.front(), "ssl_log_str") || !llvm::isa<llvm::GlobalVariable>(logCalls.front()->getArgOperand(0))) {
+            failure = std::to_string(logCalls.size()) + " log call(s) left instead of one of a constant str";
+            return false;
+        }
+        const std::map<std::string, std::string> expectedText = {
+            { "constantLines", "total\n42\ntrue\n2.500000" },
+            { "constantAroundAssignment", "before\nafter" },
+        };
+        auto* string = llvm::cast<llvm::GlobalVariable>(logCalls.front()->getArgOperand(0))->getInitializer();
+        auto* text = llvm::dyn_cast<llvm::GlobalVariable>(string->getAggregateElement(0u));
+        auto* bytes = text ? llvm::dyn_cast<llvm::ConstantDataSequential>(text->getInitializer()) : nullptr;
+        auto* length = llvm::dyn_cast<llvm::ConstantInt>(string->getAggregateElement(1u));
+        std::string actual = bytes ? bytes->getRawDataValues().str() : "";
+        if (actual != expectedText.at(name) || !length || length->getZExtValue() != actual.size()) {
+            failure = "merged log text is \"" + actual + "\" instead of \"" + expectedText.at(name) + "\"";
+            return false;
+        }
+    }
+    else if (name.rfind("split", 0) == 0 && logCalls.size() < 2) {
+        failure = "log() calls were merged across a value or call that comes between them";
+        return false;
+    }
+    return true;
+}
+
+// The outlined body of a parallel loop has to copy in every local it reads, arrays included,
+// from the context the enclosing function passes as its third argument.
+bool checkParallelCaptures(llvm::Function& function, std::string& failure) {
+    if (!function.getName().ends_with(".parallel")) {
+        return true;
+    }
+    if (!verifyOrFail(function, failure)) {
+        return false;
+    }
+
+    for (std::string name : { "scale", "values" }) {
+        llvm::AllocaInst* copy = nullptr;
+        for (llvm::Instruction& instruction : function.getEntryBlock()) {
+            auto* alloca = llvm::dyn_cast<llvm::AllocaInst>(&instruction);
+            if (alloca && alloca->getName() == name) {
+                copy = alloca;
+            }
+        }
+        if (!copy) {
+            failure = "'" + name + "' is not captured";
+            return false;
+        }
+        bool copiedFromContext = false;
+        for (llvm::User* user : copy->users()) {
+            auto* store = llvm::dyn_cast<llvm::StoreInst>(user);
+            auto* value = store ? llvm::dyn_cast<llvm::LoadInst>(store->getValueOperand()) : nullptr;
+            auto* source = value ? llvm::dyn_cast<llvm::LoadInst>(value->getPointerOperand()) : nullptr;
+            auto* slot = source ? llvm::dyn_cast<llvm::GetElementPtrInst>(source->getPointerOperand()) : nullptr;
+            copiedFromContext |= slot && slot->getPointerOperand() == function.getArg(2);
+        }
+        if (!copiedFromContext || copy->getNumUses() < 2) {
+            failure = "'" + name + "' is not copied from the parallel context and read";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Range loops near the limits of their counter type have to run exactly as often as the
+// range says; each function is interpreted on its own copy of the module and returns its count.
+bool checkLoopBounds(llvm::Function& function, std::string& failure) {
+    if (!verifyOrFail(function, failure)) {
+        return false;
+    }
+
+    const std::map<std::string, int> expectedCount = {
+        { "i8Up", 13 },
+        { "i8UpToMax", 2 },
+        { "i8Down", 3 },
+        { "i8StepPastMin", 1 },
+        { "intUp", 24 },
+        { "i64Up", 3 },
+    };
+    std::string name = function.getName().str();
+    if (expectedCount.find(name) == expectedCount.end()) {
+        return true;
+    }
+    std::unique_ptr<llvm::Module> module = llvm::CloneModule(*function.getParent());
+    llvm::Function* copy = module->getFunction(name);
+    std::string error;
+    std::unique_ptr<llvm::ExecutionEngine> engine(llvm::EngineBuilder(std::move(module)).setEngineKind(llvm::EngineKind::Interpreter).setErrorStr(&error).create());
+    if (!engine) {
+        failure = "could not create an interpreter: " + error;
+        return false;
+    }
+
+    int64_t count = engine->runFunction(copy, {}).IntVal.getSExtValue();
+    if (count != expectedCount.at(name)) {
+        failure = "loop ran " + std::to_string(count) + " times instead of " + std::to_string(expectedCount.at(name));
+        return false;
+    }
+    return true;
+}
+
+// The checks below test helpers directly instead of the IR of a test program
+void reportHelperTest(bool passed, const std::string& test, const std::string& failure = "") {
+    if (passed) {
+        std::cout << "\033[32mTest Passed\033[0m" << " " << test << std::endl;
+    }
+    else {
+        std::cerr << "\033[31mTest Failed\033[0m" << " " << test << " with error: " << failure << std::endl;
+    }
+}
+
+const char* tierName(AdaptiveOptimization::Tier tier) {
+    switch (tier) {
+    case AdaptiveOptimization::Tier::Full:
+        return "Full";
+    case AdaptiveOptimization::Tier::Reduced:
+        return "Reduced";
+    default:
+        return "Minimal";
+    }
+}
+
+// A function of instructions instructions (adds and a ret), with its body in a loop if withLoop
+llvm::Function* makeTierFunction(llvm::Module& module, const std::string& name, unsigned instructions, bool withLoop) {
+    llvm::LLVMContext& context = module.getContext();
+    llvm::Type* int32 = llvm::Type::getInt32Ty(context);
+    llvm::Function* function = llvm::Function::Create(llvm::FunctionType::get(int32, { int32 }, false), llvm::Function::ExternalLinkage, name, module);
+    llvm::IRBuilder<> builder(llvm::BasicBlock::Create(context, "entry", function));
+    unsigned remaining = instructions - 1;
+    llvm::BasicBlock* exit = nullptr;
+    if (withLoop) {
+        // entry: br; body: ..., icmp, br; exit: ret
+        llvm::BasicBlock* body = llvm::BasicBlock::Create(context, "body", function);
+        exit = llvm::BasicBlock::Create(context, "exit", function);
+        builder.CreateBr(body);
+        builder.SetInsertPoint(body);
+        remaining -= 3;
+    }
+    llvm::Value* value = function->getArg(0);
+    for (unsigned i = 0; i < remaining; ++i) {
+        value = builder.CreateAdd(value, builder.getInt32(i + 1));
+    }
+    if (withLoop) {
+        builder.CreateCondBr(builder.CreateICmpSLT(value, builder.getInt32(1000)), builder.GetInsertBlock(), exit);
+        builder.SetInsertPoint(exit);
+    }
+    builder.CreateRet(value);
+    return function;
+}
+
+// classify at the edges of each tier, and tierOf reading back what apply wrote
+void checkAdaptiveTiers() {
+    using Tier = AdaptiveOptimization::Tier;
+    const unsigned huge = AdaptiveOptimization::hugeFunctionInstructions;
+    llvm::LLVMContext context;
+    llvm::Module module("tiers", context);
+
+    struct Case {
+        const char* name;
+        unsigned instructions;
+        bool withLoop;
+        std::vector<llvm::Attribute::AttrKind> attributes;
+        Tier expected;
+    };
+    const std::vector<Case> cases = {
+        { "atLimit", huge, false, {}, Tier::Full },
+        { "pastLimit", huge + 1, false, {}, Tier::Reduced },
+        { "pastLimitWithLoop", huge + 1, true, {}, Tier::Full },
+        { "pastLimitHot", huge + 1, false, { llvm::Attribute::Hot }, Tier::Full },
+        { "smallCold", 2, false, { llvm::Attribute::Cold }, Tier::Minimal },
+        { "coldWithLoop", huge + 1, true, { llvm::Attribute::Cold }, Tier::Minimal },
+        { "coldInline", 2, false, { llvm::Attribute::Cold, llvm::Attribute::AlwaysInline }, Tier::Reduced },
+    };
+    for (const Case& test : cases) {
+        llvm::Function* function = makeTierFunction(module, test.name, test.instructions, test.withLoop);
+        for (llvm::Attribute::AttrKind attribute : test.attributes) {
+            function->addFnAttr(attribute);
+        }
+        std::string failure;
+        Tier tier = AdaptiveOptimization::classify(*function);
+        if (function->getInstructionCount() != test.instructions) {
+            failure = "the function has " + std::to_string(function->getInstructionCount()) + " instructions instead of " + std::to_string(test.instructions);
+        }
+        else if (tier != test.expected) {
+            failure = std::string("classified ") + tierName(tier) + " instead of " + tierName(test.expected);
+        }
+        else if (AdaptiveOptimization::tierOf(*function) != Tier::Full) {
+            failure = std::string("tierOf an unclassified function is ") + tierName(AdaptiveOptimization::tierOf(*function));
+        }
+        else {
+            AdaptiveOptimization::apply(*function, tier);
+            if (AdaptiveOptimization::tierOf(*function) != tier) {
+                failure = std::string("tierOf after apply is ") + tierName(AdaptiveOptimization::tierOf(*function)) + " instead of " + tierName(tier);
+            }
+            else if (!verifyOrFail(*function, failure)) {
+                failure = "after apply: " + failure;
+            }
+        }
+        reportHelperTest(failure.empty(), std::string("AdaptiveOptimization tier of ") + test.name, failure);
+    }
+
+    // A profile can move a function to another tier; the attributes of the old one must not stay behind
+    llvm::Function* promoted = makeTierFunction(module, "promoted", huge + 1, false);
+    AdaptiveOptimization::apply(*promoted, Tier::Reduced);
+    AdaptiveOptimization::apply(*promoted, Tier::Full);
+    std::string failure;
+    if (AdaptiveOptimization::tierOf(*promoted) != Tier::Full) {
+        failure = std::string("tierOf is ") + tierName(AdaptiveOptimization::tierOf(*promoted));
+    }
+    else if (promoted->hasFnAttribute(llvm::Attribute::OptimizeForSize)) {
+        failure = "optsize stayed after moving from Reduced to Full";
+    }
+    reportHelperTest(failure.empty(), "AdaptiveOptimization Reduced to Full", failure);
+}
+
+// Every -O flag main accepts, and arguments that look like one but are not
+void checkParseLevel() {
+    const std::vector<std::pair<std::string, llvm::OptimizationLevel>> levels = {
+        { "-O0", llvm::OptimizationLevel::O0 },
+        { "-O1", llvm::OptimizationLevel::O1 },
+        { "-O2", llvm::OptimizationLevel::O2 },
+        { "-O3", llvm::OptimizationLevel::O3 },
+        { "-Os", llvm::OptimizationLevel::Os },
+        { "-Oz", llvm::OptimizationLevel::Oz },
+    };
+    std::string failure;
+    for (const auto& [flag, level] : levels) {
+        std::optional<llvm::OptimizationLevel> parsed = LLVMOptimizer::parseLevel(flag);
+        if (!parsed) {
+            failure = flag + " is not a level";
+        }
+        else if (*parsed != level) {
+            failure = flag + " is level O" + std::to_string(parsed->getSpeedupLevel()) + " with size level " + std::to_string(parsed->getSizeLevel());
+        }
+    }
+    for (const char* flag : { "-O4", "-Og", "-O", "-o2", "O2", "-O2 ", "" }) {
+        if (LLVMOptimizer::parseLevel(flag)) {
+            failure = std::string("\"") + flag + "\" is parsed as a level";
+        }
+    }
+    reportHelperTest(failure.empty(), "LLVMOptimizer::parseLevel", failure);
+}
+
+// Two instcombine runs on a function that folds to a ret: the first changes it and the second does not,
+// and the pass managers and adaptors around them are left out
+void checkOptimizationReport() {
+    llvm::LLVMContext context;
+    llvm::Module module("report", context);
+    llvm::Type* int32 = llvm::Type::getInt32Ty(context);
+    llvm::Function* function = llvm::Function::Create(llvm::FunctionType::get(int32, { int32 }, false), llvm::Function::ExternalLinkage, "fold", module);
+    llvm::IRBuilder<> builder(llvm::BasicBlock::Create(context, "entry", function));
+    llvm::Value* value = builder.CreateAdd(function->getArg(0), builder.getInt32(0));
+    builder.CreateRet(builder.CreateMul(value, builder.getInt32(1)));
+
+    OptimizationReport report;
+    report.beginFile("fold.ssl");
+    llvm::PassInstrumentationCallbacks PIC;
+    report.registerCallbacks(PIC);
+    llvm::PassBuilder PB(nullptr, llvm::PipelineTuningOptions(), {}, &PIC);
+    llvm::LoopAnalysisManager LAM;
+    llvm::FunctionAnalysisManager FAM;
+    llvm::CGSCCAnalysisManager CGAM;
+    llvm::ModuleAnalysisManager MAM;
+    PB.registerModuleAnalyses(MAM);
+    PB.registerCGSCCAnalyses(CGAM);
+    PB.registerFunctionAnalyses(FAM);
+    PB.registerLoopAnalyses(LAM);
+    PB.crossRegisterProxies(LAM, FAM, CGAM, MAM);
+    llvm::ModulePassManager MPM;
+    if (llvm::Error error = PB.parsePassPipeline(MPM, "function(instcombine,instcombine)")) {
+        reportHelperTest(false, "OptimizationReport", llvm::toString(std::move(error)));
+        return;
+    }
+    MPM.run(module, MAM);
+
+    std::string path = (std::filesystem::temp_directory_path() / "sslang_codegen_tests_report.json").string();
+    std::string written;
+    if (report.write(path)) {
+        std::ifstream file(path);
+        written = std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    }
+    std::filesystem::remove(path);
+    std::string failure;
+    llvm::Expected<llvm::json::Value> json = llvm::json::parse(written);
+    const llvm::json::Object* root = json ? json->getAsObject() : nullptr;
+    const llvm::json::Array* passes = root ? root->getArray("passes") : nullptr;
+    const llvm::json::Array* files = root ? root->getArray("files") : nullptr;
+    if (!json) {
+        failure = "the report is not JSON: " + llvm::toString(json.takeError());
+    }
+    else if (!passes || !files) {
+        failure = "the report has no passes or files";
+    }
+    else if (files->size() != 1 || (*files)[0].getAsString() != llvm::StringRef("fold.ssl")) {
+        failure = "the files are not [\"fold.ssl\"]";
+    }
+    else if (passes->size() != 1) {
+        failure = std::to_string(passes->size()) + " passes instead of InstCombinePass alone";
+    }
+    else if (const llvm::json::Object* pass = (*passes)[0].getAsObject(); !pass || pass->getString("name") != llvm::StringRef("InstCombinePass")) {
+        failure = "the pass is not InstCombinePass";
+    }
+    else {
+        // 3 instructions before the first run and 1 after it; 1 before and after the second
+        const std::vector<std::pair<const char*, int64_t>> expected = {
+            { "runs", 2 }, { "changedRuns", 1 }, { "instructionsBefore", 4 }, { "instructionsAfter", 2 }, { "blocksBefore", 2 }, { "blocksAfter", 2 },
+        };
+        for (const auto& [field, value] : expected) {
+            if (pass->getInteger(field) != value) {
+                failure = std::string(field) + " is " + std::to_string(pass->getInteger(field).value_or(-1)) + " instead of " + std::to_string(value);
+            }
+        }
+    }
+    reportHelperTest(failure.empty(), "OptimizationReport", failure);
+}
+
+// Remarks added out of order, twice, without a line and for a helper: explain lists them by function and line,
+// missed before why before done, each once with a count, and leaves the helper out of the list but not the totals
+void checkOptimizationRemarks() {
+    llvm::LLVMContext context;
+    llvm::Module module("remarks", context);
+    llvm::DIBuilder debugInfo(module);
+    llvm::DIFile* file = debugInfo.createFile("remarks.ssl", ".");
+    debugInfo.createCompileUnit(llvm::dwarf::DW_LANG_C, file, "SSLang", true, "", 0);
+    std::map<std::string, llvm::BasicBlock*> blocks;
+    for (const char* name : { "work", "main", "ssl.str_concat" }) {
+        llvm::Function* function = llvm::Function::Create(llvm::FunctionType::get(llvm::Type::getVoidTy(context), false), llvm::Function::ExternalLinkage, name, module);
+        function->setSubprogram(debugInfo.createFunction(file, name, name, file, 1, debugInfo.createSubroutineType(debugInfo.getOrCreateTypeArray({})), 1, llvm::DINode::FlagZero, llvm::DISubprogram::SPFlagDefinition));
+        blocks[name] = llvm::BasicBlock::Create(context, "entry", function);
+        llvm::ReturnInst::Create(context, blocks[name]);
+    }
+    debugInfo.finalize();
+
+    OptimizationRemarks remarks;
+    auto at = [&](const std::string& function, unsigned line) -> llvm::DebugLoc {
+        if (line == 0) {
+            return {};
+        }
+        return llvm::DILocation::get(context, line, 5, blocks[function]->getParent()->getSubprogram());
+    };
+    auto passed = [&](const char* pass, const std::string& function, unsigned line, const char* message) {
+        llvm::OptimizationRemark remark(pass, "Passed", at(function, line), blocks[function]);
+        remarks.add(remark << message);
+    };
+    auto missed = [&](const char* pass, const std::string& function, unsigned line, const char* message) {
+        llvm::OptimizationRemarkMissed remark(pass, "Missed", at(function, line), blocks[function]);
+        remarks.add(remark << message);
+    };
+    auto analysis = [&](const char* pass, const std::string& function, unsigned line, const char* message) {
+        llvm::OptimizationRemarkAnalysis remark(pass, "Analysis", at(function, line), blocks[function]);
+        remarks.add(remark << message);
+    };
+    passed("licm", "work", 7, "hoisted a load out of the loop");
+    analysis("loop-vectorize", "work", 7, "could not determine the loop's trip count");
+    missed("loop-vectorize", "work", 7, "loop not vectorized");
+    passed("inline", "main", 12, "work inlined into main");
+    missed("loop-vectorize", "work", 3, "loop not vectorized");
+    missed("loop-vectorize", "work", 7, "loop not vectorized");
+    missed("gvn", "work", 0, "load not eliminated");
+    missed("slp-vectorizer", "ssl.str_concat", 0, "list not vectorized");
+
+    const std::string expected =
+        "Optimization remarks: 5 missed, 1 analysis, 2 passed\n"
+        "In top level:\n"
+        "  remarks.ssl:12:5: done [inline] work inlined into main\n"
+        "In function work:\n"
+        "  MISSED [gvn] load not eliminated\n"
+        "  remarks.ssl:3:5: MISSED [loop-vectorize] loop not vectorized\n"
+        "  remarks.ssl:7:5: MISSED [loop-vectorize] loop not vectorized (x2)\n"
+        "  remarks.ssl:7:5: why [loop-vectorize] could not determine the loop's trip count\n"
+        "  remarks.ssl:7:5: done [licm] hoisted a load out of the loop\n";
+    std::string explained = remarks.explain();
+    reportHelperTest(explained == expected, "OptimizationRemarks::explain", "explained\n" + explained + "instead of\n" + expected);
+
+    // Without -g no remark has a line, which explain points out
+    OptimizationRemarks withoutLines;
+    llvm::OptimizationRemarkMissed remark("gvn", "Missed", llvm::DebugLoc(), blocks["work"]);
+    withoutLines.add(remark << "load not eliminated");
+    explained = withoutLines.explain();
+    reportHelperTest(llvm::StringRef(explained).ends_with("No remark has a source line; compile with -g to get them\n"), "OptimizationRemarks::explain without lines", "explained\n" + explained);
+}
+
+// A session creates a target machine for a code generator level once and hands out the same one for it after that
+void checkCodeGenSession() {
+    CodeGenSession session;
+    llvm::TargetMachine* standard = session.targetMachine(llvm::CodeGenOptLevel::Default);
+    llvm::TargetMachine* aggressive = session.targetMachine(llvm::CodeGenOptLevel::Aggressive);
+    std::string failure;
+    if (!standard || !aggressive) {
+        failure = "no target machine for the host";
+    }
+    else if (session.targetMachine(llvm::CodeGenOptLevel::Default) != standard || session.targetMachine(llvm::CodeGenOptLevel::Aggressive) != aggressive) {
+        failure = "a second target machine for the same level";
+    }
+    else if (standard == aggressive) {
+        failure = "one target machine for two levels";
+    }
+    else if (standard->getOptLevel() != llvm::CodeGenOptLevel::Default || aggressive->getOptLevel() != llvm::CodeGenOptLevel::Aggressive) {
+        failure = "a target machine is for another level";
+    }
+    reportHelperTest(failure.empty(), "CodeGenSession::targetMachine", failure);
+
+    CodeGenTarget unknown;
+    unknown.cpu = "no-such-cpu";
+    CodeGenSession unknownSession(unknown);
+    reportHelperTest(!unknownSession.targetMachine(llvm::CodeGenOptLevel::Default), "CodeGenSession::targetMachine for an unknown CPU", "a target machine for CPU no-such-cpu");
+}
+
+// --reloc and --code-model values, and values main has to reject
+void checkTargetFlags() {
+    const std::vector<std::pair<std::string, llvm::Reloc::Model>> relocationModels = {
+        { "static", llvm::Reloc::Static },
+        { "pic", llvm::Reloc::PIC_ },
+    };
+    const std::vector<std::pair<std::string, llvm::CodeModel::Model>> codeModels = {
+        { "small", llvm::CodeModel::Small },
+        { "medium", llvm::CodeModel::Medium },
+        { "large", llvm::CodeModel::Large },
+        { "kernel", llvm::CodeModel::Kernel },
+    };
+    std::string failure;
+    for (const auto& [name, model] : relocationModels) {
+        if (GenerateOBJ::parseRelocationModel(name) != model) {
+            failure = "--reloc=" + name + " is not its model";
+        }
+    }
+    for (const auto& [name, model] : codeModels) {
+        if (GenerateOBJ::parseCodeModel(name) != model) {
+            failure = "--code-model=" + name + " is not its model";
+        }
+    }
+    for (const char* name : { "", "PIC", "dynamic-no-pic", "ropi", "tiny", "Small" }) {
+        if (GenerateOBJ::parseRelocationModel(name) || GenerateOBJ::parseCodeModel(name)) {
+            failure = std::string("\"") + name + "\" is parsed as a model";
+        }
+    }
+    reportHelperTest(failure.empty(), "GenerateOBJ::parseRelocationModel and parseCodeModel", failure);
+}
+
+// The features of a CodeGenTarget: only --mattr's for a named CPU, and for native the host's, sorted so the
+// string is the same every run, followed by --mattr's so they win
+void checkFeatureString() {
+    std::string failure;
+    CodeGenTarget generic;
+    CodeGenTarget withFeatures;
+    withFeatures.cpu = "x86-64-v2";
+    withFeatures.features = "+avx2,-sse4a";
+    CodeGenTarget native;
+    native.cpu = "native";
+    native.features = "-avx512f";
+    std::string nativeFeatures = native.featureString();
+    if (generic.featureString() != "" || generic.cpuName() != "generic") {
+        failure = "the default target has features \"" + generic.featureString() + "\" and CPU " + generic.cpuName();
+    }
+    else if (withFeatures.featureString() != "+avx2,-sse4a" || withFeatures.cpuName() != "x86-64-v2") {
+        failure = "x86-64-v2 with +avx2,-sse4a has features \"" + withFeatures.featureString() + "\" and CPU " + withFeatures.cpuName();
+    }
+    else if (native.cpuName() != llvm::sys::getHostCPUName()) {
+        failure = "native is CPU " + native.cpuName() + " instead of " + llvm::sys::getHostCPUName().str();
+    }
+    else if (native.featureString() != nativeFeatures) {
+        failure = "two feature strings for native";
+    }
+    else if (!llvm::StringRef(nativeFeatures).ends_with("-avx512f")) {
+        failure = "--mattr is not last in \"" + nativeFeatures + "\"";
+    }
+    else {
+        llvm::SmallVector<llvm::StringRef> host;
+        llvm::StringRef(nativeFeatures).drop_back(std::string("-avx512f").size()).split(host, ',', -1, false);
+        if (!std::is_sorted(host.begin(), host.end())) {
+            failure = "the host's features are not sorted in \"" + nativeFeatures + "\"";
+        }
+        for (llvm::StringRef feature : host) {
+            if (!feature.starts_with("+") && !feature.starts_with("-")) {
+                failure = "host feature " + feature.str() + " is not turned on or off";
+            }
+        }
+    }
+    reportHelperTest(failure.empty(), "CodeGenTarget::featureString", failure);
+}
+
+// Where --link writes the program of a source file
+void checkLinkerOutputFilename() {
+    const std::vector<std::tuple<std::string, bool, std::string>> cases = {
+        { "tests/x.ssl", false, "genExecutable/x" },
+        { "tests/x.ssl", true, "genExecutable/libx.so" },
+        { "x.ssl", false, "genExecutable/x" },
+        { "../dir.d/prog.v2.ssl", true, "genExecutable/libprog.v2.so" },
+        { "/abs/path/noext", false, "genExecutable/noext" },
+    };
+    std::string failure;
+    for (const auto& [source, shared, expected] : cases) {
+        std::string output = Linker::outputFilename(source, shared);
+        if (output != expected) {
+            failure = source + (shared ? " (shared)" : "") + " is linked into " + output + " instead of " + expected;
+        }
+    }
+    reportHelperTest(failure.empty(), "Linker::outputFilename", failure);
+}
+
+using LoopCheck = bool (*)(llvm::Function&, std::string&);
+
+void runTestForFile(const std::string& filePath, LoopCheck check, bool debugInfo = false, bool instrumentFunctions = false) {
+    std::ifstream testFile(filePath);
+    if (!testFile) {
+        std::cerr << "Failed to open test file: " << filePath << std::endl;
+        return;
+    }
+
+    // Read the entire file into a string
+    std::string fileContent((std::istreambuf_iterator<char>(testFile)),
+        (std::istreambuf_iterator<char>()));
+
+    Lexer lexer(fileContent.c_str());
+    Parser parser(lexer);
+    std::filesystem::path testPath = filePath;
+    std::string filename = testPath.filename().string();
+
+    try {
+        auto program = parser.parseProgram();
+        SymbolTable symbolTable;
+        SemanticAnalyzer semanticAnalyzer(symbolTable);
+        semanticAnalyzer.visit(program.get());
+
+        LLVMCodeGen llvmCodeGen;
+        if (debugInfo) {
+            llvmCodeGen.enableDebugInfo(filePath);
+        }
+        if (instrumentFunctions) {
+            llvmCodeGen.enableFunctionInstrumentation();
+        }
+        program->accept(&llvmCodeGen);
+
+        for (llvm::Function& function : *llvmCodeGen.getModule()) {
+            if (function.isDeclaration()) {
+                continue;
+            }
+            std::string failure;
+            if (check(function, failure)) {
+                std::cout << "\033[32mTest Passed\033[0m" << " Function: " << function.getName().str() << " in " << filename << std::endl;
+            }
+            else {
+                std::cerr << "\033[31mTest Failed\033[0m" << " Function: " << function.getName().str() << " in " << filename << " with error: " << failure << std::endl;
+            }
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "\033[31mTest Failed\033[0m" << " in " << filename << " with error: " << e.what() << std::endl;
+    }
+}
+
+int main() {
+    std::vector<std::pair<std::string, LoopCheck>> testFiles = {
+        { "../../tests/codegen_testing/test_loops.ssl", checkCountedLoops },
+        { "../../tests/codegen_testing/test_loop_bounds.ssl", checkLoopBounds },
+        { "../../tests/codegen_testing/test_loop_pragmas.ssl", checkLoopPragmas },
+        { "../../tests/codegen_testing/test_parallel_loops.ssl", checkCountedLoops },
+        { "../../tests/codegen_testing/test_parallel_captures.ssl", checkParallelCaptures },
+        { "../../tests/codegen_testing/test_tail_calls.ssl", checkTailCalls },
+        { "../../tests/codegen_testing/test_function_attributes.ssl", checkFunctionAttributes },
+        { "../../tests/codegen_testing/test_numeric_types.ssl", checkNumericTypes },
+        { "../../tests/codegen_testing/test_vectors.ssl", checkVectorCode },
+        { "../../tests/codegen_testing/test_strings.ssl", checkStringCode },
+        { "../../tests/codegen_testing/test_arenas.ssl", checkArenaBlocks },
+        { "../../tests/codegen_testing/test_escape.ssl", checkEscapeAnalysis },
+        { "../../tests/codegen_testing/test_log_coalescing.ssl", checkLogCoalescing },
+    };
+
+    for (const auto& [filePath, check] : testFiles) {
+        runTestForFile(filePath, check);
+    }
+    runTestForFile("../../tests/codegen_testing/test_debug_info.ssl", checkDebugInfo, true);
+    runTestForFile("../../tests/codegen_testing/test_instrumentation.ssl", checkFunctionInstrumentation, false, true);
+
+    checkAdaptiveTiers();
+    checkParseLevel();
+    checkOptimizationReport();
+    checkOptimizationRemarks();
+    checkCodeGenSession();
+    checkTargetFlags();
+    checkFeatureString();
+    checkLinkerOutputFilename();
+
+    return 0;
+}
@@ -53,6 +53,14 @@ int main() {
     // Adjusted for testing entire files rather than line-by-line
     std::vector<std::string> testFiles = {
         "../../tests/program_testing/test_programs.ssl",
+        "../../tests/program_testing/test_tailrec.ssl",
+        "../../tests/program_testing/test_arena_escape.ssl",
+        "../../tests/program_testing/test_block_locals.ssl",
+        "../../tests/program_testing/test_parallel_locals.ssl",
+        "../../tests/program_testing/test_parallel_shared_write.ssl",
+        "../../tests/program_testing/test_parallel_reduction_read.ssl",
+        "../../tests/program_testing/test_loop_step_width.ssl",
+        "../../tests/program_testing/test_lane_range.ssl",
     };
 
     for (const auto& filePath : testFiles) {